@@ -0,0 +1,118 @@
+// bench/character_transform_benchmark.cc
+//
+// Cost of the homomorphic character transform at 8, 16 and 64 characters
+// (the kNumCharacters of SafeParams, MediumParams and ProductionParams):
+//
+// - BM_ProjectAll: CharacterTransform::ProjectAll, one baby-step/giant-step
+//   DFT producing all k projections
+// - BM_ProjectEach: k separate Project() calls, the loop ProjectAll
+//   replaces
+//
+// Counters give the decompositions and key-switch inner products of each.
+// Messages are d = 256 coefficients on the native backend (N = 4096), so
+// every k fits one window; keys are exactly the transform's rotations.
+//
+//   bazel run -c opt //bench:character_transform_benchmark
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include "lib/crypto/character_transform.h"
+#include "lib/crypto/native_bgv_backend.h"
+#include "lib/crypto/polynomial_params.h"
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+namespace {
+
+constexpr int kDegree = MediumParams::kDegree;
+
+struct Fixture {
+  std::shared_ptr<const NativeBgvBackend> backend;
+  CharacterTransform transform;
+  Ciphertext ciphertext;
+};
+
+absl::StatusOr<Fixture> MakeFixture(int num_characters) {
+  auto params = NativeBgvParams::Security128(kDegree);
+  if (!params.ok()) return params.status();
+  auto backend = NativeBgvBackend::Create(*params);
+  if (!backend.ok()) return backend.status();
+  auto transform = CharacterTransform::Create(num_characters);
+  if (!transform.ok()) return transform.status();
+  auto keys = (*backend)->GenerateKeyPair(transform->Rotations(kDegree));
+  if (!keys.ok()) return keys.status();
+
+  std::mt19937_64 rng(num_characters);
+  std::vector<int64_t> message(kDegree);
+  for (auto& c : message) c = rng() % RingParams::kModulus;
+  auto ciphertext = (*backend)->Encrypt(message, keys->public_key);
+  if (!ciphertext.ok()) return ciphertext.status();
+  return Fixture{*std::move(backend), *std::move(transform),
+                 *std::move(ciphertext)};
+}
+
+// Builds each fixture once per process. Returns nullptr after marking the
+// benchmark skipped on failure.
+const Fixture* GetFixture(benchmark::State& state) {
+  static auto* fixtures = new std::map<int, absl::StatusOr<Fixture>>();
+  const int k = static_cast<int>(state.range(0));
+  auto it = fixtures->find(k);
+  if (it == fixtures->end()) it = fixtures->emplace(k, MakeFixture(k)).first;
+  if (!it->second.ok()) {
+    state.SkipWithError(it->second.status().ToString().c_str());
+    return nullptr;
+  }
+  return &*it->second;
+}
+
+void BM_ProjectAll(benchmark::State& state) {
+  const Fixture* fixture = GetFixture(state);
+  if (fixture == nullptr) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture->transform.ProjectAll(*fixture->backend, fixture->ciphertext));
+  }
+  const int k = fixture->transform.num_characters();
+  state.counters["decompositions"] = 1 + fixture->transform.giant_steps();
+  state.counters["key_switches"] = k - 1;
+}
+
+void BM_ProjectEach(benchmark::State& state) {
+  const Fixture* fixture = GetFixture(state);
+  if (fixture == nullptr) return;
+  const int k = fixture->transform.num_characters();
+  for (auto _ : state) {
+    for (int j = 0; j < k; ++j) {
+      benchmark::DoNotOptimize(fixture->transform.Project(
+          *fixture->backend, fixture->ciphertext, j));
+    }
+  }
+  state.counters["decompositions"] = 2 * k;
+  state.counters["key_switches"] =
+      k * (fixture->transform.baby_steps() +
+           fixture->transform.giant_steps() - 2);
+}
+
+BENCHMARK(BM_ProjectAll)
+    ->ArgName("k")
+    ->Arg(SafeParams::kNumCharacters)
+    ->Arg(MediumParams::kNumCharacters)
+    ->Arg(ProductionParams::kNumCharacters)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_ProjectEach)
+    ->ArgName("k")
+    ->Arg(SafeParams::kNumCharacters)
+    ->Arg(MediumParams::kNumCharacters)
+    ->Arg(ProductionParams::kNumCharacters)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace f2chat
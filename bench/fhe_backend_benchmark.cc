@@ -0,0 +1,226 @@
+// bench/fhe_backend_benchmark.cc
+//
+// Per-operation cost of each FHE backend (KeyGen, Encrypt, Decrypt, Add,
+// Subtract, MultiplyScalar, MultiplyPlain, Rotate, RotateHoisted) at
+// every RingParams set: the argument is the message degree d (Safe 64,
+// Medium 256, Production 4096), and the native backend is built for d
+// directly, so one binary covers all three sets.
+//
+// The "N" counter is the RLWE ring dimension the backend picked for d;
+// KeyGen also reports the default rotation key count and per-user key
+// memory. Backends that cannot be created (OpenFHE, still a stub) are
+// reported as skipped with the reason.
+//
+//   bazel run -c opt //bench:fhe_backend_benchmark
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lib/crypto/fhe_backend.h"
+#include "lib/crypto/native_bgv_backend.h"
+#include "lib/crypto/openfhe_backend.h"
+#include "lib/crypto/polynomial_params.h"
+#include "lib/crypto/rotation_keys.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+
+namespace f2chat {
+namespace {
+
+// Backend, keys and two ciphertexts for one (backend, degree) pair.
+struct Fixture {
+  std::shared_ptr<const FheBackend> backend;
+  FHEKeyPair keys;
+  std::vector<int64_t> message;
+  Ciphertext ct_a;
+  Ciphertext ct_b;
+};
+
+absl::StatusOr<std::shared_ptr<const FheBackend>> MakeBackend(
+    const std::string& name, int degree) {
+  if (name == kNativeFheBackendName) {
+    auto params = NativeBgvParams::Security128(degree);
+    if (!params.ok()) return params.status();
+    auto backend = NativeBgvBackend::Create(*params);
+    if (!backend.ok()) return backend.status();
+    return std::shared_ptr<const FheBackend>(*std::move(backend));
+  }
+  // Other backends only exist for the compiled-in RingParams.
+  if (degree != RingParams::kDegree) {
+    return absl::UnimplementedError(absl::StrCat(
+        name, " is only built for d = ", RingParams::kDegree));
+  }
+  return CreateFheBackend(name);
+}
+
+absl::StatusOr<Fixture> MakeFixture(const std::string& name, int degree) {
+  Fixture fixture;
+  auto backend = MakeBackend(name, degree);
+  if (!backend.ok()) return backend.status();
+  fixture.backend = *std::move(backend);
+  auto keys = fixture.backend->GenerateKeyPair();
+  if (!keys.ok()) return keys.status();
+  fixture.keys = *std::move(keys);
+
+  std::mt19937_64 rng(degree);
+  fixture.message.resize(degree);
+  for (auto& c : fixture.message) c = rng() % RingParams::kModulus;
+  for (Ciphertext* ct : {&fixture.ct_a, &fixture.ct_b}) {
+    auto encrypted =
+        fixture.backend->Encrypt(fixture.message, fixture.keys.public_key);
+    if (!encrypted.ok()) return encrypted.status();
+    *ct = *std::move(encrypted);
+  }
+  return fixture;
+}
+
+// Builds each fixture once per process (key generation dominates setup).
+// Returns nullptr after marking the benchmark skipped on failure.
+const Fixture* GetFixture(benchmark::State& state, const std::string& name) {
+  static auto* fixtures =
+      new std::map<std::pair<std::string, int>, absl::StatusOr<Fixture>>();
+  const int degree = static_cast<int>(state.range(0));
+  auto it = fixtures->find({name, degree});
+  if (it == fixtures->end()) {
+    it = fixtures->emplace(std::make_pair(name, degree),
+                           MakeFixture(name, degree))
+             .first;
+  }
+  if (!it->second.ok()) {
+    state.SkipWithError(it->second.status().ToString().c_str());
+    return nullptr;
+  }
+  state.counters["N"] = it->second->backend->ring_dimension();
+  return &*it->second;
+}
+
+// Default rotation keys; counters give the per-user key memory.
+void KeyGen(benchmark::State& state, const Fixture& fixture) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.backend->GenerateKeyPair());
+  }
+  auto report = fixture.backend->KeyMemory(fixture.keys.public_key);
+  if (!report.ok()) return;
+  state.counters["rotation_keys"] = report->num_rotation_keys;
+  state.counters["key_MiB"] =
+      static_cast<double>(report->total_bytes()) / (1 << 20);
+}
+
+void Encrypt(benchmark::State& state, const Fixture& fixture) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture.backend->Encrypt(fixture.message, fixture.keys.public_key));
+  }
+}
+
+void Decrypt(benchmark::State& state, const Fixture& fixture) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture.backend->Decrypt(fixture.ct_a, fixture.keys.private_key));
+  }
+}
+
+void Add(benchmark::State& state, const Fixture& fixture) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.backend->Add(fixture.ct_a, fixture.ct_b));
+  }
+}
+
+void Subtract(benchmark::State& state, const Fixture& fixture) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture.backend->Subtract(fixture.ct_a, fixture.ct_b));
+  }
+}
+
+void MultiplyScalar(benchmark::State& state, const Fixture& fixture) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture.backend->MultiplyScalar(fixture.ct_a, 12345));
+  }
+}
+
+// Product with a plaintext encoded once outside the loop (as
+// FHEContext's plaintext cache does).
+void MultiplyPlain(benchmark::State& state, const Fixture& fixture) {
+  auto plaintext = fixture.backend->EncodePlaintext(fixture.message);
+  if (!plaintext.ok()) {
+    state.SkipWithError(plaintext.status().ToString().c_str());
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture.backend->MultiplyPlain(fixture.ct_a, *plaintext));
+  }
+}
+
+// A keyed rotation: one key switch.
+void Rotate(benchmark::State& state, const Fixture& fixture) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.backend->Rotate(fixture.ct_a, 1));
+  }
+}
+
+// An unkeyed offset (d/3), composed from several keyed rotations.
+void RotateComposed(benchmark::State& state, const Fixture& fixture) {
+  const int positions = static_cast<int>(state.range(0)) / 3;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.backend->Rotate(fixture.ct_a, positions));
+  }
+}
+
+// The baby-step rotations of a character projection, hoisted over one
+// decomposition; items/s counts rotations, to compare with Rotate.
+void RotateHoisted(benchmark::State& state, const Fixture& fixture) {
+  std::vector<int> positions;
+  for (int a = 1; a < BabyStepCount(RingParams::kNumCharacters); ++a) {
+    positions.push_back(-a);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture.backend->RotateHoisted(fixture.ct_a, positions));
+  }
+  state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+int RegisterBenchmarks() {
+  using Op = void (*)(benchmark::State&, const Fixture&);
+  const std::pair<const char*, Op> kOps[] = {
+      {"KeyGen", &KeyGen},     {"Encrypt", &Encrypt},
+      {"Decrypt", &Decrypt},   {"Add", &Add},
+      {"Subtract", &Subtract}, {"MultiplyScalar", &MultiplyScalar},
+      {"MultiplyPlain", &MultiplyPlain},
+      {"Rotate", &Rotate},     {"RotateComposed", &RotateComposed},
+      {"RotateHoisted", &RotateHoisted},
+  };
+  for (std::string backend : {kNativeFheBackendName, kOpenFheBackendName}) {
+    for (const auto& [op_name, op] : kOps) {
+      const std::string name = absl::StrCat("BM_", op_name, "/", backend);
+      benchmark::RegisterBenchmark(
+          name.c_str(),
+          [backend, op = op](benchmark::State& state) {
+            const Fixture* fixture = GetFixture(state, backend);
+            if (fixture != nullptr) op(state, *fixture);
+          })
+          ->ArgName("d")
+          ->Arg(SafeParams::kDegree)
+          ->Arg(MediumParams::kDegree)
+          ->Arg(ProductionParams::kDegree)
+          ->Unit(benchmark::kMicrosecond);
+    }
+  }
+  return 0;
+}
+
+const int registered = RegisterBenchmarks();
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,140 @@
+// bench/linear_transform_benchmark.cc
+//
+// Cost of one dense d×d matrix–vector product on a ciphertext (the shape of
+// an encrypted routing operator):
+//
+// - BM_BabyStepGiantStep: EncodedLinearTransform::Apply, Halevi–Shoup
+//   diagonals with hoisted baby steps (g + d/g − 2 key switches)
+// - BM_DiagonalByDiagonal: Σᵢ diagᵢ ⊙ Rotate(c, −i) with all d − 1
+//   rotations hoisted, the evaluation BSGS replaces
+//
+// Both multiply the same pre-encoded diagonals, so the difference is the
+// key switches. d = 64 and 256 on the native backend (Security128).
+//
+//   bazel run -c opt //bench:linear_transform_benchmark
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+#include "lib/crypto/linear_transform.h"
+#include "lib/crypto/native_bgv_backend.h"
+#include "lib/crypto/polynomial_params.h"
+#include "lib/crypto/rotation_keys.h"
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+namespace {
+
+struct Fixture {
+  std::shared_ptr<const NativeBgvBackend> backend;
+  int degree;
+  int key_switches;
+  // Encrypted under keys for every rotation by −1..−(d − 1).
+  Ciphertext ciphertext;
+  std::unique_ptr<EncodedLinearTransform> transform;
+  std::vector<Plaintext> diagonals;  // diagᵢ, i < d, not pre-rotated
+};
+
+absl::StatusOr<Fixture> MakeFixture(int degree) {
+  auto params = NativeBgvParams::Security128(degree);
+  if (!params.ok()) return params.status();
+  auto backend = NativeBgvBackend::Create(*params);
+  if (!backend.ok()) return backend.status();
+
+  std::mt19937_64 rng(degree);
+  std::map<int, std::vector<int64_t>> diagonals;
+  Fixture fixture{*backend, degree, 0, nullptr, nullptr, {}};
+  for (int i = 0; i < degree; ++i) {
+    std::vector<int64_t> diagonal(degree);
+    for (auto& v : diagonal) v = rng() % RingParams::kModulus;
+    auto encoded = (*backend)->EncodePlaintext(diagonal);
+    if (!encoded.ok()) return encoded.status();
+    fixture.diagonals.push_back(*std::move(encoded));
+    diagonals.emplace(i, std::move(diagonal));
+  }
+  auto transform = LinearTransform::FromDiagonals(degree, diagonals);
+  if (!transform.ok()) return transform.status();
+  fixture.key_switches = transform->key_switches();
+  auto encoded = transform->Encode(**backend);
+  if (!encoded.ok()) return encoded.status();
+  fixture.transform =
+      std::make_unique<EncodedLinearTransform>(*std::move(encoded));
+
+  RotationKeySet rotations(degree);
+  for (int i = 1; i < degree; ++i) rotations.Add(-i);
+  auto keys = (*backend)->GenerateKeyPair(rotations);
+  if (!keys.ok()) return keys.status();
+  std::vector<int64_t> message(degree);
+  for (auto& c : message) c = rng() % RingParams::kModulus;
+  auto ciphertext = (*backend)->Encrypt(message, keys->public_key);
+  if (!ciphertext.ok()) return ciphertext.status();
+  fixture.ciphertext = *std::move(ciphertext);
+  return fixture;
+}
+
+// Builds each fixture once per process. Returns nullptr after marking the
+// benchmark skipped on failure.
+const Fixture* GetFixture(benchmark::State& state) {
+  static auto* fixtures = new std::map<int, absl::StatusOr<Fixture>>();
+  const int d = static_cast<int>(state.range(0));
+  auto it = fixtures->find(d);
+  if (it == fixtures->end()) it = fixtures->emplace(d, MakeFixture(d)).first;
+  if (!it->second.ok()) {
+    state.SkipWithError(it->second.status().ToString().c_str());
+    return nullptr;
+  }
+  return &*it->second;
+}
+
+void BM_BabyStepGiantStep(benchmark::State& state) {
+  const Fixture* fixture = GetFixture(state);
+  if (fixture == nullptr) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture->transform->Apply(fixture->ciphertext));
+  }
+  state.counters["key_switches"] = fixture->key_switches;
+}
+
+void BM_DiagonalByDiagonal(benchmark::State& state) {
+  const Fixture* fixture = GetFixture(state);
+  if (fixture == nullptr) return;
+  const FheBackend& backend = *fixture->backend;
+  std::vector<int> positions(fixture->degree);
+  for (int i = 0; i < fixture->degree; ++i) positions[i] = -i;
+  for (auto _ : state) {
+    auto rotated = backend.RotateHoisted(fixture->ciphertext, positions);
+    if (!rotated.ok()) {
+      state.SkipWithError(rotated.status().ToString().c_str());
+      return;
+    }
+    Ciphertext sum;
+    for (int i = 0; i < fixture->degree; ++i) {
+      Ciphertext term =
+          backend.MultiplyPlain((*rotated)[i], fixture->diagonals[i]).value();
+      sum = sum == nullptr ? term : backend.Add(sum, term).value();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.counters["key_switches"] = fixture->degree - 1;
+}
+
+BENCHMARK(BM_BabyStepGiantStep)
+    ->ArgName("d")
+    ->Arg(SafeParams::kDegree)
+    ->Arg(MediumParams::kDegree)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_DiagonalByDiagonal)
+    ->ArgName("d")
+    ->Arg(SafeParams::kDegree)
+    ->Arg(MediumParams::kDegree)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,132 @@
+// bench/routing_pipeline_benchmark.cc
+//
+// Streaming throughput over a chain of patches: SheafRouter::Route in a
+// loop vs RoutingPipeline::RouteStream vs SheafRouter::RouteBatch (by
+// worker count).
+//
+// RouteBatch reports the machine's NUMA node count and the tasks stolen
+// across nodes per batch (cross-socket traffic); workers are pinned on
+// multi-node machines so the node-local replicas and arenas apply.
+//
+//   bazel run -c opt //bench:routing_pipeline_benchmark
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+#include "lib/network/patch.h"
+#include "lib/network/routing_pipeline.h"
+#include "lib/network/sheaf_router.h"
+#include "lib/runtime/executor.h"
+#include "lib/runtime/numa.h"
+#include "absl/strings/str_cat.h"
+
+namespace f2chat {
+namespace {
+
+constexpr int kMessages = 1024;
+
+ExecutorOptions Workers(int num_workers) {
+  ExecutorOptions options;
+  options.num_workers = num_workers;
+  options.pin_workers = NumaTopology::System().num_nodes() > 1;
+  return options;
+}
+
+SheafRouter MakeRouter(int num_patches, Executor* executor = nullptr) {
+  RoutingWeights weights;
+  weights.weights.resize(
+      RingParams::kDegree,
+      std::vector<double>(RingParams::kNumCharacters,
+                          1.0 / RingParams::kNumCharacters));
+
+  RoutingProblem problem;
+  for (int i = 0; i < num_patches; ++i) {
+    problem.patches.push_back(std::make_shared<Patch>(
+        Patch::Create(absl::StrCat("patch-", i), weights)));
+  }
+  for (int64_t seed = 1; seed <= 8; ++seed) {
+    problem.examples.push_back(RoutingExample{
+        Polynomial({seed}), Polynomial({seed + 1}),
+        Polynomial({seed, 2 * seed, 3 * seed, 5, 7}),
+        Polynomial({seed + 10, seed + 11})});
+  }
+  RouterOptions router_options;
+  router_options.executor = executor;
+  auto router = SheafRouter::Create(problem, {}, router_options).value();
+  (void)router.LearnRouting().value();
+  return router;
+}
+
+std::vector<RouteRequest> MakeRequests() {
+  std::vector<RouteRequest> requests;
+  requests.reserve(kMessages);
+  for (int64_t i = 0; i < kMessages; ++i) {
+    std::vector<int64_t> message(RingParams::kDegree);
+    for (int j = 0; j < RingParams::kDegree; ++j) {
+      message[j] = (i * 31 + j * 17) % 1000;
+    }
+    requests.push_back({Polynomial(message), Polynomial({i % 13}),
+                        Polynomial({i % 11, 1})});
+  }
+  return requests;
+}
+
+void BM_RouteLoop(benchmark::State& state) {
+  SheafRouter router = MakeRouter(static_cast<int>(state.range(0)));
+  auto requests = MakeRequests();
+  for (auto _ : state) {
+    for (const auto& request : requests) {
+      benchmark::DoNotOptimize(
+          router.Route(request.message, request.source_id, request.dest_id));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kMessages);
+}
+BENCHMARK(BM_RouteLoop)->Arg(4)->Arg(16)->UseRealTime();
+
+void BM_RoutePipeline(benchmark::State& state) {
+  SheafRouter router = MakeRouter(static_cast<int>(state.range(0)));
+  auto requests = MakeRequests();
+  auto pipeline = RoutingPipeline::Create(router).value();
+  state.counters["stages"] = pipeline->num_stages();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(pipeline->RouteStream(requests));
+  }
+  state.SetItemsProcessed(state.iterations() * kMessages);
+}
+BENCHMARK(BM_RoutePipeline)->Arg(4)->Arg(16)->UseRealTime();
+
+// Args: patches, workers.
+void BM_RouteBatch(benchmark::State& state) {
+  Executor executor(Workers(static_cast<int>(state.range(1))));
+  SheafRouter router = MakeRouter(static_cast<int>(state.range(0)), &executor);
+  auto requests = MakeRequests();
+  std::vector<Polynomial> messages, sources, dests;
+  for (const auto& request : requests) {
+    messages.push_back(request.message);
+    sources.push_back(request.source_id);
+    dests.push_back(request.dest_id);
+  }
+  const int64_t steals = executor.steals();
+  const int64_t cross_node_steals = executor.cross_node_steals();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(router.RouteBatch(messages, sources, dests));
+  }
+  state.SetItemsProcessed(state.iterations() * kMessages);
+  state.counters["nodes"] = executor.topology().num_nodes();
+  state.counters["steals"] = benchmark::Counter(
+      executor.steals() - steals, benchmark::Counter::kAvgIterations);
+  state.counters["cross_node_steals"] = benchmark::Counter(
+      executor.cross_node_steals() - cross_node_steals,
+      benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RouteBatch)
+    ->ArgsProduct({{4, 16}, {1, 2, 4, 8}})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace f2chat
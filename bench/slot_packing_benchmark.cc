@@ -0,0 +1,122 @@
+// bench/slot_packing_benchmark.cc
+//
+// Per-message server cost with and without slot packing, for SafeParams
+// messages (d = 64) on the native backend (N = 4096 either way):
+//
+// - unpacked: a backend for d, one message per ciphertext
+// - packed: a backend for one full slot row (D = 2048) and SlotPacking,
+//   B = 32 messages per ciphertext
+//
+// items/s counts messages, so the two rows of each op compare directly.
+// Add is slot-wise; Rotate is Polynomial::Rotate on every message (one
+// keyed rotation unpacked, SlotPacking::Rotate with its Rotations() keys
+// packed).
+//
+//   bazel run -c opt //bench:slot_packing_benchmark
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+#include "lib/crypto/native_bgv_backend.h"
+#include "lib/crypto/polynomial_params.h"
+#include "lib/crypto/rotation_keys.h"
+#include "lib/crypto/slot_packing.h"
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+namespace {
+
+constexpr int kMessageDegree = SafeParams::kDegree;
+constexpr int kSlotRow = 2048;
+
+// Backend, keys and one ciphertext holding `messages` messages.
+struct Fixture {
+  std::shared_ptr<const NativeBgvBackend> backend;
+  std::unique_ptr<SlotPacking> packing;  // Null when unpacked
+  Ciphertext ciphertext;
+  int messages;
+};
+
+absl::StatusOr<Fixture> MakeFixture(bool packed) {
+  const int degree = packed ? kSlotRow : kMessageDegree;
+  auto params = NativeBgvParams::Security128(degree);
+  if (!params.ok()) return params.status();
+  auto backend = NativeBgvBackend::Create(*params);
+  if (!backend.ok()) return backend.status();
+  Fixture fixture{*std::move(backend), nullptr, nullptr, 1};
+
+  // Default keys, plus the two keys of a packed rotation by one.
+  RotationKeySet rotations = RotationKeySet::Default(degree);
+  if (packed) {
+    auto packing = SlotPacking::Create(*fixture.backend, kMessageDegree);
+    if (!packing.ok()) return packing.status();
+    rotations.Merge(packing->Rotations({1}));
+    fixture.messages = packing->capacity();
+    fixture.packing = std::make_unique<SlotPacking>(*std::move(packing));
+  }
+  auto keys = fixture.backend->GenerateKeyPair(rotations);
+  if (!keys.ok()) return keys.status();
+
+  std::mt19937_64 rng(1);
+  std::vector<int64_t> slots(degree);
+  for (auto& c : slots) c = rng() % RingParams::kModulus;
+  auto ciphertext = fixture.backend->Encrypt(slots, keys->public_key);
+  if (!ciphertext.ok()) return ciphertext.status();
+  fixture.ciphertext = *std::move(ciphertext);
+  return fixture;
+}
+
+// Builds each fixture once per process. Returns nullptr after marking the
+// benchmark skipped on failure.
+const Fixture* GetFixture(benchmark::State& state) {
+  static auto* unpacked = new absl::StatusOr<Fixture>(MakeFixture(false));
+  static auto* packed = new absl::StatusOr<Fixture>(MakeFixture(true));
+  const absl::StatusOr<Fixture>& fixture =
+      state.range(0) != 0 ? *packed : *unpacked;
+  if (!fixture.ok()) {
+    state.SkipWithError(fixture.status().ToString().c_str());
+    return nullptr;
+  }
+  state.counters["messages_per_ciphertext"] = fixture->messages;
+  return &*fixture;
+}
+
+void BM_Add(benchmark::State& state) {
+  const Fixture* fixture = GetFixture(state);
+  if (fixture == nullptr) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        fixture->backend->Add(fixture->ciphertext, fixture->ciphertext));
+  }
+  state.SetItemsProcessed(state.iterations() * fixture->messages);
+}
+
+void BM_Rotate(benchmark::State& state) {
+  const Fixture* fixture = GetFixture(state);
+  if (fixture == nullptr) return;
+  for (auto _ : state) {
+    if (fixture->packing != nullptr) {
+      benchmark::DoNotOptimize(
+          fixture->packing->Rotate(fixture->ciphertext, 1));
+    } else {
+      benchmark::DoNotOptimize(
+          fixture->backend->Rotate(fixture->ciphertext, 1));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * fixture->messages);
+}
+
+BENCHMARK(BM_Add)->ArgName("packed")->Arg(0)->Arg(1);
+BENCHMARK(BM_Rotate)
+    ->ArgName("packed")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace f2chat
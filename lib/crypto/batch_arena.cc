@@ -0,0 +1,55 @@
+// lib/crypto/batch_arena.cc
+#include "lib/crypto/batch_arena.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace f2chat {
+
+BatchArena::BatchArena(int num_nodes, size_t max_free_per_node)
+    : max_free_per_node_(max_free_per_node) {
+  for (int i = 0; i < std::max(1, num_nodes); ++i) {
+    nodes_.push_back(std::make_unique<NodeList>());
+  }
+}
+
+BatchArena::NodeList& BatchArena::ListOf(int node) {
+  const size_t index = node < 0 ? 0 : static_cast<size_t>(node) % nodes_.size();
+  return *nodes_[index];
+}
+
+PolynomialBatch BatchArena::Acquire(int node, size_t size) {
+  NodeList& list = ListOf(node);
+  PolynomialBatch batch;
+  {
+    absl::MutexLock lock(&list.mu);
+    if (!list.free.empty()) {
+      batch = std::move(list.free.back());
+      list.free.pop_back();
+      ++list.reused;
+    }
+  }
+  // Shrinking keeps the buffer; growing touches the new rows on this
+  // (node-local) thread.
+  batch.Resize(size);
+  return batch;
+}
+
+void BatchArena::Release(int node, PolynomialBatch batch) {
+  NodeList& list = ListOf(node);
+  absl::MutexLock lock(&list.mu);
+  if (list.free.size() < max_free_per_node_) {
+    list.free.push_back(std::move(batch));
+  }
+}
+
+int64_t BatchArena::reused() const {
+  int64_t total = 0;
+  for (const auto& list : nodes_) {
+    absl::MutexLock lock(&list->mu);
+    total += list->reused;
+  }
+  return total;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,211 @@
+// lib/crypto/character_transform.cc
+//
+// Implementation of the homomorphic character transform.
+
+#include "lib/crypto/character_transform.h"
+
+#include <utility>
+#include "lib/crypto/ntt.h"
+#include "absl/strings/str_format.h"
+
+namespace f2chat {
+namespace {
+
+bool IsPowerOfTwo(int64_t n) { return n > 0 && (n & (n - 1)) == 0; }
+
+// Σᵢ weights[i]·inputs[i] (unit weights skip the multiply).
+absl::StatusOr<Ciphertext> LinearCombination(
+    const FheBackend& backend, const std::vector<Ciphertext>& inputs,
+    const int64_t* weights) {
+  Ciphertext sum;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    Ciphertext term = inputs[i];
+    if (weights[i] != 1) {
+      auto scaled = backend.MultiplyScalar(term, weights[i]);
+      if (!scaled.ok()) return scaled.status();
+      term = *std::move(scaled);
+    }
+    if (sum == nullptr) {
+      sum = std::move(term);
+      continue;
+    }
+    auto added = backend.Add(sum, term);
+    if (!added.ok()) return added.status();
+    sum = *std::move(added);
+  }
+  return sum;
+}
+
+}  // namespace
+
+absl::StatusOr<CharacterTransform> CharacterTransform::Create(
+    int num_characters, int64_t modulus) {
+  if (!IsPowerOfTwo(num_characters) || modulus < 2 ||
+      (modulus - 1) % num_characters != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Need a power-of-two character count dividing p − 1 (k=%d, p=%d)",
+        num_characters, modulus));
+  }
+  // x^((p−1)/k) has order dividing k; it is primitive iff its k/2-th power
+  // is not 1 (k is a power of two).
+  const uint64_t p = modulus;
+  for (uint64_t x = 2; x < p; ++x) {
+    const uint64_t candidate = PowMod(x, (p - 1) / num_characters, p);
+    if (num_characters == 1 ||
+        PowMod(candidate, num_characters / 2, p) != 1) {
+      return CharacterTransform(num_characters, modulus,
+                                static_cast<int64_t>(candidate));
+    }
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "No primitive %d-th root of unity mod %d", num_characters, modulus));
+}
+
+const CharacterTransform& CharacterTransform::Default() {
+  static const CharacterTransform* transform = new CharacterTransform(
+      CharacterTransform::Create(RingParams::kNumCharacters).value());
+  return *transform;
+}
+
+CharacterTransform::CharacterTransform(int num_characters, int64_t modulus,
+                                       int64_t root)
+    : num_characters_(num_characters),
+      baby_steps_(BabyStepCount(num_characters)),
+      giant_steps_(num_characters / baby_steps_),
+      modulus_(modulus),
+      root_(root) {
+  const int k = num_characters_;
+  const int g = baby_steps_;
+  const int h = giant_steps_;
+  const uint64_t p = modulus_;
+  // ω^(−e) for any e ≥ 0.
+  auto inverse_power = [&](int64_t e) {
+    return static_cast<int64_t>(PowMod(root_, (k - e % k) % k, p));
+  };
+
+  giant_weights_.resize(h * h);
+  for (int j0 = 0; j0 < h; ++j0) {
+    for (int b = 0; b < h; ++b) {
+      giant_weights_[j0 * h + b] = inverse_power(int64_t{g} * j0 * b);
+    }
+  }
+  const uint64_t k_inverse = InvMod(k, p);
+  baby_weights_.resize(k * g);
+  for (int j = 0; j < k; ++j) {
+    for (int a = 0; a < g; ++a) {
+      baby_weights_[j * g + a] = static_cast<int64_t>(
+          MulMod(k_inverse, inverse_power(int64_t{j} * a), p));
+    }
+  }
+}
+
+absl::StatusOr<std::vector<Ciphertext>> CharacterTransform::GiantSteps(
+    const FheBackend& backend, const Ciphertext& ciphertext) const {
+  std::vector<int> positions(giant_steps_);
+  for (int b = 0; b < giant_steps_; ++b) positions[b] = -baby_steps_ * b;
+  return backend.RotateHoisted(ciphertext, positions);
+}
+
+absl::StatusOr<std::vector<Ciphertext>> CharacterTransform::BabySteps(
+    const FheBackend& backend, const Ciphertext& partial) const {
+  std::vector<int> positions(baby_steps_);
+  for (int a = 0; a < baby_steps_; ++a) positions[a] = -a;
+  return backend.RotateHoisted(partial, positions);
+}
+
+absl::StatusOr<Ciphertext> CharacterTransform::Project(
+    const FheBackend& backend, const Ciphertext& ciphertext,
+    int character_index, const CancellationToken& token,
+    const ProgressCallback& progress) const {
+  if (character_index < 0 || character_index >= num_characters_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid character index: %d (must be 0 to %d)", character_index,
+        num_characters_ - 1));
+  }
+  ProgressReporter reporter(progress, "Project", 2);
+  const int h = giant_steps_;
+  if (auto status = token.Check(); !status.ok()) return status;
+  auto giant = GiantSteps(backend, ciphertext);
+  if (!giant.ok()) return giant.status();
+  auto partial = LinearCombination(
+      backend, *giant, &giant_weights_[(character_index % h) * h]);
+  if (!partial.ok()) return partial.status();
+  reporter.Advance();
+
+  if (auto status = token.Check(); !status.ok()) return status;
+  auto baby = BabySteps(backend, *partial);
+  if (!baby.ok()) return baby.status();
+  auto projection = LinearCombination(
+      backend, *baby, &baby_weights_[character_index * baby_steps_]);
+  if (!projection.ok()) return projection.status();
+  reporter.Advance();
+  return projection;
+}
+
+absl::StatusOr<std::vector<Ciphertext>> CharacterTransform::ProjectAll(
+    const FheBackend& backend, const Ciphertext& ciphertext,
+    const CancellationToken& token, const ProgressCallback& progress) const {
+  const int h = giant_steps_;
+  ProgressReporter reporter(progress, "ProjectAll", 1 + h);
+  if (auto status = token.Check(); !status.ok()) return status;
+  auto giant = GiantSteps(backend, ciphertext);
+  if (!giant.ok()) return giant.status();
+  reporter.Advance();
+
+  std::vector<Ciphertext> projections(num_characters_);
+  for (int j0 = 0; j0 < h; ++j0) {
+    if (auto status = token.Check(); !status.ok()) return status;
+    auto partial =
+        LinearCombination(backend, *giant, &giant_weights_[j0 * h]);
+    if (!partial.ok()) return partial.status();
+    auto baby = BabySteps(backend, *partial);
+    if (!baby.ok()) return baby.status();
+    // Every j ≡ j₀ (mod h) shares W_j₀ and its baby steps.
+    for (int j = j0; j < num_characters_; j += h) {
+      auto projection =
+          LinearCombination(backend, *baby, &baby_weights_[j * baby_steps_]);
+      if (!projection.ok()) return projection.status();
+      projections[j] = *std::move(projection);
+    }
+    reporter.Advance();
+  }
+  return projections;
+}
+
+int64_t CharacterTransform::weight(int character_index, int offset) const {
+  // Baby weight (a = m mod g) · giant weight (b = m / g).
+  const int g = baby_steps_;
+  const int h = giant_steps_;
+  return static_cast<int64_t>(
+      MulMod(baby_weights_[character_index * g + offset % g],
+             giant_weights_[(character_index % h) * h + offset / g], modulus_));
+}
+
+std::vector<int64_t> CharacterTransform::ProjectPlaintext(
+    const std::vector<int64_t>& coefficients, int character_index) const {
+  const int d = static_cast<int>(coefficients.size());
+  std::vector<int64_t> projection(d, 0);
+  for (int s = 0; s < d; ++s) {
+    projection[s] = ProjectSlot(coefficients.data(), d, character_index, s);
+  }
+  return projection;
+}
+
+int64_t CharacterTransform::ProjectSlot(const int64_t* coefficients,
+                                        int degree, int character_index,
+                                        int slot) const {
+  const uint64_t p = modulus_;
+  uint64_t sum = 0;
+  for (int m = 0; m < num_characters_; ++m) {
+    const uint64_t value = ReduceSigned(coefficients[(slot + m) % degree], p);
+    sum = AddMod(sum, MulMod(weight(character_index, m), value, p), p);
+  }
+  return static_cast<int64_t>(sum);
+}
+
+RotationKeySet CharacterTransform::Rotations(int degree) const {
+  return RotationKeySet::BabyStepGiantStep(degree, num_characters_,
+                                           baby_steps_);
+}
+
+}  // namespace f2chat
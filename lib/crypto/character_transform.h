@@ -0,0 +1,149 @@
+// lib/crypto/character_transform.h
+//
+// Homomorphic character transform: the DFT over coefficient windows that
+// EncryptedPolynomial's character projections evaluate.
+//
+// For k characters and a primitive k-th root of unity ω mod p, the
+// projection of a message c (d coefficients) onto χⱼ(m) = ω^(jm) is
+//   yⱼ[s] = k⁻¹ Σₘ ω^(−jm) · c[(s + m) mod d],   0 ≤ j < k,
+// i.e. yⱼ = k⁻¹ Σₘ ω^(−jm) · Rotate(c, −m). It is exact mod p, so BGV
+// evaluates it without error, and Σⱼ yⱼ = c.
+//
+// Baby-step/giant-step factorization: with m = a + g·b (a < g baby steps,
+// b < h = k/g giant steps) and j = j₀ + h·j₁, ω^(−jgb) only depends on j₀:
+//   W_j₀ = Σ_b ω^(−g·j₀·b) · Rotate(c, −g·b)        (h partial sums)
+//   yⱼ   = k⁻¹ Σₐ ω^(−ja) · Rotate(W_j₀, −a)
+// The h − 1 giant rotations of c share one hoisted decomposition, and the
+// g − 1 baby rotations of each W_j₀ share another.
+//
+// Key Properties:
+// - All k projections: 1 + h = O(√k) decompositions and k − 1 key-switch
+//   inner products, the fewest possible (k independent outputs need k − 1
+//   new ciphertexts); the k-fold loop of single projections needs 2k and
+//   k·(g + h − 2)
+// - Weighted sums are direct rather than FFT butterflies: every twiddle
+//   multiply scales the noise by up to p/2, so log k butterfly layers
+//   would compound it; direct sums apply two such multiplies in total
+// - Keys: RotationKeySet::BabyStepGiantStep(d, k, g), which
+//   RotationKeySet::Default carries for k = kNumCharacters
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_CHARACTER_TRANSFORM_H_
+#define F2CHAT_LIB_CRYPTO_CHARACTER_TRANSFORM_H_
+
+#include <cstdint>
+#include <vector>
+#include "lib/crypto/fhe_backend.h"
+#include "lib/crypto/polynomial_params.h"
+#include "lib/crypto/rotation_keys.h"
+#include "lib/runtime/cancellation.h"
+#include "lib/runtime/progress.h"
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+
+// Character transform over windows of k coefficients.
+//
+// Thread Safety: Immutable after Create().
+//
+// Performance (one ciphertext, g = BabyStepCount(k), h = k/g):
+// - Project: 2 decompositions, g + h − 2 inner products, g + h scalar
+//   multiplies
+// - ProjectAll: 1 + h decompositions, k − 1 inner products, h² + k·g
+//   scalar multiplies
+class CharacterTransform {
+ public:
+  // Transform for `num_characters` characters mod `modulus`.
+  //
+  // Returns:
+  //   Transform with its twiddle tables
+  //   InvalidArgument unless k is a power of two dividing modulus − 1
+  //   (modulus prime)
+  static absl::StatusOr<CharacterTransform> Create(
+      int num_characters, int64_t modulus = RingParams::kModulus);
+
+  // Transform for RingParams::kNumCharacters characters mod
+  // RingParams::kModulus (created once).
+  static const CharacterTransform& Default();
+
+  // Projection of `ciphertext` onto χⱼ.
+  //
+  // `token` is checked before the giant and before the baby steps;
+  // `progress` counts those two stages.
+  //
+  // Returns:
+  //   Enc(yⱼ)
+  //   InvalidArgument if j is out of range; backend errors otherwise
+  //   Cancelled / DeadlineExceeded from `token`
+  absl::StatusOr<Ciphertext> Project(
+      const FheBackend& backend, const Ciphertext& ciphertext,
+      int character_index, const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr) const;
+
+  // All k projections [Enc(y₀), ..., Enc(yₖ₋₁)], baby-step/giant-step.
+  //
+  // `token` is checked before the giant steps and before every giant-step
+  // group (one W_j₀ and its g projections); `progress` counts the giant
+  // steps plus one unit per group (1 + h).
+  //
+  // Returns:
+  //   k projections; backend errors otherwise
+  //   Cancelled / DeadlineExceeded from `token`
+  absl::StatusOr<std::vector<Ciphertext>> ProjectAll(
+      const FheBackend& backend, const Ciphertext& ciphertext,
+      const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr) const;
+
+  // Plaintext reference: yⱼ of `coefficients` (taken as the whole
+  // message, values mod p).
+  std::vector<int64_t> ProjectPlaintext(
+      const std::vector<int64_t>& coefficients, int character_index) const;
+
+  // yⱼ[slot] of a `degree`-coefficient message (one value of
+  // ProjectPlaintext, unchecked).
+  //
+  // Performance: O(k)
+  int64_t ProjectSlot(const int64_t* coefficients, int degree,
+                      int character_index, int slot) const;
+
+  // Rotations the transform applies, for messages of `degree`
+  // coefficients.
+  RotationKeySet Rotations(int degree) const;
+
+  // k⁻¹·ω^(−jm): weight of c[(s + m) mod d] in yⱼ[s], 0 ≤ m < k.
+  int64_t weight(int character_index, int offset) const;
+
+  int num_characters() const { return num_characters_; }
+  int baby_steps() const { return baby_steps_; }
+  int giant_steps() const { return giant_steps_; }
+
+  // ω: primitive k-th root of unity mod p.
+  int64_t root() const { return root_; }
+
+ private:
+  CharacterTransform(int num_characters, int64_t modulus, int64_t root);
+
+  // Giant-step rotations Rotate(c, −g·b), b < h, hoisted.
+  absl::StatusOr<std::vector<Ciphertext>> GiantSteps(
+      const FheBackend& backend, const Ciphertext& ciphertext) const;
+
+  // Baby-step rotations Rotate(w, −a), a < g, hoisted.
+  absl::StatusOr<std::vector<Ciphertext>> BabySteps(
+      const FheBackend& backend, const Ciphertext& partial) const;
+
+  int num_characters_;
+  int baby_steps_;
+  int giant_steps_;
+  int64_t modulus_;
+  int64_t root_;
+  // giant_weights_[j₀·h + b] = ω^(−g·j₀·b)
+  std::vector<int64_t> giant_weights_;
+  // baby_weights_[j·g + a] = k⁻¹·ω^(−ja)
+  std::vector<int64_t> baby_weights_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_CHARACTER_TRANSFORM_H_
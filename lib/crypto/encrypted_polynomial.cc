@@ -3,6 +3,9 @@
 // Implementation of encrypted polynomial wrapper.
 
 #include "lib/crypto/encrypted_polynomial.h"
+
+#include <utility>
+#include "lib/crypto/character_transform.h"
 #include "absl/strings/str_format.h"
 
 namespace f2chat {
@@ -73,6 +76,18 @@ absl::StatusOr<EncryptedPolynomial> EncryptedPolynomial::MultiplyScalar(
   return EncryptedPolynomial(std::move(result_ct_or).value());
 }
 
+absl::StatusOr<EncryptedPolynomial> EncryptedPolynomial::MultiplyPlain(
+    const Polynomial& weights,
+    const FHEContext& fhe_context) const {
+  // Homomorphic plaintext multiplication: Enc(a), w → Enc(a ⊙ w)
+  auto result_ct_or = fhe_context.HomomorphicMultiplyPlain(ciphertext_, weights);
+  if (!result_ct_or.ok()) {
+    return result_ct_or.status();
+  }
+
+  return EncryptedPolynomial(std::move(result_ct_or).value());
+}
+
 absl::StatusOr<EncryptedPolynomial> EncryptedPolynomial::Rotate(
     int positions,
     const FHEContext& fhe_context) const {
@@ -92,62 +107,52 @@ absl::StatusOr<EncryptedPolynomial> EncryptedPolynomial::Negate(
   return MultiplyScalar(-1, fhe_context);
 }
 
-// Character projection (homomorphic DFT)
+// Character projection (homomorphic DFT, see character_transform.h)
+
 absl::StatusOr<EncryptedPolynomial> EncryptedPolynomial::ProjectToCharacter(
     int character_index,
-    const FHEContext& fhe_context) const {
-  (void)fhe_context;  // Suppress unused parameter warning
-
+    const FHEContext& fhe_context,
+    const CancellationToken& token,
+    const ProgressCallback& progress) const {
   if (character_index < 0 || character_index >= RingParams::kNumCharacters) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Invalid character index: %d (must be 0 to %d)",
         character_index, RingParams::kNumCharacters - 1));
   }
 
-  // TODO: Implement homomorphic character projection
-  //
-  // Planned implementation:
-  // 1. Compute DFT basis weights for character χⱼ
-  // 2. For each position k, apply homomorphic rotation + scalar multiplication:
-  //    proj = Σₖ χⱼ(k) * Rotate(Enc(poly), k)
-  // 3. Scale by 1/n (using homomorphic scalar multiplication)
-  //
-  // This allows server to compute character projections on encrypted data!
-  //
-  // Formula:
-  //   Proj_χⱼ(Enc(p)) = (1/n) Σₖ χⱼ(k) * Enc(p(ωᵏ))
-  // where ω is a primitive nth root of unity.
-  //
-  // Example (for character 0, identity):
-  //   Enc(Proj_χ₀(p)) = (1/n) * Enc(sum of all coefficients)
-  //
-  // This is depth-0 because:
-  // - Rotation: depth-0 (automorphism)
-  // - Scalar multiplication: depth-0 (plaintext-ciphertext)
-  // - Addition: depth-0
-
-  return absl::UnimplementedError(
-      "EncryptedPolynomial::ProjectToCharacter() - Homomorphic DFT pending");
+  auto projection = CharacterTransform::Default().Project(
+      fhe_context.backend(), ciphertext_, character_index, token, progress);
+  if (!projection.ok()) {
+    return projection.status();
+  }
+  return EncryptedPolynomial(*std::move(projection));
 }
 
 absl::StatusOr<std::vector<EncryptedPolynomial>>
 EncryptedPolynomial::ProjectToAllCharacters(
-    const FHEContext& fhe_context) const {
+    const FHEContext& fhe_context,
+    const CancellationToken& token,
+    const ProgressCallback& progress) const {
+  // One baby-step/giant-step transform rather than k single projections.
+  auto projections_or = CharacterTransform::Default().ProjectAll(
+      fhe_context.backend(), ciphertext_, token, progress);
+  if (!projections_or.ok()) {
+    return projections_or.status();
+  }
+
   std::vector<EncryptedPolynomial> projections;
   projections.reserve(RingParams::kNumCharacters);
-
-  // Project onto each character χⱼ
-  for (int j = 0; j < RingParams::kNumCharacters; ++j) {
-    auto proj_or = ProjectToCharacter(j, fhe_context);
-    if (!proj_or.ok()) {
-      return proj_or.status();
-    }
-    projections.push_back(std::move(proj_or).value());
+  for (Ciphertext& projection : *projections_or) {
+    projections.push_back(EncryptedPolynomial(std::move(projection)));
   }
 
   return projections;
 }
 
+int64_t EncryptedPolynomial::CharacterRoot() {
+  return CharacterTransform::Default().root();
+}
+
 // Debug string (does NOT decrypt!)
 std::string EncryptedPolynomial::DebugString() const {
   return absl::StrFormat(
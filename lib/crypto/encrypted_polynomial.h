@@ -23,6 +23,8 @@
 #include <vector>
 #include "lib/crypto/fhe_context.h"
 #include "lib/crypto/polynomial.h"
+#include "lib/runtime/cancellation.h"
+#include "lib/runtime/progress.h"
 #include "absl/status/statusor.h"
 #include "absl/status/status.h"
 
@@ -30,8 +32,8 @@ namespace f2chat {
 
 // Encrypted polynomial (FHE ciphertext representing polynomial coefficients).
 //
-// This class wraps an OpenFHE Ciphertext and provides polynomial-like
-// operations that execute homomorphically on encrypted data.
+// This class wraps a backend Ciphertext (see fhe_backend.h) and provides
+// polynomial-like operations that execute homomorphically on encrypted data.
 //
 // Example usage:
 //   // Encrypt polynomial
@@ -143,6 +145,27 @@ class EncryptedPolynomial {
       int64_t scalar,
       const FHEContext& fhe_context) const;
 
+  // Homomorphic plaintext multiplication: Enc(a), w → Enc(a ⊙ w).
+  //
+  // Multiplies coefficient i by w[i] (position-dependent weights). The
+  // encoding of `weights` is cached by the context, so applying the same
+  // weights to many ciphertexts encodes them once.
+  //
+  // Args:
+  //   weights: Plaintext weight polynomial (not encrypted!)
+  //   fhe_context: FHE crypto context
+  //
+  // Returns:
+  //   Encrypted weighted polynomial
+  //   Error if operation fails
+  //
+  // Performance: O(n) (pointwise per RNS limb), depth-0
+  //
+  // Server-safe: YES (server can apply known weights to encrypted data!)
+  absl::StatusOr<EncryptedPolynomial> MultiplyPlain(
+      const Polynomial& weights,
+      const FHEContext& fhe_context) const;
+
   // Homomorphic rotation: Enc(a) → Enc(rotated(a)).
   //
   // Rotates encrypted polynomial coefficients cyclically.
@@ -181,32 +204,61 @@ class EncryptedPolynomial {
   // This allows the server to compute character-based routing WITHOUT
   // decrypting the polynomial!
   //
+  // BGV computes exactly mod p, so the characters are the F_p characters
+  // χⱼ(m) = ω^(jm) with ω = CharacterRoot(), and every coefficient s is
+  // projected over the window s, s+1, ..., s+k−1 (k = kNumCharacters):
+  //   Proj_χⱼ(p)[s] = k⁻¹ Σₘ ω^(−jm) · p[(s + m) mod d]
+  //                 = (k⁻¹ Σₘ ω^(−jm) · Rotate(p, −m))[s]
+  // This is the F_p analogue of Polynomial::ProjectToCharacter, whose
+  // complex characters and rounding cannot be evaluated homomorphically;
+  // its slot s corresponds to coefficient s·k here. Summing all k
+  // projections gives back p.
+  //
   // Args:
   //   character_index: Index j (0 ≤ j < kNumCharacters)
   //   fhe_context: FHE crypto context
+  //   token, progress: As for CharacterTransform::Project
   //
   // Returns:
   //   Encrypted projection onto character χⱼ
   //   Error if character_index out of range or operation fails
+  //   Cancelled / DeadlineExceeded from `token`
   //
-  // Performance: O(k * n log n) where k = kNumCharacters
+  // Performance: CharacterTransform::Project, baby-step/giant-step with
+  // g = BabyStepCount(k): two hoisted decompositions, g + k/g − 2 keyed
+  // rotations (all in RotationKeySet::Default), g + k/g scalar multiplies.
+  // Depth-0.
   //
   // Server-safe: YES (this is the key to blind routing!)
   absl::StatusOr<EncryptedPolynomial> ProjectToCharacter(
       int character_index,
-      const FHEContext& fhe_context) const;
+      const FHEContext& fhe_context,
+      const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr) const;
 
   // Computes all character projections homomorphically.
   //
+  // `token` is checked between giant-step groups and `progress` counts
+  // them (see CharacterTransform::ProjectAll).
+  //
   // Returns:
-  //   Vector of encrypted projections [Enc(Proj_χ₀), ..., Enc(Proj_χₖ)]
+  //   Vector of encrypted projections [Enc(Proj_χ₀), ..., Enc(Proj_χₖ₋₁)]
   //   Error if operation fails
+  //   Cancelled / DeadlineExceeded from `token`
   //
-  // Performance: O(k * n log n)
+  // Performance: CharacterTransform::ProjectAll, one baby-step/giant-step
+  // DFT: 1 + k/g = O(√k) decompositions and k − 1 keyed rotations for all
+  // k projections (vs 2k and k·(g + k/g − 2) for k single projections).
   //
   // Server-safe: YES
   absl::StatusOr<std::vector<EncryptedPolynomial>> ProjectToAllCharacters(
-      const FHEContext& fhe_context) const;
+      const FHEContext& fhe_context,
+      const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr) const;
+
+  // Primitive kNumCharacters-th root of unity ω mod kModulus that defines
+  // the encrypted characters (exists because k divides p − 1).
+  static int64_t CharacterRoot();
 
   // Accessors.
 
@@ -218,7 +270,7 @@ class EncryptedPolynomial {
  private:
   explicit EncryptedPolynomial(Ciphertext ciphertext);
 
-  // OpenFHE ciphertext (encrypted polynomial coefficients)
+  // Backend ciphertext (encrypted polynomial coefficients)
   Ciphertext ciphertext_;
 };
 
@@ -0,0 +1,89 @@
+// lib/crypto/fhe_backend.cc
+//
+// Implementation of the FHE backend registry and key memory reports.
+
+#include "lib/crypto/fhe_backend.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include "absl/synchronization/mutex.h"
+
+namespace f2chat {
+namespace {
+
+struct Registry {
+  absl::Mutex mutex;
+  std::map<std::string, FheBackendFactory, std::less<>> factories
+      ABSL_GUARDED_BY(mutex);
+};
+
+Registry& GetRegistry() {
+  // Leaked: registrars run during static init, lookups may run at exit.
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+}  // namespace
+
+std::string KeyMemoryReport::DebugString() const {
+  return absl::StrFormat(
+      "%d rotation keys (≤ %d key switches per rotation): %.1f MiB",
+      num_rotation_keys, max_key_switches,
+      static_cast<double>(total_bytes()) / (1 << 20));
+}
+
+absl::Status RegisterFheBackend(absl::string_view name,
+                                FheBackendFactory factory) {
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  bool inserted =
+      registry.factories.emplace(std::string(name), std::move(factory))
+          .second;
+  if (!inserted) {
+    return absl::AlreadyExistsError(
+        absl::StrFormat("FHE backend '%s' is already registered", name));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::shared_ptr<const FheBackend>> CreateFheBackend(
+    absl::string_view name) {
+  FheBackendFactory factory;
+  {
+    Registry& registry = GetRegistry();
+    absl::MutexLock lock(&registry.mutex);
+    auto it = registry.factories.find(name);
+    if (it == registry.factories.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Unknown FHE backend '%s'", name));
+    }
+    factory = it->second;
+  }
+  // Factories may be slow (parameter generation); run them unlocked.
+  return factory();
+}
+
+std::vector<std::string> RegisteredFheBackends() {
+  Registry& registry = GetRegistry();
+  absl::MutexLock lock(&registry.mutex);
+  std::vector<std::string> names;
+  names.reserve(registry.factories.size());
+  for (const auto& [name, factory] : registry.factories) {
+    names.push_back(name);
+  }
+  return names;
+}
+
+FheBackendRegistrar::FheBackendRegistrar(absl::string_view name,
+                                         FheBackendFactory factory) {
+  absl::Status status = RegisterFheBackend(name, std::move(factory));
+  if (!status.ok()) {
+    // Two backends linked under one name is a build error.
+    std::fprintf(stderr, "%s\n", status.ToString().c_str());
+    std::abort();
+  }
+}
+
+}  // namespace f2chat
@@ -0,0 +1,259 @@
+// lib/crypto/fhe_backend.h
+//
+// Pluggable FHE backend interface and registry.
+//
+// FHEContext and EncryptedPolynomial talk to an abstract FheBackend rather
+// than to a particular library. A backend owns its scheme parameters and
+// hands out strongly typed, opaque handles (ciphertexts and keys) that only
+// it can interpret. Backends register a factory under a short name
+// ("native", "openfhe", ...) so a deployment or a benchmark can pick an
+// implementation at runtime without touching callers.
+//
+// Key Properties:
+// - Handles remember the backend that created them; passing a handle to a
+//   different backend is an InvalidArgument error, never a bad cast
+// - Backends are immutable after creation and shared between contexts
+// - Registration happens at static-initialization time (alwayslink)
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_FHE_BACKEND_H_
+#define F2CHAT_LIB_CRYPTO_FHE_BACKEND_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lib/crypto/rotation_keys.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+
+namespace f2chat {
+
+class FheBackend;
+
+// Base class of every backend-owned handle.
+//
+// Concrete backends derive their ciphertext/key representations from the
+// typed subclasses below. The owning backend is recorded so that a handle
+// from one backend is rejected by another.
+class FheHandle {
+ public:
+  explicit FheHandle(const FheBackend* backend) : backend_(backend) {}
+  virtual ~FheHandle() = default;
+
+  FheHandle(const FheHandle&) = delete;
+  FheHandle& operator=(const FheHandle&) = delete;
+
+  // Backend that created this handle (identity only, not ownership).
+  const FheBackend* backend() const { return backend_; }
+
+ private:
+  const FheBackend* backend_;
+};
+
+class FheCiphertext : public FheHandle {
+ public:
+  using FheHandle::FheHandle;
+};
+
+class FhePublicKey : public FheHandle {
+ public:
+  using FheHandle::FheHandle;
+};
+
+class FhePrivateKey : public FheHandle {
+ public:
+  using FheHandle::FheHandle;
+};
+
+class FhePlaintext : public FheHandle {
+ public:
+  using FheHandle::FheHandle;
+};
+
+// Handles are immutable and freely shared (ciphertexts are values).
+using Ciphertext = std::shared_ptr<const FheCiphertext>;
+using PublicKey = std::shared_ptr<const FhePublicKey>;
+using PrivateKey = std::shared_ptr<const FhePrivateKey>;
+// Encoded plaintext operand (see FheBackend::EncodePlaintext).
+using Plaintext = std::shared_ptr<const FhePlaintext>;
+
+// FHE key pair for a user (public key shared, private key device-held).
+struct FHEKeyPair {
+  PublicKey public_key;    // Shared with contacts (for encryption)
+  PrivateKey private_key;  // Device-held only (for decryption)
+};
+
+// Evaluation-key footprint of one key pair: what a server keeps per user.
+struct KeyMemoryReport {
+  int num_rotation_keys = 0;
+  int max_key_switches = 0;  // Costliest composed rotation
+  int64_t public_key_bytes = 0;
+  int64_t rotation_key_bytes = 0;
+
+  int64_t total_bytes() const { return public_key_bytes + rotation_key_bytes; }
+
+  // e.g. "24 rotation keys (≤ 3 key switches per rotation): 151.0 MiB"
+  std::string DebugString() const;
+};
+
+// Abstract FHE backend.
+//
+// Implements the depth-0 operation set FHEContext exposes. Plaintexts are
+// polynomial coefficient vectors of length <= RingParams::kDegree, reduced
+// modulo plaintext_modulus(); Rotate() is the cyclic coefficient rotation of
+// Polynomial::Rotate.
+//
+// Thread Safety: All methods are const and must be safe to call
+// concurrently.
+class FheBackend {
+ public:
+  virtual ~FheBackend() = default;
+
+  // Registry name of this backend ("native", "openfhe", ...).
+  virtual absl::string_view name() const = 0;
+
+  // Scheme parameters.
+  virtual int ring_dimension() const = 0;
+  virtual int64_t plaintext_modulus() const = 0;
+
+  // Coefficients per plaintext (d): Encrypt and EncodePlaintext take at
+  // most d values, and Rotate() is cyclic mod d.
+  virtual int message_degree() const = 0;
+
+  // Generates a key pair with the backend's default rotation keys
+  // (RotationKeySet::Default for its message degree).
+  virtual absl::StatusOr<FHEKeyPair> GenerateKeyPair() const = 0;
+
+  // Generates a key pair with keys for exactly `rotations`; Rotate()
+  // composes every other rotation from them.
+  //
+  // Returns:
+  //   Key pair
+  //   InvalidArgument if the set is for a different message degree
+  virtual absl::StatusOr<FHEKeyPair> GenerateKeyPair(
+      const RotationKeySet& rotations) const = 0;
+
+  // Reports the evaluation-key memory held with `public_key`.
+  virtual absl::StatusOr<KeyMemoryReport> KeyMemory(
+      const PublicKey& public_key) const = 0;
+
+  virtual absl::StatusOr<Ciphertext> Encrypt(
+      const std::vector<int64_t>& coefficients,
+      const PublicKey& public_key) const = 0;
+
+  virtual absl::StatusOr<std::vector<int64_t>> Decrypt(
+      const Ciphertext& ciphertext,
+      const PrivateKey& private_key) const = 0;
+
+  virtual absl::StatusOr<Ciphertext> Add(
+      const Ciphertext& ct1,
+      const Ciphertext& ct2) const = 0;
+
+  virtual absl::StatusOr<Ciphertext> Subtract(
+      const Ciphertext& ct1,
+      const Ciphertext& ct2) const = 0;
+
+  virtual absl::StatusOr<Ciphertext> MultiplyScalar(
+      const Ciphertext& ciphertext,
+      int64_t scalar) const = 0;
+
+  // Encodes a plaintext operand for MultiplyPlain: ≤ d coefficients mod
+  // plaintext_modulus(), in the backend's evaluation form, so products
+  // with many ciphertexts pay for the encoding once.
+  //
+  // Returns:
+  //   Encoded plaintext
+  //   InvalidArgument if there are more than d coefficients
+  virtual absl::StatusOr<Plaintext> EncodePlaintext(
+      const std::vector<int64_t>& coefficients) const = 0;
+
+  // Coefficient-wise product with a plaintext: coefficient i of the result
+  // is a[i]·b[i] mod p (the SIMD slot product, not the ring product).
+  // Needs no evaluation key and no relinearization; the noise grows by
+  // the norm of the encoded plaintext.
+  virtual absl::StatusOr<Ciphertext> MultiplyPlain(
+      const Ciphertext& ciphertext,
+      const Plaintext& plaintext) const = 0;
+
+  // Rotates by `positions`, composed from keyed rotations when the key
+  // pair has no key for it (FailedPrecondition if it cannot be composed).
+  virtual absl::StatusOr<Ciphertext> Rotate(
+      const Ciphertext& ciphertext,
+      int positions) const = 0;
+
+  // Rotates one ciphertext by each of `positions` with hoisting: the
+  // key-switching decomposition of the ciphertext is computed once and
+  // reused by every rotation, instead of once per Rotate() call. Composed
+  // rotations hoist their first key switch only.
+  //
+  // Returns:
+  //   rotated[i] == Rotate(ciphertext, positions[i]) (same plaintext)
+  //   FailedPrecondition if some rotation cannot be composed
+  virtual absl::StatusOr<std::vector<Ciphertext>> RotateHoisted(
+      const Ciphertext& ciphertext,
+      const std::vector<int>& positions) const = 0;
+
+ protected:
+  // Resolves a handle to the backend's concrete type.
+  //
+  // Returns:
+  //   Pointer to the concrete handle
+  //   InvalidArgument if the handle is null or owned by another backend
+  template <typename Concrete, typename Handle>
+  absl::StatusOr<const Concrete*> Unwrap(
+      const std::shared_ptr<const Handle>& handle,
+      absl::string_view what) const {
+    if (handle == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Null %s passed to FHE backend '%s'", what, name()));
+    }
+    if (handle->backend() != this) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "%s was created by a different FHE backend than '%s'", what,
+          name()));
+    }
+    return static_cast<const Concrete*>(handle.get());
+  }
+};
+
+// Factory building a backend for the compiled-in RingParams.
+using FheBackendFactory =
+    std::function<absl::StatusOr<std::shared_ptr<const FheBackend>>()>;
+
+// Registers a backend factory under `name`.
+//
+// Returns:
+//   OK on success
+//   AlreadyExists if the name is taken
+absl::Status RegisterFheBackend(absl::string_view name,
+                                FheBackendFactory factory);
+
+// Creates the backend registered under `name`.
+//
+// Returns:
+//   The backend
+//   NotFound if no backend of that name is linked in
+//   Whatever the factory returns on failure
+absl::StatusOr<std::shared_ptr<const FheBackend>> CreateFheBackend(
+    absl::string_view name);
+
+// Names of all registered backends, sorted.
+std::vector<std::string> RegisteredFheBackends();
+
+// Registers a backend from a namespace-scope static in the backend's .cc.
+//
+// Usage:
+//   static FheBackendRegistrar registrar("native", &NativeBackend::Create);
+struct FheBackendRegistrar {
+  FheBackendRegistrar(absl::string_view name, FheBackendFactory factory);
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_FHE_BACKEND_H_
@@ -3,103 +3,79 @@
 // Implementation of FHE crypto context management.
 
 #include "lib/crypto/fhe_context.h"
-#include "absl/strings/str_format.h"
 
-// Note: OpenFHE headers will be included here once the build is working
-// For now, we'll create stub implementations to get the structure in place
+#include <cstdlib>
+#include <deque>
+#include <utility>
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 
 namespace f2chat {
 
+struct FHEContext::PlaintextCache {
+  absl::Mutex mu;
+  absl::flat_hash_map<std::vector<int64_t>, Plaintext> entries
+      ABSL_GUARDED_BY(mu);
+  std::deque<std::vector<int64_t>> order ABSL_GUARDED_BY(mu);  // Oldest first
+};
+
 // Static factory method
 absl::StatusOr<FHEContext> FHEContext::Create() {
-  // TODO: Initialize OpenFHE crypto context with BGV scheme
-  //
-  // Planned implementation:
-  // 1. Create CryptoContext with BGV scheme
-  // 2. Set parameters:
-  //    - Ring dimension: RingParams::kDegree (64/256/4096)
-  //    - Modulus: RingParams::kModulus (65537)
-  //    - Security level: HEStd_128_classic
-  //    - Multiplicative depth: 0 (depth-0 operations only!)
-  // 3. Enable features:
-  //    - Encryption
-  //    - SHE (for homomorphic operations)
-  //    - Leveled SHE (for efficient depth-0 operations)
-  //
-  // Example OpenFHE code:
-  // CCParams<CryptoContextBGVRNS> parameters;
-  // parameters.SetMultiplicativeDepth(0);
-  // parameters.SetPlaintextModulus(RingParams::kModulus);
-  // parameters.SetRingDim(RingParams::kDegree);
-  // CryptoContext cc = GenCryptoContext(parameters);
-  // cc->Enable(PKE);
-  // cc->Enable(KEYSWITCH);
-  // cc->Enable(LEVELEDSHE);
-
-  return absl::UnimplementedError(
-      "FHEContext::Create() - OpenFHE integration pending. "
-      "This will be implemented once OpenFHE build is configured.");
+  const char* backend = std::getenv("F2CHAT_FHE_BACKEND");
+  if (backend == nullptr || *backend == '\0') {
+    backend = kDefaultFheBackend;
+  }
+  return Create(absl::string_view(backend));
+}
+
+absl::StatusOr<FHEContext> FHEContext::Create(absl::string_view backend) {
+  auto backend_or = CreateFheBackend(backend);
+  if (!backend_or.ok()) {
+    return backend_or.status();
+  }
+  return Create(std::move(backend_or).value());
+}
+
+absl::StatusOr<FHEContext> FHEContext::Create(
+    std::shared_ptr<const FheBackend> backend) {
+  if (backend == nullptr) {
+    return absl::InvalidArgumentError("FHE backend must not be null");
+  }
+  return FHEContext(std::move(backend));
 }
 
 absl::StatusOr<FHEKeyPair> FHEContext::GenerateKeyPair() const {
-  // TODO: Generate FHE key pair using OpenFHE
-  //
-  // Planned implementation:
-  // KeyPair kp = crypto_context_->KeyGen();
-  // crypto_context_->EvalMultKeyGen(kp.secretKey);
-  //
-  // Generate rotation keys for all positions:
-  // std::vector<int32_t> rotations;
-  // for (int i = 1; i < RingParams::kDegree; ++i) {
-  //   rotations.push_back(i);
-  //   rotations.push_back(-i);
-  // }
-  // crypto_context_->EvalRotateKeyGen(kp.secretKey, rotations);
-  //
-  // return FHEKeyPair{kp.publicKey, kp.secretKey};
-
-  return absl::UnimplementedError(
-      "FHEContext::GenerateKeyPair() - OpenFHE integration pending.");
+  return backend_->GenerateKeyPair();
+}
+
+absl::StatusOr<FHEKeyPair> FHEContext::GenerateKeyPair(
+    const RotationKeySet& rotations) const {
+  return backend_->GenerateKeyPair(rotations);
+}
+
+absl::StatusOr<KeyMemoryReport> FHEContext::KeyMemory(
+    const PublicKey& public_key) const {
+  return backend_->KeyMemory(public_key);
 }
 
 absl::StatusOr<Ciphertext> FHEContext::Encrypt(
     const std::vector<int64_t>& coefficients,
     const PublicKey& public_key) const {
-  (void)public_key;  // Suppress unused parameter warning (stub implementation)
-
   if (coefficients.size() > static_cast<size_t>(RingParams::kDegree)) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Too many coefficients: %d (max: %d)",
         coefficients.size(), RingParams::kDegree));
   }
 
-  // TODO: Encrypt using OpenFHE
-  //
-  // Planned implementation:
-  // Plaintext pt = crypto_context_->MakePackedPlaintext(coefficients);
-  // Ciphertext ct = crypto_context_->Encrypt(public_key, pt);
-  // return ct;
-
-  return absl::UnimplementedError(
-      "FHEContext::Encrypt() - OpenFHE integration pending.");
+  return backend_->Encrypt(coefficients, public_key);
 }
 
 absl::StatusOr<std::vector<int64_t>> FHEContext::Decrypt(
     const Ciphertext& ciphertext,
     const PrivateKey& private_key) const {
-  (void)ciphertext;  // Suppress unused parameter warning
-  (void)private_key;
-
-  // TODO: Decrypt using OpenFHE
-  //
-  // Planned implementation:
-  // Plaintext pt;
-  // crypto_context_->Decrypt(private_key, ciphertext, &pt);
-  // std::vector<int64_t> result = pt->GetPackedValue();
-  // return result;
-
-  return absl::UnimplementedError(
-      "FHEContext::Decrypt() - OpenFHE integration pending.");
+  return backend_->Decrypt(ciphertext, private_key);
 }
 
 // Homomorphic operations
@@ -107,88 +83,90 @@ absl::StatusOr<std::vector<int64_t>> FHEContext::Decrypt(
 absl::StatusOr<Ciphertext> FHEContext::HomomorphicAdd(
     const Ciphertext& ct1,
     const Ciphertext& ct2) const {
-  (void)ct1;  // Suppress unused parameter warning
-  (void)ct2;
-
-  // TODO: Homomorphic addition using OpenFHE
-  //
-  // Planned implementation:
-  // Ciphertext result = crypto_context_->EvalAdd(ct1, ct2);
-  // return result;
-  //
-  // Note: This is depth-0 (no bootstrapping needed!)
-
-  return absl::UnimplementedError(
-      "FHEContext::HomomorphicAdd() - OpenFHE integration pending.");
+  return backend_->Add(ct1, ct2);
 }
 
 absl::StatusOr<Ciphertext> FHEContext::HomomorphicSubtract(
     const Ciphertext& ct1,
     const Ciphertext& ct2) const {
-  (void)ct1;  // Suppress unused parameter warning
-  (void)ct2;
-
-  // TODO: Homomorphic subtraction using OpenFHE
-  //
-  // Planned implementation:
-  // Ciphertext result = crypto_context_->EvalSub(ct1, ct2);
-  // return result;
-  //
-  // Note: This is depth-0 (no bootstrapping needed!)
-
-  return absl::UnimplementedError(
-      "FHEContext::HomomorphicSubtract() - OpenFHE integration pending.");
+  return backend_->Subtract(ct1, ct2);
 }
 
 absl::StatusOr<Ciphertext> FHEContext::HomomorphicMultiplyScalar(
     const Ciphertext& ciphertext,
     int64_t scalar) const {
-  (void)ciphertext;  // Suppress unused parameter warning
-  (void)scalar;
+  return backend_->MultiplyScalar(ciphertext, scalar);
+}
+
+absl::StatusOr<Plaintext> FHEContext::EncodePlaintext(
+    const Polynomial& plaintext) const {
+  const std::vector<int64_t>& key = plaintext.coefficients();
+  {
+    absl::MutexLock lock(&plaintext_cache_->mu);
+    auto it = plaintext_cache_->entries.find(key);
+    if (it != plaintext_cache_->entries.end()) return it->second;
+  }
+
+  // Encode outside the lock; a concurrent miss on the same key keeps the
+  // first encoding.
+  auto encoded = backend_->EncodePlaintext(key);
+  if (!encoded.ok()) {
+    return encoded.status();
+  }
+  absl::MutexLock lock(&plaintext_cache_->mu);
+  auto [it, inserted] = plaintext_cache_->entries.emplace(key, *encoded);
+  if (inserted) {
+    plaintext_cache_->order.push_back(key);
+    if (plaintext_cache_->order.size() >
+        static_cast<size_t>(kPlaintextCacheCapacity)) {
+      plaintext_cache_->entries.erase(plaintext_cache_->order.front());
+      plaintext_cache_->order.pop_front();
+    }
+  }
+  return it->second;
+}
 
-  // TODO: Homomorphic scalar multiplication using OpenFHE
-  //
-  // Planned implementation:
-  // Ciphertext result = crypto_context_->EvalMult(ciphertext, scalar);
-  // return result;
-  //
-  // Note: This is depth-0 (plaintext-ciphertext multiplication!)
+absl::StatusOr<Ciphertext> FHEContext::HomomorphicMultiplyPlain(
+    const Ciphertext& ciphertext,
+    const Polynomial& plaintext) const {
+  auto encoded = EncodePlaintext(plaintext);
+  if (!encoded.ok()) {
+    return encoded.status();
+  }
+  return backend_->MultiplyPlain(ciphertext, *encoded);
+}
 
-  return absl::UnimplementedError(
-      "FHEContext::HomomorphicMultiplyScalar() - OpenFHE integration pending.");
+absl::StatusOr<Ciphertext> FHEContext::HomomorphicMultiplyPlain(
+    const Ciphertext& ciphertext,
+    const Plaintext& plaintext) const {
+  return backend_->MultiplyPlain(ciphertext, plaintext);
 }
 
 absl::StatusOr<Ciphertext> FHEContext::HomomorphicRotate(
     const Ciphertext& ciphertext,
     int positions) const {
-  (void)ciphertext;  // Suppress unused parameter warning
-  (void)positions;
-
-  // TODO: Homomorphic rotation using OpenFHE
-  //
-  // Planned implementation:
-  // Ciphertext result = crypto_context_->EvalRotate(ciphertext, positions);
-  // return result;
-  //
-  // Note: Requires rotation keys to be generated (done in GenerateKeyPair)
-  // This is depth-0 (uses automorphisms, not multiplications!)
+  return backend_->Rotate(ciphertext, positions);
+}
 
-  return absl::UnimplementedError(
-      "FHEContext::HomomorphicRotate() - OpenFHE integration pending.");
+absl::StatusOr<std::vector<Ciphertext>> FHEContext::HomomorphicRotateHoisted(
+    const Ciphertext& ciphertext,
+    const std::vector<int>& positions) const {
+  return backend_->RotateHoisted(ciphertext, positions);
 }
 
 // Accessors
 
 int FHEContext::ring_dimension() const {
-  return RingParams::kDegree;
+  return backend_->ring_dimension();
 }
 
 int64_t FHEContext::modulus() const {
-  return RingParams::kModulus;
+  return backend_->plaintext_modulus();
 }
 
 // Private constructor
-FHEContext::FHEContext(CryptoContext crypto_context)
-    : crypto_context_(crypto_context) {}
+FHEContext::FHEContext(std::shared_ptr<const FheBackend> backend)
+    : backend_(std::move(backend)),
+      plaintext_cache_(std::make_shared<PlaintextCache>()) {}
 
 }  // namespace f2chat
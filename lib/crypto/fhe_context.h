@@ -2,16 +2,18 @@
 //
 // FHE crypto context management for blind polynomial routing.
 //
-// Wraps OpenFHE's BGV scheme to provide:
+// Fronts a pluggable FheBackend (see fhe_backend.h) to provide:
 // - Crypto context initialization (ring parameters, security level)
 // - Key pair generation (public/private keys)
 // - Encryption/decryption of polynomial coefficients
-// - Depth-0 operations (addition, subtraction, rotation)
+// - Depth-0 operations (addition, subtraction, plaintext products,
+//   rotation)
 //
 // Key Properties:
 // - BGV scheme for integer arithmetic (matches polynomial coefficients)
 // - Ring dimension matched to PolynomialParams
 // - Depth-0 operations only (no bootstrapping needed!)
+// - Backend chosen at runtime by name; callers never see its types
 //
 // Author: bon-cdp (shakilflynn@gmail.com)
 // Date: 2025-11-11
@@ -21,42 +23,24 @@
 
 #include <memory>
 #include <vector>
+#include "lib/crypto/fhe_backend.h"
+#include "lib/crypto/polynomial.h"
 #include "lib/crypto/polynomial_params.h"
 #include "absl/status/statusor.h"
 #include "absl/status/status.h"
-
-// Forward declarations for OpenFHE types (to avoid exposing in header)
-// Note: These are stub declarations for now. When OpenFHE is integrated,
-// we'll include the actual OpenFHE headers.
-namespace lbcrypto {
-  class DCRTPoly;
-  template <typename Element> class CryptoContextImpl;
-  template <typename Element> class CiphertextImpl;
-  template <typename Element> class PublicKeyImpl;
-  template <typename Element> class PrivateKeyImpl;
-}
+#include "absl/strings/string_view.h"
 
 namespace f2chat {
 
-// Stub types for OpenFHE (will be replaced when OpenFHE is integrated)
-// Using void* as placeholder to avoid template issues
-using CryptoContext = std::shared_ptr<void>;
-using Ciphertext = std::shared_ptr<void>;
-using Plaintext = std::shared_ptr<void>;
-using PublicKey = std::shared_ptr<void>;
-using PrivateKey = std::shared_ptr<void>;
-using KeyPair = std::shared_ptr<void>;
-
-// FHE key pair for a user (public key shared, private key device-held).
-struct FHEKeyPair {
-  PublicKey public_key;    // Shared with contacts (for encryption)
-  PrivateKey private_key;  // Device-held only (for decryption)
-};
+// Backend used when neither the caller nor F2CHAT_FHE_BACKEND names one:
+// the in-tree BGV implementation (native_bgv_backend.h).
+inline constexpr char kDefaultFheBackend[] = "native";
 
 // FHE crypto context manager.
 //
-// This class manages the OpenFHE crypto context and provides
+// This class manages the backend crypto context and provides
 // high-level operations for encrypting/decrypting polynomials.
+// Copies share the same (immutable) backend.
 //
 // Thread Safety: Thread-safe after initialization (immutable context).
 //
@@ -64,30 +48,53 @@ struct FHEKeyPair {
 // - Encryption: O(n log n) where n = ring dimension
 // - Decryption: O(n log n)
 // - Homomorphic Add/Sub: O(n) (depth-0!)
+// - Homomorphic MultiplyPlain: O(n) with a cached encoding (depth-0!)
 // - Homomorphic Rotate: O(n log n) (depth-0!)
 class FHEContext {
  public:
   // Creates FHE context with default parameters.
   //
-  // Initializes OpenFHE BGV scheme with:
-  // - Ring dimension: matched to RingParams::kDegree
+  // Uses the backend named by the F2CHAT_FHE_BACKEND environment variable,
+  // or kDefaultFheBackend if unset. Initializes a BGV scheme with:
+  // - Ring dimension: smallest 128-bit ring holding RingParams::kDegree
+  //   coefficients per slot row
   // - Modulus: matched to RingParams::kModulus
   // - Security level: 128-bit (HEStd_128_classic)
   // - Multiplicative depth: 0 (depth-0 operations only!)
   //
   // Returns:
   //   FHEContext instance ready for key generation and encryption
-  //   Error if OpenFHE initialization fails
+  //   Error if backend initialization fails
   //
   // Performance: ~10ms (one-time setup)
   static absl::StatusOr<FHEContext> Create();
 
+  // Creates FHE context on a specific registered backend.
+  //
+  // Args:
+  //   backend: Registry name, e.g. "native" (see RegisteredFheBackends())
+  //
+  // Returns:
+  //   FHEContext bound to that backend
+  //   NotFound if the backend is not linked in
+  //   Error if backend initialization fails
+  static absl::StatusOr<FHEContext> Create(absl::string_view backend);
+
+  // Wraps an already constructed backend (tests, benchmarks).
+  //
+  // Returns:
+  //   FHEContext bound to `backend`
+  //   InvalidArgument if backend is null
+  static absl::StatusOr<FHEContext> Create(
+      std::shared_ptr<const FheBackend> backend);
+
   // Generates a new FHE key pair.
   //
   // Creates:
   // - Public key: For encryption by contacts
   // - Private key: For decryption (device-held only)
-  // - Evaluation keys: For homomorphic operations (rotation, etc.)
+  // - Evaluation keys: For homomorphic operations (rotation, etc.), by
+  //   default RotationKeySet::Default (O(log n) rotation keys)
   //
   // Returns:
   //   FHEKeyPair with public/private keys
@@ -96,6 +103,20 @@ class FHEContext {
   // Performance: ~50ms (generates keys for depth-0 operations)
   absl::StatusOr<FHEKeyPair> GenerateKeyPair() const;
 
+  // Generates a key pair with rotation keys for exactly `rotations`
+  // (e.g. Default(d) merged with a workload's baby-step/giant-step set).
+  //
+  // Returns:
+  //   FHEKeyPair with public/private keys
+  //   InvalidArgument if the set is for another message degree
+  //
+  // Performance: one key-switching key per rotation in the set
+  absl::StatusOr<FHEKeyPair> GenerateKeyPair(
+      const RotationKeySet& rotations) const;
+
+  // Evaluation-key memory a server holds for `public_key` (per user).
+  absl::StatusOr<KeyMemoryReport> KeyMemory(const PublicKey& public_key) const;
+
   // Encrypts polynomial coefficients.
   //
   // Encrypts a vector of integers (polynomial coefficients) using
@@ -182,10 +203,48 @@ class FHEContext {
       const Ciphertext& ciphertext,
       int64_t scalar) const;
 
+  // Encodes a plaintext polynomial for HomomorphicMultiplyPlain.
+  //
+  // Encodings are kept in the backend's evaluation form and cached by
+  // coefficients (shared by copies of this context, oldest evicted past
+  // kPlaintextCacheCapacity), so a weight polynomial applied to many
+  // ciphertexts is encoded once.
+  //
+  // Returns:
+  //   Encoded plaintext (the cached one on a hit)
+  //   Error if encoding fails
+  //
+  // Performance: O(d) on a hit; one encoding (O(n log n)) on a miss
+  absl::StatusOr<Plaintext> EncodePlaintext(const Polynomial& plaintext) const;
+
+  // Homomorphic plaintext multiplication: Enc(a), b → Enc(a ⊙ b).
+  //
+  // Multiplies coefficient i by b[i] mod p (position-dependent weights;
+  // the slot product, not Polynomial::Multiply). Needs no evaluation key
+  // and no relinearization.
+  //
+  // Args:
+  //   ciphertext: Encrypted polynomial a
+  //   plaintext: Plaintext weights b (encoded through the cache)
+  //
+  // Returns:
+  //   Encrypted product Enc(a ⊙ b)
+  //   Error if operation fails
+  //
+  // Performance: O(n) (one pointwise product per RNS limb), depth-0
+  absl::StatusOr<Ciphertext> HomomorphicMultiplyPlain(
+      const Ciphertext& ciphertext,
+      const Polynomial& plaintext) const;
+
+  // Same, with an operand from EncodePlaintext.
+  absl::StatusOr<Ciphertext> HomomorphicMultiplyPlain(
+      const Ciphertext& ciphertext,
+      const Plaintext& plaintext) const;
+
   // Homomorphic rotation: Enc(a) → Enc(rotated(a)).
   //
-  // Rotates encrypted polynomial coefficients cyclically.
-  // Requires rotation keys to be generated.
+  // Rotates encrypted polynomial coefficients cyclically. Rotations
+  // without their own key are composed from keyed ones.
   //
   // Args:
   //   ciphertext: Encrypted polynomial
@@ -193,26 +252,55 @@ class FHEContext {
   //
   // Returns:
   //   Encrypted rotated polynomial
-  //   Error if operation fails or rotation keys not generated
+  //   Error if operation fails or the rotation keys cannot compose it
   //
-  // Performance: O(n log n), depth-0
+  // Performance: O(n log n) per key switch (≤ log2 d with the default
+  // keys), depth-0
   absl::StatusOr<Ciphertext> HomomorphicRotate(
       const Ciphertext& ciphertext,
       int positions) const;
 
+  // Hoisted rotations: Enc(a) → [Enc(rotated(a, positions[i]))].
+  //
+  // Rotates one ciphertext by many offsets, decomposing it for key
+  // switching only once. Use this whenever several rotations of the same
+  // ciphertext are summed (character projections, linear transforms).
+  //
+  // Args:
+  //   ciphertext: Encrypted polynomial
+  //   positions: Rotation amounts (0 returns the input unchanged)
+  //
+  // Returns:
+  //   One rotated ciphertext per entry of `positions`, in order
+  //   Error if operation fails or the rotation keys cannot compose one
+  //
+  // Performance: one decomposition (O(n log n)) plus O(n) per keyed
+  // rotation, depth-0
+  absl::StatusOr<std::vector<Ciphertext>> HomomorphicRotateHoisted(
+      const Ciphertext& ciphertext,
+      const std::vector<int>& positions) const;
+
+  // Plaintext encodings EncodePlaintext keeps per context.
+  static constexpr int kPlaintextCacheCapacity = 256;
+
   // Accessors.
 
-  CryptoContext crypto_context() const { return crypto_context_; }
+  const FheBackend& backend() const { return *backend_; }
 
-  // Ring parameters.
+  // Ring parameters of the backend's scheme.
   int ring_dimension() const;
   int64_t modulus() const;
 
  private:
-  explicit FHEContext(CryptoContext crypto_context);
+  struct PlaintextCache;
+
+  explicit FHEContext(std::shared_ptr<const FheBackend> backend);
+
+  // Backend crypto context (manages all FHE operations)
+  std::shared_ptr<const FheBackend> backend_;
 
-  // OpenFHE crypto context (manages all FHE operations)
-  CryptoContext crypto_context_;
+  // Encoded plaintexts by coefficients (internally synchronized)
+  std::shared_ptr<PlaintextCache> plaintext_cache_;
 };
 
 }  // namespace f2chat
@@ -0,0 +1,194 @@
+// lib/crypto/linear_transform.cc
+//
+// Implementation of Halevi–Shoup homomorphic linear transforms.
+
+#include "lib/crypto/linear_transform.h"
+
+#include <set>
+#include <utility>
+#include "lib/crypto/ntt.h"
+#include "absl/strings/str_format.h"
+
+namespace f2chat {
+namespace {
+
+bool IsPowerOfTwo(int64_t n) { return n > 0 && (n & (n - 1)) == 0; }
+
+}  // namespace
+
+absl::StatusOr<LinearTransform> LinearTransform::FromDiagonals(
+    int degree, std::map<int, std::vector<int64_t>> diagonals,
+    int64_t modulus) {
+  if (!IsPowerOfTwo(degree)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Degree must be a power of two, got %d", degree));
+  }
+  std::map<int, std::vector<int64_t>> reduced;
+  for (auto& [index, diagonal] : diagonals) {
+    if (diagonal.size() != static_cast<size_t>(degree)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Diagonal %d has %d values, expected %d", index, diagonal.size(),
+          degree));
+    }
+    bool zero = true;
+    for (int64_t& value : diagonal) {
+      value = static_cast<int64_t>(ReduceSigned(value, modulus));
+      zero = zero && value == 0;
+    }
+    if (zero) continue;
+
+    std::vector<int64_t>& target = reduced[((index % degree) + degree) % degree];
+    if (target.empty()) {
+      target = std::move(diagonal);
+      continue;
+    }
+    for (int r = 0; r < degree; ++r) {
+      target[r] = static_cast<int64_t>(AddMod(target[r], diagonal[r], modulus));
+    }
+  }
+  return LinearTransform(degree, modulus, std::move(reduced));
+}
+
+absl::StatusOr<LinearTransform> LinearTransform::FromMatrix(
+    int degree, const std::vector<int64_t>& matrix, int64_t modulus) {
+  if (!IsPowerOfTwo(degree) ||
+      matrix.size() != static_cast<size_t>(degree) * degree) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Expected a %d×%d matrix, got %d entries", degree, degree,
+        matrix.size()));
+  }
+  std::map<int, std::vector<int64_t>> diagonals;
+  for (int i = 0; i < degree; ++i) {
+    std::vector<int64_t> diagonal(degree);
+    for (int r = 0; r < degree; ++r) {
+      diagonal[r] = matrix[static_cast<size_t>(r) * degree + (r + i) % degree];
+    }
+    diagonals.emplace(i, std::move(diagonal));
+  }
+  return FromDiagonals(degree, std::move(diagonals), modulus);
+}
+
+LinearTransform::LinearTransform(int degree, int64_t modulus,
+                                 std::map<int, std::vector<int64_t>> diagonals)
+    : degree_(degree),
+      baby_steps_(BabyStepCount(degree)),
+      modulus_(modulus),
+      diagonals_(std::move(diagonals)) {}
+
+std::vector<int64_t> LinearTransform::ApplyPlaintext(
+    const std::vector<int64_t>& coefficients) const {
+  const int d = degree_;
+  const uint64_t p = modulus_;
+  std::vector<uint64_t> c(d, 0);
+  for (int r = 0; r < d && r < static_cast<int>(coefficients.size()); ++r) {
+    c[r] = ReduceSigned(coefficients[r], p);
+  }
+  std::vector<int64_t> result(d, 0);
+  for (const auto& [i, diagonal] : diagonals_) {
+    for (int r = 0; r < d; ++r) {
+      result[r] = static_cast<int64_t>(AddMod(
+          result[r], MulMod(diagonal[r], c[(r + i) % d], p), p));
+    }
+  }
+  return result;
+}
+
+RotationKeySet LinearTransform::Rotations() const {
+  RotationKeySet set(degree_);
+  for (const auto& [i, diagonal] : diagonals_) {
+    set.Add(-(i % baby_steps_));
+    set.Add(-(i - i % baby_steps_));
+  }
+  return set;
+}
+
+int LinearTransform::key_switches() const {
+  std::set<int> baby;
+  std::set<int> giant;
+  for (const auto& [i, diagonal] : diagonals_) {
+    if (i % baby_steps_ != 0) baby.insert(i % baby_steps_);
+    if (i >= baby_steps_) giant.insert(i / baby_steps_);
+  }
+  return static_cast<int>(baby.size() + giant.size());
+}
+
+absl::StatusOr<EncodedLinearTransform> LinearTransform::Encode(
+    const FheBackend& backend) const {
+  if (backend.plaintext_modulus() != modulus_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Transform is mod %d, backend plaintext modulus is %d", modulus_,
+        backend.plaintext_modulus()));
+  }
+  if (backend.message_degree() != degree_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Transform has degree %d, backend message degree is %d", degree_,
+        backend.message_degree()));
+  }
+  const int d = degree_;
+  const int g = baby_steps_;
+  EncodedLinearTransform encoded(&backend);
+
+  // Baby index of each used a (a = 0 is the input itself).
+  std::map<int, int> baby_index;
+  for (const auto& [i, diagonal] : diagonals_) baby_index.emplace(i % g, 0);
+  for (auto& [a, index] : baby_index) {
+    index = static_cast<int>(encoded.baby_positions_.size());
+    encoded.baby_positions_.push_back(-a);
+  }
+
+  for (const auto& [i, diagonal] : diagonals_) {
+    const int giant_step = i - i % g;
+    if (encoded.blocks_.empty() ||
+        encoded.blocks_.back().giant_step != giant_step) {
+      encoded.blocks_.push_back({giant_step, {}});
+    }
+    // diag'[r] = diag[r − g·b]: undone by the block's rotation by −g·b.
+    std::vector<int64_t> rotated(d);
+    for (int r = 0; r < d; ++r) rotated[(r + giant_step) % d] = diagonal[r];
+    auto plaintext = backend.EncodePlaintext(rotated);
+    if (!plaintext.ok()) return plaintext.status();
+    encoded.blocks_.back().terms.emplace_back(baby_index[i % g],
+                                              *std::move(plaintext));
+  }
+  return encoded;
+}
+
+absl::StatusOr<Ciphertext> EncodedLinearTransform::Apply(
+    const Ciphertext& ciphertext) const {
+  const FheBackend& backend = *backend_;
+  if (blocks_.empty()) return backend.MultiplyScalar(ciphertext, 0);
+
+  auto baby = backend.RotateHoisted(ciphertext, baby_positions_);
+  if (!baby.ok()) return baby.status();
+
+  Ciphertext result;
+  for (const Block& block : blocks_) {
+    Ciphertext inner;
+    for (const auto& [index, diagonal] : block.terms) {
+      auto term = backend.MultiplyPlain((*baby)[index], diagonal);
+      if (!term.ok()) return term.status();
+      if (inner == nullptr) {
+        inner = *std::move(term);
+        continue;
+      }
+      auto sum = backend.Add(inner, *term);
+      if (!sum.ok()) return sum.status();
+      inner = *std::move(sum);
+    }
+    if (block.giant_step != 0) {
+      auto giant = backend.Rotate(inner, -block.giant_step);
+      if (!giant.ok()) return giant.status();
+      inner = *std::move(giant);
+    }
+    if (result == nullptr) {
+      result = std::move(inner);
+      continue;
+    }
+    auto sum = backend.Add(result, inner);
+    if (!sum.ok()) return sum.status();
+    result = *std::move(sum);
+  }
+  return result;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,136 @@
+// lib/crypto/linear_transform.h
+//
+// Homomorphic linear transforms by the Halevi–Shoup diagonal method.
+//
+// A d×d matrix M over F_p acting on message coefficients is stored by its
+// generalized diagonals diagᵢ[r] = M[r][(r + i) mod d], so that
+//   M·c = Σᵢ diagᵢ ⊙ Rotate(c, −i)        (Rotate(c, −i)[r] = c[r + i])
+// and is evaluated baby-step/giant-step with i = a + g·b:
+//   M·c = Σ_b Rotate(Σₐ diag'ᵢ ⊙ Rotate(c, −a), −g·b),
+//   diag'ᵢ = Rotate(diagᵢ, g·b)              (pre-rotated plaintext)
+// The baby rotations of c share one hoisted decomposition, and each giant
+// block costs one more rotation, so a dense matrix takes g + d/g − 2 =
+// O(√d) key switches instead of d − 1.
+//
+// Key Properties:
+// - Zero diagonals are dropped; baby steps and giant blocks that no
+//   non-zero diagonal uses are skipped
+// - Diagonals are encoded for a backend once (EncodedLinearTransform) as
+//   evaluation-form plaintexts and reused for every ciphertext
+// - Each diagonal costs one MultiplyPlain (2·L pointwise products)
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_LINEAR_TRANSFORM_H_
+#define F2CHAT_LIB_CRYPTO_LINEAR_TRANSFORM_H_
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "lib/crypto/fhe_backend.h"
+#include "lib/crypto/polynomial_params.h"
+#include "lib/crypto/rotation_keys.h"
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+
+class EncodedLinearTransform;
+
+// F_p matrix on d-coefficient messages, in diagonal form.
+//
+// Thread Safety: Immutable after construction.
+class LinearTransform {
+ public:
+  // Builds a transform from its non-zero diagonals.
+  //
+  // Args:
+  //   degree: Message degree d (power of two)
+  //   diagonals: i → diagᵢ (d values each, reduced mod `modulus`);
+  //              indices are taken mod d
+  //   modulus: Plaintext modulus p
+  //
+  // Returns:
+  //   Transform
+  //   InvalidArgument for a bad degree or a diagonal of the wrong length
+  static absl::StatusOr<LinearTransform> FromDiagonals(
+      int degree, std::map<int, std::vector<int64_t>> diagonals,
+      int64_t modulus = RingParams::kModulus);
+
+  // Builds a transform from a dense row-major d×d matrix.
+  //
+  // Performance: O(d²) memory; prefer FromDiagonals for large d.
+  static absl::StatusOr<LinearTransform> FromMatrix(
+      int degree, const std::vector<int64_t>& matrix,
+      int64_t modulus = RingParams::kModulus);
+
+  // Plaintext reference: M·c mod p (missing coefficients are zero).
+  std::vector<int64_t> ApplyPlaintext(
+      const std::vector<int64_t>& coefficients) const;
+
+  // Rotations Apply uses: −a for each baby step and −g·b for each giant
+  // block that some non-zero diagonal needs.
+  RotationKeySet Rotations() const;
+
+  // Encodes the pre-rotated diagonals for `backend`, which must outlive
+  // the result.
+  //
+  // Returns:
+  //   Encoded transform
+  //   InvalidArgument if the backend's plaintext modulus or message
+  //   degree differs
+  absl::StatusOr<EncodedLinearTransform> Encode(
+      const FheBackend& backend) const;
+
+  int degree() const { return degree_; }
+  int baby_steps() const { return baby_steps_; }
+  int num_diagonals() const { return static_cast<int>(diagonals_.size()); }
+
+  // Key switches one Apply performs (hoisted baby rotations plus giant
+  // rotations).
+  int key_switches() const;
+
+ private:
+  LinearTransform(int degree, int64_t modulus,
+                  std::map<int, std::vector<int64_t>> diagonals);
+
+  int degree_;
+  int baby_steps_;
+  int64_t modulus_;
+  // Non-zero diagonals, index in [0, d).
+  std::map<int, std::vector<int64_t>> diagonals_;
+};
+
+// LinearTransform with its diagonals encoded for one backend.
+//
+// Thread Safety: Immutable; Apply is thread-safe.
+class EncodedLinearTransform {
+ public:
+  // Enc(c) → Enc(M·c).
+  //
+  // Returns:
+  //   Transformed ciphertext
+  //   FailedPrecondition if the rotation keys cannot compose a rotation
+  //   Backend errors otherwise
+  absl::StatusOr<Ciphertext> Apply(const Ciphertext& ciphertext) const;
+
+ private:
+  friend class LinearTransform;
+
+  // Σ over the diagonals g·b + a of one giant block, rotated by −g·b.
+  struct Block {
+    int giant_step;  // g·b
+    std::vector<std::pair<int, Plaintext>> terms;  // (baby index, diag')
+  };
+
+  explicit EncodedLinearTransform(const FheBackend* backend)
+      : backend_(backend) {}
+
+  const FheBackend* backend_;
+  std::vector<int> baby_positions_;  // −a for every used baby step a
+  std::vector<Block> blocks_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_LINEAR_TRANSFORM_H_
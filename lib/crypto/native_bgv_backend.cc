@@ -0,0 +1,607 @@
+// lib/crypto/native_bgv_backend.cc
+//
+// Implementation of the native depth-0 BGV backend.
+
+#include "lib/crypto/native_bgv_backend.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "lib/crypto/sampler.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_format.h"
+
+namespace f2chat {
+namespace {
+
+// HE-standard 128-bit classical presets (ternary secret): the largest
+// log Q allowed for each N, realised as limbs of 54–55-bit primes.
+struct SecurityPreset {
+  int ring_dimension;
+  int num_primes;
+  int prime_bits;
+};
+
+constexpr SecurityPreset kSecurity128Presets[] = {
+    {4096, 2, 54},    // log Q = 108 ≤ 109
+    {8192, 4, 54},    // log Q = 216 ≤ 218
+    {16384, 8, 54},   // log Q = 432 ≤ 438
+    {32768, 16, 55},  // log Q = 880 ≤ 881
+};
+
+bool IsPowerOfTwo(int64_t n) { return n > 0 && (n & (n - 1)) == 0; }
+
+int BitWidth(uint64_t value) {
+  int bits = 0;
+  while (value != 0) {
+    ++bits;
+    value >>= 1;
+  }
+  return bits;
+}
+
+}  // namespace
+
+// Key-switching key: ksk_ij = (−a_ij·s + t·e_ij + 2^(w·j)·e_i·s', a_ij),
+// evaluation form, indexed [limb · D + digit].
+struct NativeBgvBackend::KeySwitchKey {
+  std::vector<RnsPoly> b;
+  std::vector<RnsPoly> a;
+  // Evaluation-form permutation of the Galois element it serves.
+  std::vector<uint32_t> permutation;
+};
+
+// Evaluation keys travel with the public key and with every ciphertext
+// encrypted under it, so homomorphic ops need no extra key argument.
+struct NativeBgvBackend::EvaluationKeys {
+  explicit EvaluationKeys(RotationKeySet set) : plan(std::move(set)) {}
+
+  // Galois element → key switching φ_g(s) back to s.
+  absl::flat_hash_map<uint64_t, KeySwitchKey> rotations;
+  // How each rotation is composed from the keyed ones.
+  RotationPlan plan;
+};
+
+struct NativeBgvBackend::CiphertextImpl : FheCiphertext {
+  CiphertextImpl(const FheBackend* backend, RnsPoly c0, RnsPoly c1,
+                 std::shared_ptr<const EvaluationKeys> keys)
+      : FheCiphertext(backend),
+        c0(std::move(c0)),
+        c1(std::move(c1)),
+        keys(std::move(keys)) {}
+
+  RnsPoly c0;  // Evaluation form
+  RnsPoly c1;  // Evaluation form
+  std::shared_ptr<const EvaluationKeys> keys;
+};
+
+struct NativeBgvBackend::PublicKeyImpl : FhePublicKey {
+  PublicKeyImpl(const FheBackend* backend, RnsPoly b, RnsPoly a,
+                std::shared_ptr<const EvaluationKeys> keys)
+      : FhePublicKey(backend),
+        b(std::move(b)),
+        a(std::move(a)),
+        keys(std::move(keys)) {}
+
+  RnsPoly b;  // −a·s + t·e
+  RnsPoly a;  // Uniform
+  std::shared_ptr<const EvaluationKeys> keys;
+};
+
+struct NativeBgvBackend::PrivateKeyImpl : FhePrivateKey {
+  PrivateKeyImpl(const FheBackend* backend, RnsPoly s)
+      : FhePrivateKey(backend), s(std::move(s)) {}
+
+  RnsPoly s;  // Ternary secret, evaluation form
+};
+
+struct NativeBgvBackend::PlaintextImpl : FhePlaintext {
+  PlaintextImpl(const FheBackend* backend, RnsPoly m)
+      : FhePlaintext(backend),
+        m(std::move(m)),
+        m_shoup(this->m.ShoupQuotients()) {}
+
+  RnsPoly m;                      // Encode(coefficients), evaluation form
+  std::vector<uint64_t> m_shoup;  // m.ShoupQuotients()
+};
+
+absl::StatusOr<NativeBgvParams> NativeBgvParams::Security128(
+    int message_degree, int64_t plaintext_modulus) {
+  if (!IsPowerOfTwo(message_degree)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Message degree must be a power of two, got %d", message_degree));
+  }
+  for (const SecurityPreset& preset : kSecurity128Presets) {
+    // Each slot row must hold the whole message.
+    if (preset.ring_dimension / 2 < message_degree) continue;
+    if (plaintext_modulus < 2 ||
+        (plaintext_modulus - 1) % (2 * preset.ring_dimension) != 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Plaintext modulus %d must be ≡ 1 mod %d for SIMD slots",
+          plaintext_modulus, 2 * preset.ring_dimension));
+    }
+    NativeBgvParams params;
+    params.ring_dimension = preset.ring_dimension;
+    params.num_primes = preset.num_primes;
+    params.prime_bits = preset.prime_bits;
+    params.plaintext_modulus = plaintext_modulus;
+    params.message_degree = message_degree;
+    return params;
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "No 128-bit preset holds %d-coefficient messages", message_degree));
+}
+
+absl::StatusOr<std::shared_ptr<const NativeBgvBackend>>
+NativeBgvBackend::Create(const NativeBgvParams& params) {
+  const int n = params.ring_dimension;
+  if (!IsPowerOfTwo(n) || !IsPowerOfTwo(params.message_degree) ||
+      params.message_degree > n / 2) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Need power-of-two N and message degree d ≤ N/2 (N=%d, d=%d)", n,
+        params.message_degree));
+  }
+  if (params.digit_bits < 1 || params.digit_bits > params.prime_bits) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Digit size must be 1..%d bits, got %d", params.prime_bits,
+        params.digit_bits));
+  }
+  auto plaintext_ntt = NttTables::Create(params.plaintext_modulus, n);
+  if (!plaintext_ntt.ok()) return plaintext_ntt.status();
+  auto primes = GenerateNttPrimes(params.prime_bits, params.num_primes, n);
+  if (!primes.ok()) return primes.status();
+  auto basis = RnsBasis::Create(n, *std::move(primes));
+  if (!basis.ok()) return basis.status();
+
+  return std::shared_ptr<const NativeBgvBackend>(new NativeBgvBackend(
+      params, *std::move(basis), *std::move(plaintext_ntt)));
+}
+
+absl::StatusOr<std::shared_ptr<const FheBackend>>
+NativeBgvBackend::CreateDefault() {
+  auto params = NativeBgvParams::Security128();
+  if (!params.ok()) return params.status();
+  auto backend = Create(*params);
+  if (!backend.ok()) return backend.status();
+  return std::shared_ptr<const FheBackend>(*std::move(backend));
+}
+
+NativeBgvBackend::NativeBgvBackend(const NativeBgvParams& params,
+                                   std::shared_ptr<const RnsBasis> basis,
+                                   NttTables plaintext_ntt)
+    : params_(params),
+      basis_(std::move(basis)),
+      plaintext_ntt_(std::move(plaintext_ntt)) {
+  const int n = params_.ring_dimension;
+  const int row = n / 2;
+  const uint64_t t = params_.plaintext_modulus;
+
+  int max_prime_bits = 0;
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    max_prime_bits = std::max(max_prime_bits, BitWidth(basis_->prime(l)));
+  }
+  digits_per_limb_ =
+      (max_prime_bits + params_.digit_bits - 1) / params_.digit_bits;
+
+  // Slot (r, c) holds m(ψ^(±5^c)): row 0 uses +5^c, row 1 uses −5^c.
+  slot_index_.resize(n);
+  uint64_t power = 1;
+  for (int c = 0; c < row; ++c) {
+    slot_index_[c] = plaintext_ntt_.IndexOfExponent(power);
+    slot_index_[row + c] = plaintext_ntt_.IndexOfExponent(2 * n - power);
+    power = power * 5 % (2 * n);
+  }
+
+  const int limbs = basis_->num_limbs();
+  punctured_inverse_.resize(limbs);
+  punctured_mod_t_.resize(limbs);
+  q_mod_t_ = 1;
+  for (int i = 0; i < limbs; ++i) {
+    const uint64_t qi = basis_->prime(i);
+    uint64_t mod_qi = 1;
+    uint64_t mod_t = 1;
+    for (int j = 0; j < limbs; ++j) {
+      if (j == i) continue;
+      mod_qi = MulMod(mod_qi, basis_->prime(j) % qi, qi);
+      mod_t = MulMod(mod_t, basis_->prime(j) % t, t);
+    }
+    punctured_inverse_[i] = InvMod(mod_qi, qi);
+    punctured_mod_t_[i] = mod_t;
+    q_mod_t_ = MulMod(q_mod_t_, qi % t, t);
+  }
+}
+
+RnsPoly NativeBgvBackend::Encode(const std::vector<int64_t>& message) const {
+  const int n = params_.ring_dimension;
+  const int d = params_.message_degree;
+  const uint64_t t = params_.plaintext_modulus;
+
+  std::vector<uint64_t> values(n, 0);
+  for (int slot = 0; slot < n; ++slot) {
+    const int c = slot % d;  // Period-d replication across both rows
+    if (c < static_cast<int>(message.size())) {
+      values[slot_index_[slot]] = ReduceSigned(message[c], t);
+    }
+  }
+  plaintext_ntt_.Inverse(values.data());
+
+  // Centered lift keeps the plaintext (and the noise it multiplies) small.
+  std::vector<int64_t> centered(n);
+  for (int j = 0; j < n; ++j) {
+    centered[j] = values[j] > t / 2 ? static_cast<int64_t>(values[j]) -
+                                          static_cast<int64_t>(t)
+                                    : static_cast<int64_t>(values[j]);
+  }
+  return RnsPoly::FromSigned(basis_.get(), centered);
+}
+
+std::vector<int64_t> NativeBgvBackend::Decode(const RnsPoly& phase) const {
+  const int n = params_.ring_dimension;
+  const int limbs = basis_->num_limbs();
+  const uint64_t t = params_.plaintext_modulus;
+
+  // [x]_Q mod t via CRT: x = Σ y_i·(Q/q_i) − v·Q, y_i = x_i·(Q/q_i)^-1,
+  // v = round(Σ y_i / q_i). The noise is far below Q/2, so the fractional
+  // part is tiny and v is unambiguous in double precision.
+  std::vector<uint64_t> values(n);
+  for (int j = 0; j < n; ++j) {
+    double v = 0;
+    uint64_t sum = 0;
+    for (int i = 0; i < limbs; ++i) {
+      const uint64_t qi = basis_->prime(i);
+      const uint64_t y =
+          basis_->reducer(i).Multiply(phase.limb(i)[j], punctured_inverse_[i]);
+      v += static_cast<double>(y) / static_cast<double>(qi);
+      sum = AddMod(sum, MulMod(y % t, punctured_mod_t_[i], t), t);
+    }
+    const uint64_t rounded = static_cast<uint64_t>(std::llround(v));
+    values[j] = SubMod(sum, MulMod(rounded % t, q_mod_t_, t), t);
+  }
+  plaintext_ntt_.Forward(values.data());
+
+  std::vector<int64_t> message(params_.message_degree);
+  for (int c = 0; c < params_.message_degree; ++c) {
+    message[c] = static_cast<int64_t>(values[slot_index_[c]]);
+  }
+  return message;
+}
+
+std::vector<RnsPoly> NativeBgvBackend::Decompose(const RnsPoly& poly) const {
+  RnsPoly coefficients = poly;
+  coefficients.ToCoefficient();
+
+  const int n = params_.ring_dimension;
+  const int limbs = basis_->num_limbs();
+  const int w = params_.digit_bits;
+  const uint64_t mask = (uint64_t{1} << w) - 1;
+
+  std::vector<RnsPoly> digits;
+  digits.reserve(limbs * digits_per_limb_);
+  for (int i = 0; i < limbs; ++i) {
+    const uint64_t* source = coefficients.limb(i);
+    for (int j = 0; j < digits_per_limb_; ++j) {
+      // Digits are < 2^w < every prime, so they embed unchanged in each limb.
+      RnsPoly digit(basis_.get(), RnsPoly::Form::kCoefficient);
+      for (int k = 0; k < n; ++k) {
+        const uint64_t value = (source[k] >> (w * j)) & mask;
+        for (int l = 0; l < limbs; ++l) digit.limb(l)[k] = value;
+      }
+      digit.ToEvaluation();
+      digits.push_back(std::move(digit));
+    }
+  }
+  return digits;
+}
+
+RnsPoly NativeBgvBackend::SampleScaledError(Prng& prng) const {
+  RnsPoly error = RnsPoly::FromSigned(
+      basis_.get(), SampleCenteredBinomial(prng, params_.ring_dimension));
+  error.MultiplyScalarInPlace(params_.plaintext_modulus);
+  error.ToEvaluation();
+  return error;
+}
+
+NativeBgvBackend::KeySwitchKey NativeBgvBackend::MakeKeySwitchKey(
+    Prng& prng, const RnsPoly& from, const RnsPoly& to) const {
+  const int n = params_.ring_dimension;
+  const int limbs = basis_->num_limbs();
+  KeySwitchKey key;
+  key.b.reserve(limbs * digits_per_limb_);
+  key.a.reserve(limbs * digits_per_limb_);
+  for (int i = 0; i < limbs; ++i) {
+    const uint64_t qi = basis_->prime(i);
+    for (int j = 0; j < digits_per_limb_; ++j) {
+      RnsPoly a(basis_.get(), RnsPoly::Form::kEvaluation);
+      SampleUniform(prng, a);
+      RnsPoly b = SampleScaledError(prng);
+      RnsPoly as = a;
+      as.MultiplyInPlace(to);
+      b.SubtractInPlace(as);
+      // Gadget term 2^(w·j)·e_i·s': only limb i is non-zero.
+      const uint64_t scale = (uint64_t{1} << (params_.digit_bits * j)) % qi;
+      const uint64_t scale_shoup = ShoupPrecompute(scale, qi);
+      uint64_t* out = b.limb(i);
+      const uint64_t* secret = from.limb(i);
+      for (int k = 0; k < n; ++k) {
+        out[k] = AddMod(out[k], MulModShoup(secret[k], scale, scale_shoup, qi),
+                        qi);
+      }
+      key.b.push_back(std::move(b));
+      key.a.push_back(std::move(a));
+    }
+  }
+  return key;
+}
+
+uint64_t NativeBgvBackend::GaloisElement(int steps) const {
+  // 5 generates the row rotations of Z_2N^*.
+  const uint64_t two_n = 2 * static_cast<uint64_t>(params_.ring_dimension);
+  return PowMod(5, static_cast<uint64_t>(steps), two_n);
+}
+
+Ciphertext NativeBgvBackend::MakeCiphertext(
+    RnsPoly c0, RnsPoly c1,
+    std::shared_ptr<const EvaluationKeys> keys) const {
+  return std::make_shared<CiphertextImpl>(this, std::move(c0), std::move(c1),
+                                          std::move(keys));
+}
+
+absl::StatusOr<FHEKeyPair> NativeBgvBackend::GenerateKeyPair() const {
+  return GenerateKeyPair(RotationKeySet::Default(params_.message_degree));
+}
+
+absl::StatusOr<FHEKeyPair> NativeBgvBackend::GenerateKeyPair(
+    const RotationKeySet& rotations) const {
+  const int d = params_.message_degree;
+  if (rotations.degree() != d) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Rotation key set is for degree %d, backend message degree is %d",
+        rotations.degree(), d));
+  }
+  Prng prng = Prng::FromEntropy();
+  const int n = params_.ring_dimension;
+
+  RnsPoly s = RnsPoly::FromSigned(basis_.get(), SampleTernary(prng, n));
+  s.ToEvaluation();
+
+  RnsPoly a(basis_.get(), RnsPoly::Form::kEvaluation);
+  SampleUniform(prng, a);
+  RnsPoly b = SampleScaledError(prng);
+  RnsPoly as = a;
+  as.MultiplyInPlace(s);
+  b.SubtractInPlace(as);
+
+  auto keys = std::make_shared<EvaluationKeys>(rotations);
+  for (int positions : rotations.rotations()) {
+    const uint64_t galois = GaloisElement(d - positions);
+    std::vector<uint32_t> permutation = basis_->GaloisPermutation(galois);
+    KeySwitchKey key = MakeKeySwitchKey(prng, s.Permute(permutation), s);
+    key.permutation = std::move(permutation);
+    keys->rotations.emplace(galois, std::move(key));
+  }
+
+  FHEKeyPair pair;
+  pair.public_key = std::make_shared<PublicKeyImpl>(
+      this, std::move(b), std::move(a), std::move(keys));
+  pair.private_key = std::make_shared<PrivateKeyImpl>(this, std::move(s));
+  return pair;
+}
+
+absl::StatusOr<KeyMemoryReport> NativeBgvBackend::KeyMemory(
+    const PublicKey& public_key) const {
+  auto pk = Unwrap<PublicKeyImpl>(public_key, "public key");
+  if (!pk.ok()) return pk.status();
+  KeyMemoryReport report;
+  report.public_key_bytes = (*pk)->b.ByteSize() + (*pk)->a.ByteSize();
+  const EvaluationKeys& keys = *(*pk)->keys;
+  report.num_rotation_keys = static_cast<int>(keys.rotations.size());
+  report.max_key_switches = keys.plan.max_key_switches();
+  for (const auto& [galois, key] : keys.rotations) {
+    for (size_t i = 0; i < key.b.size(); ++i) {
+      report.rotation_key_bytes += key.b[i].ByteSize() + key.a[i].ByteSize();
+    }
+    report.rotation_key_bytes += key.permutation.size() * sizeof(uint32_t);
+  }
+  return report;
+}
+
+absl::StatusOr<Ciphertext> NativeBgvBackend::Encrypt(
+    const std::vector<int64_t>& coefficients,
+    const PublicKey& public_key) const {
+  auto pk = Unwrap<PublicKeyImpl>(public_key, "public key");
+  if (!pk.ok()) return pk.status();
+  if (coefficients.size() > static_cast<size_t>(params_.message_degree)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Too many coefficients: %d (max: %d)", coefficients.size(),
+        params_.message_degree));
+  }
+
+  Prng prng = Prng::FromEntropy();
+  RnsPoly u = RnsPoly::FromSigned(
+      basis_.get(), SampleTernary(prng, params_.ring_dimension));
+  u.ToEvaluation();
+
+  // (c0, c1) = (b·u + t·e1 + m, a·u + t·e2)
+  RnsPoly c0 = SampleScaledError(prng);
+  c0.MultiplyAccumulate((*pk)->b, u);
+  RnsPoly m = Encode(coefficients);
+  m.ToEvaluation();
+  c0.AddInPlace(m);
+
+  RnsPoly c1 = SampleScaledError(prng);
+  c1.MultiplyAccumulate((*pk)->a, u);
+  return MakeCiphertext(std::move(c0), std::move(c1), (*pk)->keys);
+}
+
+absl::StatusOr<std::vector<int64_t>> NativeBgvBackend::Decrypt(
+    const Ciphertext& ciphertext, const PrivateKey& private_key) const {
+  auto ct = Unwrap<CiphertextImpl>(ciphertext, "ciphertext");
+  if (!ct.ok()) return ct.status();
+  auto sk = Unwrap<PrivateKeyImpl>(private_key, "private key");
+  if (!sk.ok()) return sk.status();
+
+  RnsPoly phase = (*ct)->c0;
+  phase.MultiplyAccumulate((*ct)->c1, (*sk)->s);
+  phase.ToCoefficient();
+  return Decode(phase);
+}
+
+absl::StatusOr<Ciphertext> NativeBgvBackend::Add(
+    const Ciphertext& ct1, const Ciphertext& ct2) const {
+  auto a = Unwrap<CiphertextImpl>(ct1, "ciphertext");
+  if (!a.ok()) return a.status();
+  auto b = Unwrap<CiphertextImpl>(ct2, "ciphertext");
+  if (!b.ok()) return b.status();
+  if ((*a)->keys != (*b)->keys) {
+    return absl::InvalidArgumentError(
+        "Ciphertexts were encrypted under different keys");
+  }
+  RnsPoly c0 = (*a)->c0;
+  RnsPoly c1 = (*a)->c1;
+  c0.AddInPlace((*b)->c0);
+  c1.AddInPlace((*b)->c1);
+  return MakeCiphertext(std::move(c0), std::move(c1), (*a)->keys);
+}
+
+absl::StatusOr<Ciphertext> NativeBgvBackend::Subtract(
+    const Ciphertext& ct1, const Ciphertext& ct2) const {
+  auto a = Unwrap<CiphertextImpl>(ct1, "ciphertext");
+  if (!a.ok()) return a.status();
+  auto b = Unwrap<CiphertextImpl>(ct2, "ciphertext");
+  if (!b.ok()) return b.status();
+  if ((*a)->keys != (*b)->keys) {
+    return absl::InvalidArgumentError(
+        "Ciphertexts were encrypted under different keys");
+  }
+  RnsPoly c0 = (*a)->c0;
+  RnsPoly c1 = (*a)->c1;
+  c0.SubtractInPlace((*b)->c0);
+  c1.SubtractInPlace((*b)->c1);
+  return MakeCiphertext(std::move(c0), std::move(c1), (*a)->keys);
+}
+
+absl::StatusOr<Ciphertext> NativeBgvBackend::MultiplyScalar(
+    const Ciphertext& ciphertext, int64_t scalar) const {
+  auto ct = Unwrap<CiphertextImpl>(ciphertext, "ciphertext");
+  if (!ct.ok()) return ct.status();
+  // Noise grows by |scalar mod t|, so use the centered representative.
+  const int64_t t = params_.plaintext_modulus;
+  int64_t centered = static_cast<int64_t>(ReduceSigned(scalar, t));
+  if (centered > t / 2) centered -= t;
+
+  RnsPoly c0 = (*ct)->c0;
+  RnsPoly c1 = (*ct)->c1;
+  c0.MultiplyScalarInPlace(centered);
+  c1.MultiplyScalarInPlace(centered);
+  return MakeCiphertext(std::move(c0), std::move(c1), (*ct)->keys);
+}
+
+absl::StatusOr<Plaintext> NativeBgvBackend::EncodePlaintext(
+    const std::vector<int64_t>& coefficients) const {
+  if (coefficients.size() > static_cast<size_t>(params_.message_degree)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Too many coefficients: %d (max: %d)", coefficients.size(),
+        params_.message_degree));
+  }
+  RnsPoly m = Encode(coefficients);
+  m.ToEvaluation();
+  return std::make_shared<PlaintextImpl>(this, std::move(m));
+}
+
+absl::StatusOr<Ciphertext> NativeBgvBackend::MultiplyPlain(
+    const Ciphertext& ciphertext, const Plaintext& plaintext) const {
+  auto ct = Unwrap<CiphertextImpl>(ciphertext, "ciphertext");
+  if (!ct.ok()) return ct.status();
+  auto pt = Unwrap<PlaintextImpl>(plaintext, "plaintext");
+  if (!pt.ok()) return pt.status();
+  // Slot-wise product: (c0·m, c1·m) decrypts to m·(c0 + c1·s).
+  RnsPoly c0 = (*ct)->c0;
+  RnsPoly c1 = (*ct)->c1;
+  c0.MultiplyInPlace((*pt)->m, (*pt)->m_shoup);
+  c1.MultiplyInPlace((*pt)->m, (*pt)->m_shoup);
+  return MakeCiphertext(std::move(c0), std::move(c1), (*ct)->keys);
+}
+
+absl::StatusOr<Ciphertext> NativeBgvBackend::Rotate(
+    const Ciphertext& ciphertext, int positions) const {
+  auto rotated = RotateHoisted(ciphertext, {positions});
+  if (!rotated.ok()) return rotated.status();
+  return std::move(rotated->front());
+}
+
+absl::StatusOr<std::vector<Ciphertext>> NativeBgvBackend::RotateHoisted(
+    const Ciphertext& ciphertext, const std::vector<int>& positions) const {
+  auto ct = Unwrap<CiphertextImpl>(ciphertext, "ciphertext");
+  if (!ct.ok()) return ct.status();
+  const EvaluationKeys& keys = *(*ct)->keys;
+
+  // Digits of c1, shared by the first key switch of every rotation.
+  std::vector<RnsPoly> digits;
+  std::vector<Ciphertext> rotated;
+  rotated.reserve(positions.size());
+  for (int p : positions) {
+    auto steps = keys.plan.Decompose(p);
+    if (!steps.ok()) return steps.status();
+    if (steps->empty()) {
+      rotated.push_back(ciphertext);
+      continue;
+    }
+    if (digits.empty()) digits = Decompose((*ct)->c1);
+
+    RnsPoly c0 = (*ct)->c0;
+    RnsPoly c1;
+    for (size_t i = 0; i < steps->size(); ++i) {
+      auto key = RotationKey(keys, (*steps)[i]);
+      if (!key.ok()) return key.status();
+      if (i == 0) {
+        KeySwitch(**key, digits, c0, c1);
+      } else {
+        KeySwitch(**key, c0, c1);
+      }
+    }
+    rotated.push_back(
+        MakeCiphertext(std::move(c0), std::move(c1), (*ct)->keys));
+  }
+  return rotated;
+}
+
+absl::StatusOr<const NativeBgvBackend::KeySwitchKey*>
+NativeBgvBackend::RotationKey(const EvaluationKeys& keys, int step) const {
+  // Right rotation by k is a left rotation of every slot row by d − k.
+  auto it = keys.rotations.find(GaloisElement(params_.message_degree - step));
+  if (it == keys.rotations.end()) {
+    return absl::InternalError(
+        absl::StrFormat("Rotation plan uses missing key %d", step));
+  }
+  return &it->second;
+}
+
+void NativeBgvBackend::KeySwitch(const KeySwitchKey& key, RnsPoly& c0,
+                                 RnsPoly& c1) const {
+  KeySwitch(key, Decompose(c1), c0, c1);
+}
+
+void NativeBgvBackend::KeySwitch(const KeySwitchKey& key,
+                                 const std::vector<RnsPoly>& digits,
+                                 RnsPoly& c0, RnsPoly& c1) const {
+  // φ(c0) + φ(c1)·φ(s): key-switch φ(c1) from φ(s) back to s. The digits
+  // of c1 are permuted rather than recomputed from φ(c1): Σ φ(d_ij)·g_ij =
+  // φ(c1) and φ keeps digits small. This is what makes hoisting work: the
+  // digits do not depend on the rotation.
+  c0 = c0.Permute(key.permutation);
+  c1 = RnsPoly(basis_.get(), RnsPoly::Form::kEvaluation);
+  for (size_t i = 0; i < digits.size(); ++i) {
+    RnsPoly digit = digits[i].Permute(key.permutation);
+    c0.MultiplyAccumulate(digit, key.b[i]);
+    c1.MultiplyAccumulate(digit, key.a[i]);
+  }
+}
+
+namespace {
+
+FheBackendRegistrar native_registrar(kNativeFheBackendName,
+                                     &NativeBgvBackend::CreateDefault);
+
+}  // namespace
+
+}  // namespace f2chat
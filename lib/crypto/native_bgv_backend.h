@@ -0,0 +1,213 @@
+// lib/crypto/native_bgv_backend.h
+//
+// In-tree RLWE backend: depth-0 BGV over R_Q = Z_Q[X]/(X^N + 1).
+//
+// Self-contained implementation of the operation set FHEContext exposes
+// (encrypt, decrypt, add, subtract, scalar multiply, rotate), built on the
+// library's own NTT (ntt.h), RNS arithmetic (rns.h) and sampler
+// (sampler.h). No external dependency, no network, setup in milliseconds.
+//
+// Encoding:
+// - Plaintext modulus t = RingParams::kModulus = 65537 ≡ 1 (mod 2N), so
+//   R_t splits into N SIMD slots, arranged as 2 rows of N/2
+// - A message of d = RingParams::kDegree coefficients is replicated with
+//   period d across both rows; the Galois automorphism X → X^(5^s) rotates
+//   every row by s, which is exactly Polynomial::Rotate on the message
+// - Rotation is therefore one automorphism plus one key switch
+//
+// Security:
+// - Ternary secret, CBD(21) errors, N and log Q from the HE-standard
+//   128-bit classical table (N=4096: log Q ≤ 109, N=8192: ≤ 218, ...)
+// - Key switching: RNS digit decomposition (base 2^digit_bits per limb)
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_NATIVE_BGV_BACKEND_H_
+#define F2CHAT_LIB_CRYPTO_NATIVE_BGV_BACKEND_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "lib/crypto/fhe_backend.h"
+#include "lib/crypto/ntt.h"
+#include "lib/crypto/polynomial_params.h"
+#include "lib/crypto/rns.h"
+#include "lib/crypto/rotation_keys.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace f2chat {
+
+class Prng;
+
+// Registry name of the native backend.
+inline constexpr char kNativeFheBackendName[] = "native";
+
+// Scheme parameters of the native backend.
+struct NativeBgvParams {
+  int ring_dimension = 4096;   // N
+  int num_primes = 2;          // RNS limbs of Q
+  int prime_bits = 54;         // Size of each limb prime
+  int digit_bits = 18;         // Key-switching gadget base 2^digit_bits
+  int64_t plaintext_modulus = RingParams::kModulus;  // t
+  int message_degree = RingParams::kDegree;          // d (≤ N/2)
+
+  // Smallest 128-bit preset whose slot rows hold `message_degree`
+  // coefficients.
+  //
+  // Returns:
+  //   Preset (N ≥ 4096, log Q at the HE-standard bound for N)
+  //   InvalidArgument if d is not a power of two, is too large, or t does
+  //   not split completely in R_t
+  static absl::StatusOr<NativeBgvParams> Security128(
+      int message_degree = RingParams::kDegree,
+      int64_t plaintext_modulus = RingParams::kModulus);
+
+  int log_q() const { return num_primes * prime_bits; }
+};
+
+// Native depth-0 BGV backend.
+//
+// Thread Safety: Immutable after Create(); all operations are const and
+// draw fresh randomness per call.
+//
+// Performance (N = 4096, two 54-bit limbs):
+// - Encrypt: 8 NTTs; Decrypt: 2 NTTs + CRT + 1 plaintext NTT
+// - Add/Subtract/MultiplyScalar/MultiplyPlain: O(L·N)
+// - Rotate: 1 automorphism + 1 key switch (L·D digit NTTs, D = 3) per
+//   keyed rotation it is composed of (≤ log2 d with the default keys)
+// - RotateHoisted: the digit NTTs once for all rotations of a ciphertext
+class NativeBgvBackend final : public FheBackend {
+ public:
+  static absl::StatusOr<std::shared_ptr<const NativeBgvBackend>> Create(
+      const NativeBgvParams& params);
+
+  // Security128() preset for the compiled-in RingParams (the registered
+  // factory).
+  static absl::StatusOr<std::shared_ptr<const FheBackend>> CreateDefault();
+
+  absl::string_view name() const override { return kNativeFheBackendName; }
+  int ring_dimension() const override { return params_.ring_dimension; }
+  int64_t plaintext_modulus() const override {
+    return params_.plaintext_modulus;
+  }
+  int message_degree() const override { return params_.message_degree; }
+
+  // Generates secret/public keys plus RotationKeySet::Default(d) rotation
+  // keys.
+  absl::StatusOr<FHEKeyPair> GenerateKeyPair() const override;
+
+  // Performance: one key-switching key (2·L·D polynomials) per rotation.
+  absl::StatusOr<FHEKeyPair> GenerateKeyPair(
+      const RotationKeySet& rotations) const override;
+
+  absl::StatusOr<KeyMemoryReport> KeyMemory(
+      const PublicKey& public_key) const override;
+
+  absl::StatusOr<Ciphertext> Encrypt(
+      const std::vector<int64_t>& coefficients,
+      const PublicKey& public_key) const override;
+
+  absl::StatusOr<std::vector<int64_t>> Decrypt(
+      const Ciphertext& ciphertext,
+      const PrivateKey& private_key) const override;
+
+  absl::StatusOr<Ciphertext> Add(const Ciphertext& ct1,
+                                 const Ciphertext& ct2) const override;
+
+  absl::StatusOr<Ciphertext> Subtract(const Ciphertext& ct1,
+                                      const Ciphertext& ct2) const override;
+
+  absl::StatusOr<Ciphertext> MultiplyScalar(const Ciphertext& ciphertext,
+                                            int64_t scalar) const override;
+
+  // Performance: one plaintext NTT, one CRT embedding and L NTTs, plus
+  // the Shoup quotients MultiplyPlain multiplies with.
+  absl::StatusOr<Plaintext> EncodePlaintext(
+      const std::vector<int64_t>& coefficients) const override;
+
+  // Performance: 2·L pointwise Shoup products of length N.
+  absl::StatusOr<Ciphertext> MultiplyPlain(
+      const Ciphertext& ciphertext,
+      const Plaintext& plaintext) const override;
+
+  absl::StatusOr<Ciphertext> Rotate(const Ciphertext& ciphertext,
+                                    int positions) const override;
+
+  // Performance: one decomposition (L·D digit NTTs) in total, then per
+  // keyed rotation only the automorphism and 2·L·D pointwise products.
+  absl::StatusOr<std::vector<Ciphertext>> RotateHoisted(
+      const Ciphertext& ciphertext,
+      const std::vector<int>& positions) const override;
+
+  const NativeBgvParams& params() const { return params_; }
+  const RnsBasis& basis() const { return *basis_; }
+
+  // SIMD slots per row (N/2); the message occupies `message_degree` of them,
+  // replicated.
+  int slots_per_row() const { return params_.ring_dimension / 2; }
+
+ private:
+  struct KeySwitchKey;
+  struct EvaluationKeys;
+  struct CiphertextImpl;
+  struct PublicKeyImpl;
+  struct PrivateKeyImpl;
+  struct PlaintextImpl;
+
+  NativeBgvBackend(const NativeBgvParams& params,
+                   std::shared_ptr<const RnsBasis> basis,
+                   NttTables plaintext_ntt);
+
+  // Message (≤ d values mod t) → plaintext polynomial with centered
+  // coefficients, embedded in R_Q (coefficient form).
+  RnsPoly Encode(const std::vector<int64_t>& message) const;
+
+  // c0 + c1·s (coefficient form) → message of d values in [0, t).
+  std::vector<int64_t> Decode(const RnsPoly& phase) const;
+
+  // Gadget decomposition of `poly` into L·D small digit polynomials
+  // (evaluation form) with Σ digit_ij · 2^(w·j)·e_i = poly.
+  std::vector<RnsPoly> Decompose(const RnsPoly& poly) const;
+
+  // Key-switching key from secret `from` to secret `to` (evaluation form).
+  KeySwitchKey MakeKeySwitchKey(Prng& prng, const RnsPoly& from,
+                                const RnsPoly& to) const;
+
+  // Key for one keyed rotation step of a RotationPlan.
+  absl::StatusOr<const KeySwitchKey*> RotationKey(const EvaluationKeys& keys,
+                                                  int step) const;
+
+  // Applies one keyed rotation to (c0, c1) in place.
+  void KeySwitch(const KeySwitchKey& key, RnsPoly& c0, RnsPoly& c1) const;
+
+  // Same, with `digits` = Decompose(c1) computed by the caller, so that
+  // rotations of one ciphertext can share them. c1 is only written.
+  void KeySwitch(const KeySwitchKey& key, const std::vector<RnsPoly>& digits,
+                 RnsPoly& c0, RnsPoly& c1) const;
+
+  // Galois element rotating every slot row left by `steps`.
+  uint64_t GaloisElement(int steps) const;
+
+  // Fresh t·e in evaluation form.
+  RnsPoly SampleScaledError(Prng& prng) const;
+
+  Ciphertext MakeCiphertext(RnsPoly c0, RnsPoly c1,
+                            std::shared_ptr<const EvaluationKeys> keys) const;
+
+  NativeBgvParams params_;
+  std::shared_ptr<const RnsBasis> basis_;
+  NttTables plaintext_ntt_;
+  int digits_per_limb_;
+  // slot_index_[row · N/2 + column] → plaintext NTT index.
+  std::vector<int> slot_index_;
+  // CRT reconstruction mod t: (Q/q_i)^-1 mod q_i, (Q/q_i) mod t, Q mod t.
+  std::vector<uint64_t> punctured_inverse_;
+  std::vector<uint64_t> punctured_mod_t_;
+  uint64_t q_mod_t_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_NATIVE_BGV_BACKEND_H_
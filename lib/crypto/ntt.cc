@@ -0,0 +1,227 @@
+// lib/crypto/ntt.cc
+//
+// Implementation of modular arithmetic helpers and negacyclic NTT.
+
+#include "lib/crypto/ntt.h"
+
+#include <algorithm>
+#include "absl/strings/str_format.h"
+
+namespace f2chat {
+namespace {
+
+uint32_t BitReverse(uint32_t value, int bits) {
+  uint32_t result = 0;
+  for (int i = 0; i < bits; ++i) {
+    result = (result << 1) | ((value >> i) & 1);
+  }
+  return result;
+}
+
+bool IsPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+}  // namespace
+
+BarrettReducer::BarrettReducer(uint64_t q) : modulus_(q), bits_(0) {
+  while (bits_ < 64 && (q >> bits_) != 0) ++bits_;
+  ratio_ = static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(1) << (2 * bits_)) / q);
+}
+
+uint64_t PowMod(uint64_t base, uint64_t exponent, uint64_t q) {
+  uint64_t result = 1 % q;
+  base %= q;
+  while (exponent > 0) {
+    if (exponent & 1) result = MulMod(result, base, q);
+    base = MulMod(base, base, q);
+    exponent >>= 1;
+  }
+  return result;
+}
+
+uint64_t InvMod(uint64_t a, uint64_t q) {
+  // Fermat: a^(q-2) for prime q.
+  return PowMod(a, q - 2, q);
+}
+
+bool IsPrime(uint64_t n) {
+  if (n < 2) return false;
+  static constexpr uint64_t kBases[] = {2, 3, 5, 7, 11, 13,
+                                        17, 19, 23, 29, 31, 37};
+  for (uint64_t p : kBases) {
+    if (n % p == 0) return n == p;
+  }
+  uint64_t d = n - 1;
+  int r = 0;
+  while ((d & 1) == 0) {
+    d >>= 1;
+    ++r;
+  }
+  // These bases are a deterministic witness set below 3.3 · 10^24.
+  for (uint64_t a : kBases) {
+    uint64_t x = PowMod(a, d, n);
+    if (x == 1 || x == n - 1) continue;
+    bool composite = true;
+    for (int i = 1; i < r; ++i) {
+      x = MulMod(x, x, n);
+      if (x == n - 1) {
+        composite = false;
+        break;
+      }
+    }
+    if (composite) return false;
+  }
+  return true;
+}
+
+absl::StatusOr<std::vector<uint64_t>> GenerateNttPrimes(int bits, int count,
+                                                        int ring_dimension) {
+  if (bits < 20 || bits > 62) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("NTT prime size must be 20..62 bits, got %d", bits));
+  }
+  if (!IsPowerOfTwo(ring_dimension)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Ring dimension must be a power of two, got %d", ring_dimension));
+  }
+  const uint64_t step = 2 * static_cast<uint64_t>(ring_dimension);
+  const uint64_t upper = uint64_t{1} << bits;
+  const uint64_t lower = uint64_t{1} << (bits - 1);
+
+  std::vector<uint64_t> primes;
+  for (uint64_t candidate = (upper - 1) / step * step + 1;
+       candidate > lower && static_cast<int>(primes.size()) < count;
+       candidate -= step) {
+    if (IsPrime(candidate)) primes.push_back(candidate);
+  }
+  if (static_cast<int>(primes.size()) < count) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Only %d primes of %d bits are ≡ 1 mod %d (wanted %d)",
+        primes.size(), bits, step, count));
+  }
+  return primes;
+}
+
+absl::StatusOr<NttTables> NttTables::Create(uint64_t modulus,
+                                            int ring_dimension) {
+  if (!IsPowerOfTwo(ring_dimension) || ring_dimension < 2) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Ring dimension must be a power of two ≥ 2, got %d", ring_dimension));
+  }
+  const uint64_t two_n = 2 * static_cast<uint64_t>(ring_dimension);
+  if (modulus >= (uint64_t{1} << 62) || !IsPrime(modulus) ||
+      (modulus - 1) % two_n != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Modulus %d is not a prime ≡ 1 mod %d below 2^62", modulus, two_n));
+  }
+
+  NttTables tables;
+  tables.modulus_ = modulus;
+  tables.n_ = ring_dimension;
+  while ((1 << tables.log_n_) < ring_dimension) ++tables.log_n_;
+
+  // Primitive 2n-th root: g^((q-1)/2n) with g^n = -1. Take the smallest
+  // odd power so the tables (and slot layouts built on them) are canonical.
+  uint64_t generator = 0;
+  for (uint64_t x = 2; x < modulus; ++x) {
+    uint64_t candidate = PowMod(x, (modulus - 1) / two_n, modulus);
+    if (PowMod(candidate, ring_dimension, modulus) == modulus - 1) {
+      generator = candidate;
+      break;
+    }
+  }
+  if (generator == 0) {
+    return absl::InternalError("No primitive 2n-th root of unity found");
+  }
+  const uint64_t generator_sq = MulMod(generator, generator, modulus);
+  uint64_t psi = generator;
+  for (uint64_t power = generator, k = 0; k < static_cast<uint64_t>(
+                                               ring_dimension);
+       ++k, power = MulMod(power, generator_sq, modulus)) {
+    psi = std::min(psi, power);
+  }
+  tables.psi_ = psi;
+
+  const int n = ring_dimension;
+  const uint64_t psi_inv = InvMod(psi, modulus);
+  tables.roots_.resize(n);
+  tables.roots_shoup_.resize(n);
+  tables.inv_roots_.resize(n);
+  tables.inv_roots_shoup_.resize(n);
+  uint64_t power = 1;
+  uint64_t inv_power = 1;
+  for (int k = 0; k < n; ++k) {
+    const uint32_t slot = BitReverse(k, tables.log_n_);
+    tables.roots_[slot] = power;
+    tables.inv_roots_[slot] = inv_power;
+    power = MulMod(power, psi, modulus);
+    inv_power = MulMod(inv_power, psi_inv, modulus);
+  }
+  for (int k = 0; k < n; ++k) {
+    tables.roots_shoup_[k] = ShoupPrecompute(tables.roots_[k], modulus);
+    tables.inv_roots_shoup_[k] =
+        ShoupPrecompute(tables.inv_roots_[k], modulus);
+  }
+  tables.inv_n_ = InvMod(n, modulus);
+  tables.inv_n_shoup_ = ShoupPrecompute(tables.inv_n_, modulus);
+  return tables;
+}
+
+void NttTables::Forward(uint64_t* values) const {
+  // Cooley–Tukey, ψ-twist merged into the twiddles.
+  const uint64_t q = modulus_;
+  int t = n_;
+  for (int m = 1; m < n_; m <<= 1) {
+    t >>= 1;
+    for (int i = 0; i < m; ++i) {
+      const uint64_t w = roots_[m + i];
+      const uint64_t w_shoup = roots_shoup_[m + i];
+      uint64_t* x = values + 2 * i * t;
+      uint64_t* y = x + t;
+      for (int j = 0; j < t; ++j) {
+        const uint64_t u = x[j];
+        const uint64_t v = MulModShoup(y[j], w, w_shoup, q);
+        x[j] = AddMod(u, v, q);
+        y[j] = SubMod(u, v, q);
+      }
+    }
+  }
+}
+
+void NttTables::Inverse(uint64_t* values) const {
+  // Gentleman–Sande, mirror image of Forward.
+  const uint64_t q = modulus_;
+  int t = 1;
+  for (int m = n_; m > 1; m >>= 1) {
+    const int h = m >> 1;
+    for (int i = 0; i < h; ++i) {
+      const uint64_t w = inv_roots_[h + i];
+      const uint64_t w_shoup = inv_roots_shoup_[h + i];
+      uint64_t* x = values + 2 * i * t;
+      uint64_t* y = x + t;
+      for (int j = 0; j < t; ++j) {
+        const uint64_t u = x[j];
+        const uint64_t v = y[j];
+        x[j] = AddMod(u, v, q);
+        y[j] = MulModShoup(SubMod(u, v, q), w, w_shoup, q);
+      }
+    }
+    t <<= 1;
+  }
+  for (int j = 0; j < n_; ++j) {
+    values[j] = MulModShoup(values[j], inv_n_, inv_n_shoup_, q);
+  }
+}
+
+int NttTables::EvaluationExponent(int index) const {
+  return 2 * static_cast<int>(BitReverse(index, log_n_)) + 1;
+}
+
+int NttTables::IndexOfExponent(int64_t exponent) const {
+  const int64_t two_n = 2 * static_cast<int64_t>(n_);
+  int64_t e = ((exponent % two_n) + two_n) % two_n;
+  return static_cast<int>(BitReverse(static_cast<uint32_t>((e - 1) / 2),
+                                     log_n_));
+}
+
+}  // namespace f2chat
@@ -0,0 +1,167 @@
+// lib/crypto/ntt.h
+//
+// Word-size modular arithmetic and negacyclic number-theoretic transforms.
+//
+// Building blocks for the native RLWE backend: every RNS limb of a
+// ciphertext polynomial lives modulo an NTT-friendly prime q ≡ 1 (mod 2n),
+// so multiplication in Z_q[X]/(X^n + 1) is a pointwise product of NTTs.
+//
+// Key Properties:
+// - Moduli up to 62 bits (products via unsigned __int128)
+// - Twiddle factors precomputed with Shoup quotients (no division in loops)
+// - Forward transform: natural-order coefficients → bit-reversed evaluations
+//   a(ψ^e) at odd exponents e; Inverse undoes it exactly
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_NTT_H_
+#define F2CHAT_LIB_CRYPTO_NTT_H_
+
+#include <cstdint>
+#include <vector>
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+
+// Modular helpers. Operands must already be reduced into [0, q).
+
+inline uint64_t AddMod(uint64_t a, uint64_t b, uint64_t q) {
+  uint64_t sum = a + b;
+  return sum >= q ? sum - q : sum;
+}
+
+inline uint64_t SubMod(uint64_t a, uint64_t b, uint64_t q) {
+  return a >= b ? a - b : a + q - b;
+}
+
+inline uint64_t MulMod(uint64_t a, uint64_t b, uint64_t q) {
+  return static_cast<uint64_t>(static_cast<unsigned __int128>(a) * b % q);
+}
+
+// Shoup quotient floor(w · 2^64 / q) for repeated multiplication by w.
+inline uint64_t ShoupPrecompute(uint64_t w, uint64_t q) {
+  return static_cast<uint64_t>((static_cast<unsigned __int128>(w) << 64) / q);
+}
+
+// a · w mod q using the precomputed Shoup quotient of w (q < 2^63).
+inline uint64_t MulModShoup(uint64_t a, uint64_t w, uint64_t w_shoup,
+                            uint64_t q) {
+  uint64_t hi = static_cast<uint64_t>(
+      (static_cast<unsigned __int128>(a) * w_shoup) >> 64);
+  uint64_t r = a * w - hi * q;
+  return r >= q ? r - q : r;
+}
+
+// Barrett constants for repeated multiplication modulo a fixed q < 2^62.
+//
+// Performance: two 64×64→128 multiplies instead of a 128-bit division.
+class BarrettReducer {
+ public:
+  explicit BarrettReducer(uint64_t q);
+
+  // a · b mod q for a, b < q.
+  uint64_t Multiply(uint64_t a, uint64_t b) const {
+    const unsigned __int128 z = static_cast<unsigned __int128>(a) * b;
+    const uint64_t top = static_cast<uint64_t>(z >> (bits_ - 1));
+    const uint64_t quotient = static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(top) * ratio_) >> (bits_ + 1));
+    uint64_t r = static_cast<uint64_t>(z) - quotient * modulus_;
+    if (r >= modulus_) r -= modulus_;
+    if (r >= modulus_) r -= modulus_;
+    return r;
+  }
+
+  uint64_t modulus() const { return modulus_; }
+
+ private:
+  uint64_t modulus_;
+  int bits_;        // q < 2^bits_
+  uint64_t ratio_;  // floor(2^(2·bits_) / q)
+};
+
+// Reduces a signed value into [0, q).
+inline uint64_t ReduceSigned(int64_t value, uint64_t q) {
+  int64_t r = value % static_cast<int64_t>(q);
+  return static_cast<uint64_t>(r < 0 ? r + static_cast<int64_t>(q) : r);
+}
+
+// Centered representative of value ∈ [0, q), in (−q/2, q/2].
+inline int64_t LiftCentered(uint64_t value, uint64_t q) {
+  return value > q / 2 ? static_cast<int64_t>(value) - static_cast<int64_t>(q)
+                       : static_cast<int64_t>(value);
+}
+
+uint64_t PowMod(uint64_t base, uint64_t exponent, uint64_t q);
+
+// Inverse of a modulo prime q (a ≠ 0).
+uint64_t InvMod(uint64_t a, uint64_t q);
+
+// Deterministic Miller–Rabin for all 64-bit inputs.
+bool IsPrime(uint64_t n);
+
+// Finds the `count` largest primes below 2^bits with q ≡ 1 (mod 2n).
+//
+// Args:
+//   bits: Prime size in bits (20..62)
+//   count: Number of primes
+//   ring_dimension: n (power of two)
+//
+// Returns:
+//   Primes in descending order
+//   InvalidArgument if the request cannot be met
+absl::StatusOr<std::vector<uint64_t>> GenerateNttPrimes(int bits, int count,
+                                                        int ring_dimension);
+
+// Precomputed negacyclic NTT for Z_q[X]/(X^n + 1).
+//
+// Thread Safety: Immutable after Create(); transforms are reentrant.
+//
+// Performance: Forward/Inverse are O(n log n) with one Shoup
+// multiplication per butterfly.
+class NttTables {
+ public:
+  // Builds tables for prime q ≡ 1 (mod 2n), n a power of two.
+  //
+  // Returns:
+  //   Tables using the smallest primitive 2n-th root of unity ψ
+  //   InvalidArgument if q or n are unsuitable
+  static absl::StatusOr<NttTables> Create(uint64_t modulus,
+                                          int ring_dimension);
+
+  // In place: coefficients (natural order) → evaluations, where
+  // values[i] = a(ψ^EvaluationExponent(i)).
+  void Forward(uint64_t* values) const;
+
+  // In place: evaluations → coefficients.
+  void Inverse(uint64_t* values) const;
+
+  // Odd exponent e ∈ [1, 2n) such that Forward leaves a(ψ^e) at `index`.
+  int EvaluationExponent(int index) const;
+
+  // Index holding a(ψ^e) after Forward (e odd, taken mod 2n).
+  int IndexOfExponent(int64_t exponent) const;
+
+  uint64_t modulus() const { return modulus_; }
+  int ring_dimension() const { return n_; }
+  uint64_t root() const { return psi_; }
+
+ private:
+  NttTables() = default;
+
+  uint64_t modulus_ = 0;
+  int n_ = 0;
+  int log_n_ = 0;
+  uint64_t psi_ = 0;
+  // ψ^brv(k) and ψ^-brv(k) with their Shoup quotients.
+  std::vector<uint64_t> roots_;
+  std::vector<uint64_t> roots_shoup_;
+  std::vector<uint64_t> inv_roots_;
+  std::vector<uint64_t> inv_roots_shoup_;
+  uint64_t inv_n_ = 0;
+  uint64_t inv_n_shoup_ = 0;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_NTT_H_
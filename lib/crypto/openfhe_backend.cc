@@ -0,0 +1,55 @@
+// lib/crypto/openfhe_backend.cc
+//
+// OpenFHE backend (stub until the OpenFHE build is configured).
+
+#include "lib/crypto/openfhe_backend.h"
+
+// Note: OpenFHE headers will be included here once the build is working.
+
+namespace f2chat {
+
+absl::StatusOr<std::shared_ptr<const FheBackend>> CreateOpenFheBackend() {
+  // TODO: Initialize OpenFHE crypto context with BGV scheme
+  //
+  // Planned implementation:
+  // 1. Create CryptoContext with BGV scheme
+  // 2. Set parameters:
+  //    - Ring dimension: RingParams::kDegree (64/256/4096)
+  //    - Modulus: RingParams::kModulus (65537)
+  //    - Security level: HEStd_128_classic
+  //    - Multiplicative depth: 0 (depth-0 operations only!)
+  // 3. Enable features:
+  //    - Encryption
+  //    - SHE (for homomorphic operations)
+  //    - Leveled SHE (for efficient depth-0 operations)
+  //
+  // Example OpenFHE code:
+  // CCParams<CryptoContextBGVRNS> parameters;
+  // parameters.SetMultiplicativeDepth(0);
+  // parameters.SetPlaintextModulus(RingParams::kModulus);
+  // parameters.SetRingDim(RingParams::kDegree);
+  // CryptoContext cc = GenCryptoContext(parameters);
+  // cc->Enable(PKE);
+  // cc->Enable(KEYSWITCH);
+  // cc->Enable(LEVELEDSHE);
+  //
+  // The backend then maps FheBackend calls onto the context:
+  // - GenerateKeyPair: KeyGen() + EvalRotateKeyGen() for ±1..kDegree-1
+  // - Encrypt/Decrypt: MakePackedPlaintext() + Encrypt() / Decrypt()
+  // - Add/Subtract/MultiplyScalar/Rotate: EvalAdd/EvalSub/EvalMult/EvalRotate
+  // with ciphertexts and keys wrapped in FheCiphertext/FhePublicKey/
+  // FhePrivateKey subclasses holding the OpenFHE shared pointers.
+
+  return absl::UnimplementedError(
+      "OpenFHE backend - OpenFHE integration pending. "
+      "This will be implemented once OpenFHE build is configured.");
+}
+
+namespace {
+
+FheBackendRegistrar openfhe_registrar(kOpenFheBackendName,
+                                      &CreateOpenFheBackend);
+
+}  // namespace
+
+}  // namespace f2chat
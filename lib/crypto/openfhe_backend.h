@@ -0,0 +1,35 @@
+// lib/crypto/openfhe_backend.h
+//
+// OpenFHE BGV backend for FHEContext.
+//
+// Registered as "openfhe". Wraps OpenFHE's BGV-RNS scheme with ring
+// dimension matched to RingParams, plaintext modulus RingParams::kModulus,
+// 128-bit security (HEStd_128_classic) and multiplicative depth 0.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_OPENFHE_BACKEND_H_
+#define F2CHAT_LIB_CRYPTO_OPENFHE_BACKEND_H_
+
+#include <memory>
+#include "lib/crypto/fhe_backend.h"
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+
+// Registry name of the OpenFHE backend.
+inline constexpr char kOpenFheBackendName[] = "openfhe";
+
+// Creates the OpenFHE backend.
+//
+// Returns:
+//   Backend ready for key generation
+//   Unimplemented until the OpenFHE build is configured
+//
+// Performance: ~10ms (one-time setup)
+absl::StatusOr<std::shared_ptr<const FheBackend>> CreateOpenFheBackend();
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_OPENFHE_BACKEND_H_
@@ -2,6 +2,7 @@
 #include "lib/crypto/polynomial.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <numbers>
 #include "absl/strings/str_cat.h"
@@ -199,34 +200,49 @@ absl::StatusOr<Polynomial> Polynomial::ProjectToCharacter(
         " (must be 0-", RingParams::kNumCharacters - 1, ")"));
   }
 
-  // Character projection via DFT.
-  // χⱼ(k) = exp(2πijk/n) where n = kNumCharacters
-  // Proj_χⱼ(p) = (1/n) Σₖ χⱼ(k)* · p_k
-
-  int n = RingParams::kNumCharacters;
-  double factor = 1.0 / n;
-
   std::vector<int64_t> projection(RingParams::kDegree, 0);
 
   // For each coefficient slot.
   for (int slot = 0; slot < RingParams::kDegree; ++slot) {
-    // Compute DFT component.
-    std::complex<double> sum(0.0, 0.0);
+    projection[slot] = ProjectSlot(character_index, slot);
+  }
+
+  return Polynomial(projection);
+}
 
-    for (int k = 0; k < n; ++k) {
-      // ω = exp(-2πi/n) (note: conjugate for inverse)
-      double angle = -2.0 * std::numbers::pi * character_index * k / n;
-      std::complex<double> omega(std::cos(angle), std::sin(angle));
+int64_t Polynomial::ProjectSlot(int character_index, int slot) const {
+  return ProjectWindow(coefficients_.data(), character_index, slot);
+}
 
-      // Get coefficient (cycling through if slot >= n).
-      int coeff_idx = (slot * n + k) % RingParams::kDegree;
-      sum += omega * static_cast<double>(coefficients_[coeff_idx]);
+int64_t Polynomial::ProjectWindow(
+    const int64_t* coefficients, int character_index, int slot) {
+  // Character projection via DFT.
+  // χⱼ(k) = exp(2πijk/n) where n = kNumCharacters
+  // Proj_χⱼ(p) = (1/n) Σₖ χⱼ(k)* · p_k
+  constexpr int n = RingParams::kNumCharacters;
+  constexpr double factor = 1.0 / n;
+
+  // Re ω^{jk}, ω = exp(-2πi/n) (note: conjugate for inverse). Only the
+  // real part of the sum is kept, so the imaginary twiddles are not needed.
+  static const std::array<double, n * n> twiddles = [] {
+    std::array<double, n * n> table;
+    for (int j = 0; j < n; ++j) {
+      for (int k = 0; k < n; ++k) {
+        table[j * n + k] = std::cos(-2.0 * std::numbers::pi * j * k / n);
+      }
     }
-
-    projection[slot] = ReduceMod(static_cast<int64_t>(std::round(sum.real() * factor)));
+    return table;
+  }();
+
+  const double* row = &twiddles[character_index * n];
+  double sum = 0.0;
+  for (int k = 0; k < n; ++k) {
+    // Get coefficient (cycling through if slot >= n).
+    int coeff_idx = (slot * n + k) % RingParams::kDegree;
+    sum += row[k] * static_cast<double>(coefficients[coeff_idx]);
   }
 
-  return Polynomial(projection);
+  return ReduceMod(static_cast<int64_t>(std::round(sum * factor)));
 }
 
 std::vector<Polynomial> Polynomial::ProjectToAllCharacters() const {
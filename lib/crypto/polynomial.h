@@ -169,6 +169,21 @@ class Polynomial {
   // Performance: O(k * n log n) where k = kNumCharacters
   std::vector<Polynomial> ProjectToAllCharacters() const;
 
+  // Single coefficient of ProjectToCharacter(character_index) (unchecked).
+  //
+  // Lets callers that need only some slots skip the full projection; the
+  // arithmetic is the same, so results match ProjectToCharacter exactly.
+  //
+  // Performance: O(k)
+  int64_t ProjectSlot(int character_index, int slot) const;
+
+  // ProjectSlot over a raw coefficient array (kDegree values in [0, p)),
+  // for batched kernels that keep coefficients outside a Polynomial.
+  //
+  // Performance: O(k) (twiddle factors are tabulated once)
+  static int64_t ProjectWindow(
+      const int64_t* coefficients, int character_index, int slot);
+
   // Accessors.
 
   const std::vector<int64_t>& coefficients() const {
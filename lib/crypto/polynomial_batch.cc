@@ -0,0 +1,36 @@
+// lib/crypto/polynomial_batch.cc
+#include "lib/crypto/polynomial_batch.h"
+
+#include <algorithm>
+
+namespace f2chat {
+
+PolynomialBatch::PolynomialBatch(size_t size)
+    : size_(size), coefficients_(size * RingParams::kDegree, 0) {}
+
+PolynomialBatch PolynomialBatch::FromPolynomials(
+    const std::vector<Polynomial>& polynomials) {
+  PolynomialBatch batch(polynomials.size());
+  for (size_t i = 0; i < polynomials.size(); ++i) {
+    batch.Set(i, polynomials[i]);
+  }
+  return batch;
+}
+
+void PolynomialBatch::Resize(size_t size) {
+  size_ = size;
+  coefficients_.resize(size * RingParams::kDegree, 0);
+}
+
+Polynomial PolynomialBatch::Get(size_t i) const {
+  const int64_t* coefficients = row(i);
+  return Polynomial(std::vector<int64_t>(
+      coefficients, coefficients + RingParams::kDegree));
+}
+
+void PolynomialBatch::Set(size_t i, const Polynomial& polynomial) {
+  const auto& coefficients = polynomial.coefficients();
+  std::copy(coefficients.begin(), coefficients.end(), row(i));
+}
+
+}  // namespace f2chat
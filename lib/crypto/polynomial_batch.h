@@ -0,0 +1,60 @@
+// lib/crypto/polynomial_batch.h
+//
+// Contiguous batch of ring elements for batched kernels.
+//
+// A std::vector<Polynomial> keeps every polynomial in its own heap block.
+// PolynomialBatch stores `size` polynomials back to back in one
+// size × kDegree array of coefficients (row i = polynomial i), so batched
+// operators stream through memory and reuse each weight row across the
+// whole batch.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_POLYNOMIAL_BATCH_H_
+#define F2CHAT_LIB_CRYPTO_POLYNOMIAL_BATCH_H_
+
+#include <cstdint>
+#include <vector>
+#include "lib/crypto/polynomial.h"
+
+namespace f2chat {
+
+// Row-major batch of polynomials (coefficients in [0, p)).
+//
+// Thread Safety: Not thread-safe for writes; distinct rows may be written
+// concurrently.
+class PolynomialBatch {
+ public:
+  // Batch of `size` zero polynomials.
+  explicit PolynomialBatch(size_t size = 0);
+
+  // Copies polynomials into a batch.
+  static PolynomialBatch FromPolynomials(
+      const std::vector<Polynomial>& polynomials);
+
+  // Resizes to `size` rows (new rows are zero).
+  void Resize(size_t size);
+
+  size_t size() const { return size_; }
+
+  // Coefficients of row i (kDegree values).
+  int64_t* row(size_t i) {
+    return coefficients_.data() + i * RingParams::kDegree;
+  }
+  const int64_t* row(size_t i) const {
+    return coefficients_.data() + i * RingParams::kDegree;
+  }
+
+  // Copies row i out / in.
+  Polynomial Get(size_t i) const;
+  void Set(size_t i, const Polynomial& polynomial);
+
+ private:
+  size_t size_ = 0;
+  std::vector<int64_t> coefficients_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_POLYNOMIAL_BATCH_H_
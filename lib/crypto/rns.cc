@@ -0,0 +1,209 @@
+// lib/crypto/rns.cc
+//
+// Implementation of RNS polynomial arithmetic.
+
+#include "lib/crypto/rns.h"
+
+#include <algorithm>
+#include <utility>
+#include "absl/strings/str_format.h"
+
+namespace f2chat {
+
+absl::StatusOr<std::shared_ptr<const RnsBasis>> RnsBasis::Create(
+    int ring_dimension, std::vector<uint64_t> primes) {
+  if (primes.empty()) {
+    return absl::InvalidArgumentError("RNS basis needs at least one prime");
+  }
+  std::shared_ptr<RnsBasis> basis(new RnsBasis());
+  basis->n_ = ring_dimension;
+  for (size_t i = 0; i < primes.size(); ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      if (primes[i] == primes[j]) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Duplicate RNS prime %d", primes[i]));
+      }
+    }
+    auto tables = NttTables::Create(primes[i], ring_dimension);
+    if (!tables.ok()) return tables.status();
+    basis->ntt_.push_back(*std::move(tables));
+    basis->reducers_.emplace_back(primes[i]);
+  }
+  basis->primes_ = std::move(primes);
+  return std::shared_ptr<const RnsBasis>(std::move(basis));
+}
+
+std::vector<uint32_t> RnsBasis::GaloisPermutation(uint64_t galois) const {
+  // automorphism(a)(ψ^e) = a(ψ^(galois·e)): same layout for every limb.
+  const NttTables& tables = ntt_[0];
+  const uint64_t two_n = 2 * static_cast<uint64_t>(n_);
+  std::vector<uint32_t> permutation(n_);
+  for (int i = 0; i < n_; ++i) {
+    const uint64_t e = tables.EvaluationExponent(i);
+    permutation[i] = tables.IndexOfExponent((galois % two_n) * e % two_n);
+  }
+  return permutation;
+}
+
+RnsPoly::RnsPoly(const RnsBasis* basis, Form form)
+    : basis_(basis),
+      form_(form),
+      data_(static_cast<size_t>(basis->num_limbs()) *
+                basis->ring_dimension(),
+            0) {}
+
+RnsPoly RnsPoly::FromSigned(const RnsBasis* basis,
+                            absl::Span<const int64_t> coefficients) {
+  RnsPoly poly(basis, Form::kCoefficient);
+  const size_t count = std::min(
+      coefficients.size(), static_cast<size_t>(basis->ring_dimension()));
+  for (int l = 0; l < basis->num_limbs(); ++l) {
+    const uint64_t q = basis->prime(l);
+    uint64_t* out = poly.limb(l);
+    for (size_t j = 0; j < count; ++j) {
+      out[j] = ReduceSigned(coefficients[j], q);
+    }
+  }
+  return poly;
+}
+
+void RnsPoly::ToEvaluation() {
+  if (form_ == Form::kEvaluation) return;
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    basis_->ntt(l).Forward(limb(l));
+  }
+  form_ = Form::kEvaluation;
+}
+
+void RnsPoly::ToCoefficient() {
+  if (form_ == Form::kCoefficient) return;
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    basis_->ntt(l).Inverse(limb(l));
+  }
+  form_ = Form::kCoefficient;
+}
+
+void RnsPoly::AddInPlace(const RnsPoly& other) {
+  const int n = basis_->ring_dimension();
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    uint64_t* x = limb(l);
+    const uint64_t* y = other.limb(l);
+    for (int j = 0; j < n; ++j) x[j] = AddMod(x[j], y[j], q);
+  }
+}
+
+void RnsPoly::SubtractInPlace(const RnsPoly& other) {
+  const int n = basis_->ring_dimension();
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    uint64_t* x = limb(l);
+    const uint64_t* y = other.limb(l);
+    for (int j = 0; j < n; ++j) x[j] = SubMod(x[j], y[j], q);
+  }
+}
+
+void RnsPoly::MultiplyInPlace(const RnsPoly& other) {
+  const int n = basis_->ring_dimension();
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const BarrettReducer& reducer = basis_->reducer(l);
+    uint64_t* x = limb(l);
+    const uint64_t* y = other.limb(l);
+    for (int j = 0; j < n; ++j) x[j] = reducer.Multiply(x[j], y[j]);
+  }
+}
+
+void RnsPoly::MultiplyInPlace(const RnsPoly& other,
+                              absl::Span<const uint64_t> other_shoup) {
+  const int n = basis_->ring_dimension();
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    uint64_t* x = limb(l);
+    const uint64_t* y = other.limb(l);
+    const uint64_t* y_shoup = other_shoup.data() + l * n;
+    for (int j = 0; j < n; ++j) x[j] = MulModShoup(x[j], y[j], y_shoup[j], q);
+  }
+}
+
+std::vector<uint64_t> RnsPoly::ShoupQuotients() const {
+  const int n = basis_->ring_dimension();
+  std::vector<uint64_t> quotients(data_.size());
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    const uint64_t* x = limb(l);
+    uint64_t* out = quotients.data() + l * n;
+    for (int j = 0; j < n; ++j) out[j] = ShoupPrecompute(x[j], q);
+  }
+  return quotients;
+}
+
+void RnsPoly::MultiplyAccumulate(const RnsPoly& a, const RnsPoly& b) {
+  const int n = basis_->ring_dimension();
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    const BarrettReducer& reducer = basis_->reducer(l);
+    uint64_t* x = limb(l);
+    const uint64_t* y = a.limb(l);
+    const uint64_t* z = b.limb(l);
+    for (int j = 0; j < n; ++j) {
+      x[j] = AddMod(x[j], reducer.Multiply(y[j], z[j]), q);
+    }
+  }
+}
+
+void RnsPoly::MultiplyScalarInPlace(int64_t scalar) {
+  const int n = basis_->ring_dimension();
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    const uint64_t w = ReduceSigned(scalar, q);
+    const uint64_t w_shoup = ShoupPrecompute(w, q);
+    uint64_t* x = limb(l);
+    for (int j = 0; j < n; ++j) x[j] = MulModShoup(x[j], w, w_shoup, q);
+  }
+}
+
+void RnsPoly::NegateInPlace() {
+  const int n = basis_->ring_dimension();
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    uint64_t* x = limb(l);
+    for (int j = 0; j < n; ++j) x[j] = x[j] == 0 ? 0 : q - x[j];
+  }
+}
+
+RnsPoly RnsPoly::Automorphism(uint64_t galois) const {
+  if (form_ == Form::kEvaluation) {
+    return Permute(basis_->GaloisPermutation(galois));
+  }
+  // X^j → X^(g·j mod 2n), with X^n = -1.
+  const int n = basis_->ring_dimension();
+  const uint64_t two_n = 2 * static_cast<uint64_t>(n);
+  RnsPoly result(basis_, form_);
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t q = basis_->prime(l);
+    const uint64_t* x = limb(l);
+    uint64_t* y = result.limb(l);
+    for (int j = 0; j < n; ++j) {
+      const uint64_t target = (galois % two_n) * j % two_n;
+      if (target < static_cast<uint64_t>(n)) {
+        y[target] = x[j];
+      } else {
+        y[target - n] = x[j] == 0 ? 0 : q - x[j];
+      }
+    }
+  }
+  return result;
+}
+
+RnsPoly RnsPoly::Permute(absl::Span<const uint32_t> permutation) const {
+  const int n = basis_->ring_dimension();
+  RnsPoly result(basis_, form_);
+  for (int l = 0; l < basis_->num_limbs(); ++l) {
+    const uint64_t* x = limb(l);
+    uint64_t* y = result.limb(l);
+    for (int j = 0; j < n; ++j) y[j] = x[permutation[j]];
+  }
+  return result;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,141 @@
+// lib/crypto/rns.h
+//
+// Residue-number-system polynomials for the native RLWE backend.
+//
+// A ciphertext polynomial in R_Q = Z_Q[X]/(X^n + 1), Q = q_0·q_1·…·q_{L-1},
+// is stored as L word-size limbs, one per NTT-friendly prime. Ring
+// operations act limb by limb; multiplication happens pointwise in
+// evaluation (NTT) form.
+//
+// Key Properties:
+// - Limb-major contiguous storage (n words per limb)
+// - Explicit form tracking: coefficient vs evaluation
+// - Galois automorphisms X → X^g in either form (a signed index map on
+//   coefficients, a permutation on evaluations)
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_RNS_H_
+#define F2CHAT_LIB_CRYPTO_RNS_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "lib/crypto/ntt.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace f2chat {
+
+// Modulus chain and NTT tables shared by all polynomials of one scheme.
+//
+// Thread Safety: Immutable after Create().
+class RnsBasis {
+ public:
+  // Args:
+  //   ring_dimension: n (power of two)
+  //   primes: Distinct primes ≡ 1 (mod 2n), each below 2^62
+  //
+  // Returns:
+  //   Basis with NTT tables per prime
+  //   InvalidArgument if any prime is unsuitable
+  static absl::StatusOr<std::shared_ptr<const RnsBasis>> Create(
+      int ring_dimension, std::vector<uint64_t> primes);
+
+  int ring_dimension() const { return n_; }
+  int num_limbs() const { return static_cast<int>(primes_.size()); }
+  uint64_t prime(int limb) const { return primes_[limb]; }
+  const NttTables& ntt(int limb) const { return ntt_[limb]; }
+  const BarrettReducer& reducer(int limb) const { return reducers_[limb]; }
+
+  // Evaluation-form permutation of X → X^galois (galois odd):
+  // automorphism(a)[i] = a[permutation[i]] for every limb.
+  std::vector<uint32_t> GaloisPermutation(uint64_t galois) const;
+
+ private:
+  RnsBasis() = default;
+
+  int n_ = 0;
+  std::vector<uint64_t> primes_;
+  std::vector<NttTables> ntt_;
+  std::vector<BarrettReducer> reducers_;
+};
+
+// Polynomial in R_Q, stored per RNS limb.
+//
+// Performance (n = ring dimension, L = limbs):
+// - Add/Subtract/pointwise Multiply: O(L·n)
+// - ToEvaluation/ToCoefficient: O(L·n log n)
+// - Automorphism: O(L·n)
+class RnsPoly {
+ public:
+  enum class Form { kCoefficient, kEvaluation };
+
+  RnsPoly() = default;
+
+  // Zero polynomial over `basis` (which must outlive it).
+  RnsPoly(const RnsBasis* basis, Form form);
+
+  // Embeds small signed coefficients (|c| < every prime) into each limb.
+  //
+  // Args:
+  //   coefficients: Up to n values; missing ones are zero
+  static RnsPoly FromSigned(const RnsBasis* basis,
+                            absl::Span<const int64_t> coefficients);
+
+  const RnsBasis& basis() const { return *basis_; }
+  Form form() const { return form_; }
+  bool empty() const { return basis_ == nullptr; }
+
+  uint64_t* limb(int i) { return data_.data() + i * basis_->ring_dimension(); }
+  const uint64_t* limb(int i) const {
+    return data_.data() + i * basis_->ring_dimension();
+  }
+
+  // Form conversions (no-ops if already in that form).
+  void ToEvaluation();
+  void ToCoefficient();
+
+  // this ← this ± other. Forms must match.
+  void AddInPlace(const RnsPoly& other);
+  void SubtractInPlace(const RnsPoly& other);
+
+  // this ← this ⊙ other (both in evaluation form).
+  void MultiplyInPlace(const RnsPoly& other);
+
+  // Same, with other_shoup = other.ShoupQuotients(): for a fixed operand
+  // reused across many products (one high multiply instead of Barrett's
+  // two).
+  void MultiplyInPlace(const RnsPoly& other,
+                       absl::Span<const uint64_t> other_shoup);
+
+  // Shoup quotient of every value, limb-major like the limbs themselves.
+  std::vector<uint64_t> ShoupQuotients() const;
+
+  // this ← this + a ⊙ b (all in evaluation form).
+  void MultiplyAccumulate(const RnsPoly& a, const RnsPoly& b);
+
+  // this ← scalar · this (any form).
+  void MultiplyScalarInPlace(int64_t scalar);
+
+  void NegateInPlace();
+
+  // X → X^galois (galois odd), in either form.
+  RnsPoly Automorphism(uint64_t galois) const;
+
+  // Evaluation-form automorphism using a GaloisPermutation() table.
+  RnsPoly Permute(absl::Span<const uint32_t> permutation) const;
+
+  // Bytes held by the limbs.
+  size_t ByteSize() const { return data_.size() * sizeof(uint64_t); }
+
+ private:
+  const RnsBasis* basis_ = nullptr;
+  Form form_ = Form::kCoefficient;
+  std::vector<uint64_t> data_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_RNS_H_
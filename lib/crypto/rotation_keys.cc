@@ -0,0 +1,105 @@
+// lib/crypto/rotation_keys.cc
+//
+// Implementation of rotation key sets and rotation plans.
+
+#include "lib/crypto/rotation_keys.h"
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include "lib/crypto/polynomial_params.h"
+#include "absl/strings/str_format.h"
+
+namespace f2chat {
+
+int BabyStepCount(int span) {
+  int baby_steps = 1;
+  while (baby_steps * baby_steps < span) baby_steps <<= 1;
+  return baby_steps;
+}
+
+RotationKeySet::RotationKeySet(int degree) : degree_(degree) {}
+
+RotationKeySet RotationKeySet::PowersOfTwo(int degree) {
+  RotationKeySet set(degree);
+  for (int step = 1; step < degree; step <<= 1) set.Add(step);
+  return set;
+}
+
+RotationKeySet RotationKeySet::BabyStepGiantStep(int degree, int span,
+                                                 int baby_steps) {
+  RotationKeySet set(degree);
+  for (int a = 1; a < baby_steps && a < span; ++a) set.Add(-a);
+  for (int b = baby_steps; b < span; b += baby_steps) set.Add(-b);
+  return set;
+}
+
+RotationKeySet RotationKeySet::Default(int degree) {
+  const int span = std::min(RingParams::kNumCharacters, degree);
+  return PowersOfTwo(degree).Merge(
+      BabyStepGiantStep(degree, span, BabyStepCount(span)));
+}
+
+int RotationKeySet::Normalize(int positions) const {
+  return ((positions % degree_) + degree_) % degree_;
+}
+
+RotationKeySet& RotationKeySet::Add(int positions) {
+  const int r = Normalize(positions);
+  if (r == 0) return *this;
+  auto it = std::lower_bound(rotations_.begin(), rotations_.end(), r);
+  if (it == rotations_.end() || *it != r) rotations_.insert(it, r);
+  return *this;
+}
+
+RotationKeySet& RotationKeySet::Merge(const RotationKeySet& other) {
+  for (int r : other.rotations_) Add(r);
+  return *this;
+}
+
+bool RotationKeySet::Contains(int positions) const {
+  return std::binary_search(rotations_.begin(), rotations_.end(),
+                            Normalize(positions));
+}
+
+RotationPlan::RotationPlan(RotationKeySet keys)
+    : keys_(std::move(keys)),
+      last_(keys_.degree(), 0),
+      distance_(keys_.degree(), -1) {
+  const int d = keys_.degree();
+  distance_[0] = 0;
+  std::deque<int> frontier = {0};
+  while (!frontier.empty()) {
+    const int x = frontier.front();
+    frontier.pop_front();
+    for (int r : keys_.rotations()) {
+      const int y = (x + r) % d;
+      if (distance_[y] >= 0) continue;
+      distance_[y] = distance_[x] + 1;
+      last_[y] = r;
+      max_key_switches_ = std::max(max_key_switches_, distance_[y]);
+      frontier.push_back(y);
+    }
+  }
+  complete_ = std::none_of(distance_.begin(), distance_.end(),
+                           [](int distance) { return distance < 0; });
+}
+
+absl::StatusOr<std::vector<int>> RotationPlan::Decompose(
+    int positions) const {
+  const int d = keys_.degree();
+  int x = ((positions % d) + d) % d;
+  if (distance_[x] < 0) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Rotation keys cannot compose a rotation by %d", positions));
+  }
+  std::vector<int> steps;
+  steps.reserve(distance_[x]);
+  while (x != 0) {
+    steps.push_back(last_[x]);
+    x = (x - last_[x] + d) % d;
+  }
+  return steps;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,109 @@
+// lib/crypto/rotation_keys.h
+//
+// Rotation key sets and runtime composition of rotations.
+//
+// A key pair only carries key-switching keys for the rotations its workload
+// needs. Any other rotation is composed from keyed ones at runtime, using
+// the fewest key switches (RotationPlan). Generating a key for every offset
+// instead costs d − 1 keys: gigabytes per user at d = 4096.
+//
+// Rotation amounts follow FheBackend::Rotate: a rotation by r moves
+// coefficient i to (i + r) mod d, and negative r rotates left. Amounts are
+// taken mod d, so r and r − d name the same key.
+//
+// Key Properties:
+// - Default(d): powers of two, so any rotation takes ≤ log2(d) key switches,
+//   plus the baby-step/giant-step rotations of the character transform
+// - O(log d + √k) keys instead of d − 1 (k = kNumCharacters)
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_ROTATION_KEYS_H_
+#define F2CHAT_LIB_CRYPTO_ROTATION_KEYS_H_
+
+#include <vector>
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+
+// Baby steps g for a baby-step/giant-step sum over `span` consecutive
+// positions: the power of two nearest above √span, so g and span / g differ
+// by at most 2×.
+int BabyStepCount(int span);
+
+// Set of rotations a key pair carries keys for.
+class RotationKeySet {
+ public:
+  // Empty set for messages of `degree` coefficients (power of two).
+  explicit RotationKeySet(int degree);
+
+  // Rotations by 2^i for 0 ≤ i < log2(d).
+  static RotationKeySet PowersOfTwo(int degree);
+
+  // Left rotations of a baby-step/giant-step sum over `span` positions:
+  // by −1..−(g−1) (baby steps) and by −g, −2g, ... > −span (giant steps).
+  static RotationKeySet BabyStepGiantStep(int degree, int span,
+                                          int baby_steps);
+
+  // PowersOfTwo(d) plus BabyStepGiantStep over the kNumCharacters window
+  // (capped at d) with BabyStepCount baby steps.
+  static RotationKeySet Default(int degree);
+
+  // Adds the key for a rotation by `positions` (no-op for multiples of d).
+  RotationKeySet& Add(int positions);
+  RotationKeySet& Merge(const RotationKeySet& other);
+
+  bool Contains(int positions) const;
+
+  int degree() const { return degree_; }
+  int size() const { return static_cast<int>(rotations_.size()); }
+
+  // Keyed rotations, normalized to [1, d) and ascending.
+  const std::vector<int>& rotations() const { return rotations_; }
+
+ private:
+  int Normalize(int positions) const;
+
+  int degree_;
+  std::vector<int> rotations_;
+};
+
+// Fewest-key-switch composition of every rotation from a key set.
+//
+// Thread Safety: Immutable after construction.
+//
+// Performance: Construction is a BFS over Z_d, O(d · |keys|); Decompose()
+// is O(key switches).
+class RotationPlan {
+ public:
+  explicit RotationPlan(RotationKeySet keys);
+
+  // Keyed rotations summing to `positions` (mod d).
+  //
+  // Returns:
+  //   The rotations to apply in sequence (empty for a multiple of d)
+  //   FailedPrecondition if the keys cannot compose this rotation
+  absl::StatusOr<std::vector<int>> Decompose(int positions) const;
+
+  // Key switches of the costliest reachable rotation.
+  int max_key_switches() const { return max_key_switches_; }
+
+  // True if every rotation can be composed.
+  bool complete() const { return complete_; }
+
+  const RotationKeySet& keys() const { return keys_; }
+
+ private:
+  RotationKeySet keys_;
+  // last_[r]: final keyed rotation on a shortest path to r (0 if none).
+  std::vector<int> last_;
+  // Key switches to reach r, or −1 if unreachable.
+  std::vector<int> distance_;
+  int max_key_switches_ = 0;
+  bool complete_ = true;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_ROTATION_KEYS_H_
@@ -42,6 +42,16 @@ struct RoutingWeights {
   }
 };
 
+// Character values that routing weights multiply (see RoutingOperator).
+enum class WeightBasis {
+  // Rounded real projections (Polynomial::ProjectSlot), as
+  // ApplyRoutingWeights uses.
+  kRoundedProjections,
+  // Exact F_p projections of CharacterTransform, lifted to (−p/2, p/2]:
+  // the values EncryptedRouting evaluates on ciphertexts.
+  kFpCharacters,
+};
+
 // Training example for learning routing weights.
 struct RoutingExample {
   Polynomial source_poly;       // Source polynomial ID
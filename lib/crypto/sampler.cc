@@ -0,0 +1,122 @@
+// lib/crypto/sampler.cc
+//
+// Implementation of the ChaCha20 generator and RLWE samplers.
+
+#include "lib/crypto/sampler.h"
+
+#include <sys/random.h>
+
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+
+namespace f2chat {
+namespace {
+
+inline uint32_t Rotl(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+inline void QuarterRound(std::array<uint32_t, 16>& x, int a, int b, int c,
+                         int d) {
+  x[a] += x[b]; x[d] = Rotl(x[d] ^ x[a], 16);
+  x[c] += x[d]; x[b] = Rotl(x[b] ^ x[c], 12);
+  x[a] += x[b]; x[d] = Rotl(x[d] ^ x[a], 8);
+  x[c] += x[d]; x[b] = Rotl(x[b] ^ x[c], 7);
+}
+
+}  // namespace
+
+Prng Prng::FromEntropy() {
+  std::array<uint32_t, 8> key;
+  char* out = reinterpret_cast<char*>(key.data());
+  size_t remaining = sizeof(key);
+  while (remaining > 0) {
+    ssize_t got = getrandom(out, remaining, 0);
+    if (got < 0) {
+      // Without OS entropy no key material can be produced safely.
+      std::perror("getrandom");
+      std::abort();
+    }
+    out += got;
+    remaining -= static_cast<size_t>(got);
+  }
+  return Prng(key);
+}
+
+Prng::Prng(const std::array<uint32_t, 8>& key, uint64_t stream)
+    : block_{}, position_(16) {
+  // "expand 32-byte k"
+  state_[0] = 0x61707865;
+  state_[1] = 0x3320646e;
+  state_[2] = 0x79622d32;
+  state_[3] = 0x6b206574;
+  for (int i = 0; i < 8; ++i) state_[4 + i] = key[i];
+  state_[12] = 0;  // 64-bit block counter
+  state_[13] = 0;
+  state_[14] = static_cast<uint32_t>(stream);
+  state_[15] = static_cast<uint32_t>(stream >> 32);
+}
+
+void Prng::Refill() {
+  block_ = state_;
+  for (int round = 0; round < 10; ++round) {
+    QuarterRound(block_, 0, 4, 8, 12);
+    QuarterRound(block_, 1, 5, 9, 13);
+    QuarterRound(block_, 2, 6, 10, 14);
+    QuarterRound(block_, 3, 7, 11, 15);
+    QuarterRound(block_, 0, 5, 10, 15);
+    QuarterRound(block_, 1, 6, 11, 12);
+    QuarterRound(block_, 2, 7, 8, 13);
+    QuarterRound(block_, 3, 4, 9, 14);
+  }
+  for (int i = 0; i < 16; ++i) block_[i] += state_[i];
+  if (++state_[12] == 0) ++state_[13];
+  position_ = 0;
+}
+
+uint32_t Prng::Next32() {
+  if (position_ == 16) Refill();
+  return block_[position_++];
+}
+
+uint64_t Prng::Next64() {
+  uint64_t low = Next32();
+  return low | (static_cast<uint64_t>(Next32()) << 32);
+}
+
+uint64_t Prng::Uniform(uint64_t bound) {
+  // Reject the top partial copy of [0, bound) to keep the result unbiased.
+  const uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+  uint64_t x;
+  do {
+    x = Next64();
+  } while (x >= limit);
+  return x % bound;
+}
+
+void SampleUniform(Prng& prng, RnsPoly& poly) {
+  const int n = poly.basis().ring_dimension();
+  for (int l = 0; l < poly.basis().num_limbs(); ++l) {
+    const uint64_t q = poly.basis().prime(l);
+    uint64_t* out = poly.limb(l);
+    for (int j = 0; j < n; ++j) out[j] = prng.Uniform(q);
+  }
+}
+
+std::vector<int64_t> SampleTernary(Prng& prng, int n) {
+  std::vector<int64_t> result(n);
+  for (auto& c : result) c = static_cast<int64_t>(prng.Uniform(3)) - 1;
+  return result;
+}
+
+std::vector<int64_t> SampleCenteredBinomial(Prng& prng, int n, int eta) {
+  // Difference of two η-bit popcounts (η ≤ 32).
+  const uint64_t mask = (uint64_t{1} << eta) - 1;
+  std::vector<int64_t> result(n);
+  for (auto& c : result) {
+    const uint64_t bits = prng.Next64();
+    c = std::popcount(bits & mask) - std::popcount((bits >> eta) & mask);
+  }
+  return result;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,67 @@
+// lib/crypto/sampler.h
+//
+// Randomness for the native RLWE backend.
+//
+// Prng is a ChaCha20 keystream generator seeded from the OS (getrandom),
+// used for every secret, mask and error polynomial. The sampling helpers
+// produce the three RLWE distributions:
+// - Uniform mod each RNS prime (public "a" polynomials)
+// - Uniform ternary {-1, 0, 1} (secret keys and encryption masks)
+// - Centered binomial, η = 21 (errors, σ ≈ 3.24 as in the HE standard)
+//
+// Thread Safety: A Prng is not thread-safe; create one per operation
+// (seeding costs one syscall).
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_CRYPTO_SAMPLER_H_
+#define F2CHAT_LIB_CRYPTO_SAMPLER_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "lib/crypto/rns.h"
+
+namespace f2chat {
+
+// ChaCha20-based cryptographically secure generator.
+class Prng {
+ public:
+  // Seeds a fresh generator with 256 bits from the OS.
+  static Prng FromEntropy();
+
+  // Deterministic generator (tests, reproducible benchmarks).
+  explicit Prng(const std::array<uint32_t, 8>& key, uint64_t stream = 0);
+
+  uint32_t Next32();
+  uint64_t Next64();
+
+  // Uniform in [0, bound), bound > 0 (rejection sampling, no bias).
+  uint64_t Uniform(uint64_t bound);
+
+ private:
+  void Refill();
+
+  std::array<uint32_t, 16> state_;
+  std::array<uint32_t, 16> block_;
+  int position_;
+};
+
+// Error-distribution parameter: CBD(η) has variance η/2.
+inline constexpr int kCenteredBinomialEta = 21;
+
+// Fills every limb of `poly` with independent uniform residues. Uniform in
+// one form is uniform in the other, so the form of `poly` is kept.
+void SampleUniform(Prng& prng, RnsPoly& poly);
+
+// n coefficients uniform in {-1, 0, 1}.
+std::vector<int64_t> SampleTernary(Prng& prng, int n);
+
+// n coefficients from the centered binomial distribution CBD(η).
+std::vector<int64_t> SampleCenteredBinomial(Prng& prng, int n,
+                                            int eta = kCenteredBinomialEta);
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_CRYPTO_SAMPLER_H_
@@ -0,0 +1,178 @@
+// lib/crypto/slot_packing.cc
+//
+// Implementation of slot packing.
+
+#include "lib/crypto/slot_packing.h"
+
+#include <utility>
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+
+namespace f2chat {
+namespace {
+
+bool IsPowerOfTwo(int64_t n) { return n > 0 && (n & (n - 1)) == 0; }
+
+}  // namespace
+
+struct SlotPacking::RotationMasks {
+  explicit RotationMasks(int message_degree) : masks(message_degree) {}
+
+  absl::Mutex mu;
+  std::vector<Plaintext> masks ABSL_GUARDED_BY(mu);  // By k; null until used
+};
+
+SlotPacking::SlotPacking(const FheBackend* backend, int message_degree,
+                         int capacity)
+    : backend_(backend),
+      message_degree_(message_degree),
+      capacity_(capacity),
+      rotation_masks_(std::make_shared<RotationMasks>(message_degree)) {}
+
+absl::StatusOr<SlotPacking> SlotPacking::Create(const FheBackend& backend,
+                                                int message_degree) {
+  const int slots = backend.message_degree();
+  if (!IsPowerOfTwo(message_degree) || slots % message_degree != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Message degree %d must be a power of two dividing the backend's "
+        "%d slots",
+        message_degree, slots));
+  }
+  SlotPacking packing(&backend, message_degree, slots / message_degree);
+  for (int b = 0; b < packing.capacity_; ++b) {
+    std::vector<int64_t> mask(slots, 0);
+    for (int i = 0; i < message_degree; ++i) mask[b * message_degree + i] = 1;
+    auto encoded = backend.EncodePlaintext(mask);
+    if (!encoded.ok()) return encoded.status();
+    packing.block_masks_.push_back(*std::move(encoded));
+  }
+  return packing;
+}
+
+absl::StatusOr<std::vector<int64_t>> SlotPacking::Pack(
+    const std::vector<std::vector<int64_t>>& messages) const {
+  if (messages.size() > static_cast<size_t>(capacity_)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Too many messages: %d (capacity: %d)", messages.size(), capacity_));
+  }
+  std::vector<int64_t> slots(num_slots(), 0);
+  for (size_t b = 0; b < messages.size(); ++b) {
+    if (messages[b].size() > static_cast<size_t>(message_degree_)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Message %d has %d coefficients (max: %d)", b, messages[b].size(),
+          message_degree_));
+    }
+    for (size_t i = 0; i < messages[b].size(); ++i) {
+      slots[b * message_degree_ + i] = messages[b][i];
+    }
+  }
+  return slots;
+}
+
+std::vector<std::vector<int64_t>> SlotPacking::Unpack(
+    const std::vector<int64_t>& slots) const {
+  std::vector<std::vector<int64_t>> messages(
+      capacity_, std::vector<int64_t>(message_degree_, 0));
+  for (size_t s = 0; s < slots.size() && s < static_cast<size_t>(num_slots());
+       ++s) {
+    messages[s / message_degree_][s % message_degree_] = slots[s];
+  }
+  return messages;
+}
+
+absl::StatusOr<Ciphertext> SlotPacking::Encrypt(
+    const std::vector<std::vector<int64_t>>& messages,
+    const PublicKey& public_key) const {
+  auto slots = Pack(messages);
+  if (!slots.ok()) return slots.status();
+  return backend_->Encrypt(*slots, public_key);
+}
+
+absl::StatusOr<std::vector<std::vector<int64_t>>> SlotPacking::Decrypt(
+    const Ciphertext& ciphertext, const PrivateKey& private_key) const {
+  auto slots = backend_->Decrypt(ciphertext, private_key);
+  if (!slots.ok()) return slots.status();
+  return Unpack(*slots);
+}
+
+absl::StatusOr<Ciphertext> SlotPacking::Rotate(const Ciphertext& ciphertext,
+                                               int positions) const {
+  const int d = message_degree_;
+  const int k = ((positions % d) + d) % d;
+  if (k == 0) return ciphertext;
+
+  // Offset o of each block reads o − k: from Rotate(c, k) when o ≥ k, and
+  // from Rotate(c, k − d) (the same block, wrapped) when o < k. With M the
+  // mask of offsets ≥ k: result = wrapped + M ⊙ (shifted − wrapped).
+  auto rotated = backend_->RotateHoisted(ciphertext, {k, k - d});
+  if (!rotated.ok()) return rotated.status();
+  const Ciphertext& shifted = (*rotated)[0];
+  const Ciphertext& wrapped = (*rotated)[1];
+
+  auto mask = RotationMask(k);
+  if (!mask.ok()) return mask.status();
+
+  auto difference = backend_->Subtract(shifted, wrapped);
+  if (!difference.ok()) return difference.status();
+  auto masked = backend_->MultiplyPlain(*difference, *mask);
+  if (!masked.ok()) return masked.status();
+  return backend_->Add(wrapped, *masked);
+}
+
+RotationKeySet SlotPacking::Rotations(
+    const std::vector<int>& positions) const {
+  const int d = message_degree_;
+  RotationKeySet set(num_slots());
+  for (int p : positions) {
+    const int k = ((p % d) + d) % d;
+    if (k == 0) continue;
+    set.Add(k).Add(k - d);
+  }
+  return set;
+}
+
+absl::StatusOr<Ciphertext> SlotPacking::Extract(const Ciphertext& ciphertext,
+                                                int block) const {
+  absl::Status status = CheckBlock(block);
+  if (!status.ok()) return status;
+  return backend_->MultiplyPlain(ciphertext, block_masks_[block]);
+}
+
+absl::StatusOr<Ciphertext> SlotPacking::Move(const Ciphertext& ciphertext,
+                                             int from, int to) const {
+  absl::Status status = CheckBlock(to);
+  if (!status.ok()) return status;
+  auto extracted = Extract(ciphertext, from);
+  if (!extracted.ok()) return extracted.status();
+  if (from == to) return extracted;
+  return backend_->Rotate(*extracted, (to - from) * message_degree_);
+}
+
+absl::StatusOr<Plaintext> SlotPacking::RotationMask(int k) const {
+  {
+    absl::MutexLock lock(&rotation_masks_->mu);
+    if (rotation_masks_->masks[k] != nullptr) return rotation_masks_->masks[k];
+  }
+  // Encode outside the lock; a concurrent miss encodes the same mask and
+  // the first one stored wins.
+  std::vector<int64_t> mask(num_slots(), 0);
+  for (int s = 0; s < num_slots(); ++s) {
+    mask[s] = s % message_degree_ >= k ? 1 : 0;
+  }
+  auto encoded = backend_->EncodePlaintext(mask);
+  if (!encoded.ok()) return encoded.status();
+  absl::MutexLock lock(&rotation_masks_->mu);
+  Plaintext& cached = rotation_masks_->masks[k];
+  if (cached == nullptr) cached = *std::move(encoded);
+  return cached;
+}
+
+absl::Status SlotPacking::CheckBlock(int block) const {
+  if (block < 0 || block >= capacity_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid block: %d (must be 0 to %d)", block, capacity_ - 1));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace f2chat
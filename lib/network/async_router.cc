@@ -0,0 +1,110 @@
+// lib/network/async_router.cc
+#include "lib/network/async_router.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace f2chat {
+
+AsyncRouter::AsyncRouter(const SheafRouter& router,
+                         const AsyncRouterOptions& options)
+    : router_(router),
+      options_(options),
+      executor_(Executor::OrDefault(options.executor)) {
+  options_.max_batch = std::max<size_t>(1, options_.max_batch);
+}
+
+Task<absl::StatusOr<Polynomial>> AsyncRouter::RouteAsync(
+    Polynomial message, Polynomial source_id, Polynomial dest_id,
+    CancellationToken token) {
+  if (auto status = token.Check(); !status.ok()) {
+    co_return status;
+  }
+  absl::StatusOr<Polynomial> result;
+  co_await BatchAwaiter{
+      this, {&message, &source_id, &dest_id, &token, &result, nullptr}};
+  if (result.ok()) {
+    // The route may have finished after the caller's deadline.
+    if (auto status = token.Check(); !status.ok()) {
+      co_return status;
+    }
+  }
+  co_return result;
+}
+
+void AsyncRouter::Enqueue(const Pending& pending) {
+  bool schedule = false;
+  {
+    absl::MutexLock lock(&mu_);
+    pending_.push_back(pending);
+    if (!flush_scheduled_) {
+      flush_scheduled_ = true;
+      schedule = true;
+    }
+  }
+  if (schedule) {
+    executor_.Schedule([this] { Flush(); });
+  }
+}
+
+void AsyncRouter::Flush() {
+  std::vector<Pending> batch;
+  bool more = false;
+  {
+    absl::MutexLock lock(&mu_);
+    const size_t size = std::min(options_.max_batch, pending_.size());
+    batch.assign(pending_.begin(), pending_.begin() + size);
+    pending_.erase(pending_.begin(), pending_.begin() + size);
+    // Leftovers get their own flush; new arrivals open a new batch.
+    flush_scheduled_ = more = !pending_.empty();
+  }
+  if (more) {
+    executor_.Schedule([this] { Flush(); });
+  }
+
+  // Shed routes whose caller gave up while they waited.
+  std::vector<Pending> live;
+  std::vector<Polynomial> messages, sources, dests;
+  live.reserve(batch.size());
+  for (const Pending& pending : batch) {
+    if (auto status = pending.token->Check(); !status.ok()) {
+      *pending.result = status;
+      continue;
+    }
+    live.push_back(pending);
+    messages.push_back(*pending.message);
+    sources.push_back(*pending.source_id);
+    dests.push_back(*pending.dest_id);
+  }
+
+  if (!live.empty()) {
+    auto routed = router_.RouteBatch(messages, sources, dests);
+    for (size_t i = 0; i < live.size(); ++i) {
+      *live[i].result = routed.ok()
+          ? absl::StatusOr<Polynomial>(std::move((*routed)[i]))
+          : absl::StatusOr<Polynomial>(routed.status());
+    }
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    batches_ += live.empty() ? 0 : 1;
+    shed_ += static_cast<int64_t>(batch.size() - live.size());
+  }
+
+  // Resume on the pool so one flush does not run every continuation.
+  for (const Pending& pending : batch) {
+    executor_.Schedule([waiter = pending.waiter] { waiter.resume(); });
+  }
+}
+
+int64_t AsyncRouter::batches() const {
+  absl::MutexLock lock(&mu_);
+  return batches_;
+}
+
+int64_t AsyncRouter::shed() const {
+  absl::MutexLock lock(&mu_);
+  return shed_;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,126 @@
+// lib/network/async_router.h
+//
+// Coroutine routing front end: many in-flight routes, batched kernels.
+//
+// SheafRouter::Route blocks its thread for the whole patch traversal.
+// AsyncRouter::RouteAsync returns a Task that, when awaited, enqueues the
+// route and suspends at the batch boundary. Pending routes are drained
+// by flush tasks on the executor, which route whole batches with
+// SheafRouter::RouteBatch and resume each waiting coroutine with its
+// result:
+//
+//   coroutine ─▶ co_await RouteAsync ─▶ [pending batch] ─▶ flush task
+//        ▲                                                  │ RouteBatch
+//        └────────────── resumed with StatusOr ◀────────────┘
+//
+// A flush is scheduled as soon as a batch opens, so routes arriving while
+// it waits in the executor queue join the same batch (no timer, no added
+// latency when idle). Every route carries a CancellationToken: cancelled
+// or overdue routes are dropped at the flush instead of routed.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_ASYNC_ROUTER_H_
+#define F2CHAT_LIB_NETWORK_ASYNC_ROUTER_H_
+
+#include <coroutine>
+#include <cstdint>
+#include <vector>
+#include "lib/crypto/polynomial.h"
+#include "lib/network/sheaf_router.h"
+#include "lib/runtime/cancellation.h"
+#include "lib/runtime/executor.h"
+#include "lib/runtime/task.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+
+namespace f2chat {
+
+// Batching behavior.
+struct AsyncRouterOptions {
+  // Routes per RouteBatch call; a larger backlog is split over several
+  // flush tasks.
+  size_t max_batch = 256;
+
+  // Pool running flushes and resuming coroutines (nullptr =
+  // Executor::Default()). Not owned; must outlive the AsyncRouter.
+  Executor* executor = nullptr;
+};
+
+// Asynchronous router over a SheafRouter's published weights.
+//
+// Thread Safety: RouteAsync tasks may be created and awaited from any
+// thread. The SheafRouter must outlive the AsyncRouter, and the
+// AsyncRouter must outlive every route awaited on it.
+class AsyncRouter {
+ public:
+  explicit AsyncRouter(const SheafRouter& router,
+                       const AsyncRouterOptions& options = {});
+
+  AsyncRouter(const AsyncRouter&) = delete;
+  AsyncRouter& operator=(const AsyncRouter&) = delete;
+
+  // Routes one message (same result as SheafRouter::Route).
+  //
+  // Arguments are copied into the coroutine frame. The awaiting coroutine
+  // resumes on an executor thread.
+  //
+  // Returns:
+  //   Routed polynomial, or Route's errors
+  //   Cancelled / DeadlineExceeded if `token` fails before the route
+  //   is batched or after it completes
+  //
+  // Performance: one suspension; the routing work is shared by the batch
+  Task<absl::StatusOr<Polynomial>> RouteAsync(
+      Polynomial message, Polynomial source_id, Polynomial dest_id,
+      CancellationToken token = {});
+
+  // RouteBatch calls made so far.
+  int64_t batches() const;
+
+  // Routes dropped at a flush because their token had failed.
+  int64_t shed() const;
+
+ private:
+  // A suspended route waiting for its batch.
+  struct Pending {
+    const Polynomial* message;
+    const Polynomial* source_id;
+    const Polynomial* dest_id;
+    const CancellationToken* token;
+    absl::StatusOr<Polynomial>* result;
+    std::coroutine_handle<> waiter;
+  };
+
+  // Awaiter that enqueues a route and suspends until its batch is done.
+  struct BatchAwaiter {
+    AsyncRouter* router;
+    Pending pending;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+      pending.waiter = handle;
+      router->Enqueue(pending);
+    }
+    void await_resume() const noexcept {}
+  };
+
+  void Enqueue(const Pending& pending);
+
+  // Routes up to max_batch pending routes and resumes their coroutines.
+  void Flush();
+
+  const SheafRouter& router_;
+  AsyncRouterOptions options_;
+  Executor& executor_;
+
+  mutable absl::Mutex mu_;
+  std::vector<Pending> pending_ ABSL_GUARDED_BY(mu_);
+  bool flush_scheduled_ ABSL_GUARDED_BY(mu_) = false;
+  int64_t batches_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t shed_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_ASYNC_ROUTER_H_
@@ -0,0 +1,121 @@
+// lib/network/encrypted_routing.cc
+//
+// Implementation of encrypted local routing.
+
+#include "lib/network/encrypted_routing.h"
+
+#include <cmath>
+#include <map>
+#include <utility>
+#include "lib/crypto/character_transform.h"
+#include "lib/crypto/ntt.h"
+#include "absl/strings/str_format.h"
+
+namespace f2chat {
+
+absl::StatusOr<LinearTransform> CompileEncryptedRouting(
+    const RoutingOperator& op, double weight_scale, int degree) {
+  const int d = degree;
+  const int k = RingParams::kNumCharacters;
+  const uint64_t p = RingParams::kModulus;
+  if (d <= 0 || (d & (d - 1)) != 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Degree must be a power of two, got %d", d));
+  }
+  std::map<int, std::vector<int64_t>> diagonals;
+
+  // Mirrors RoutingOperator::Apply: mismatched weights are the identity.
+  if (op.num_characters() != k) {
+    diagonals.emplace(0, std::vector<int64_t>(d, 1));
+    return LinearTransform::FromDiagonals(d, std::move(diagonals));
+  }
+  auto characters = CharacterTransform::Create(k);
+  if (!characters.ok()) return characters.status();
+
+  std::vector<uint64_t> scaled(k);
+  for (int r = 0; r < op.num_positions() && r < d; ++r) {
+    for (int j = 0; j < k; ++j) {
+      scaled[j] = ReduceSigned(
+          static_cast<int64_t>(std::llround(weight_scale * op.weight(r, j))),
+          p);
+    }
+    // Row r: M[r][(r·k + m) mod d] = Σⱼ ŵ[r][j] · k⁻¹ω^(−jm).
+    for (int m = 0; m < k; ++m) {
+      uint64_t entry = 0;
+      for (int j = 0; j < k; ++j) {
+        entry = AddMod(entry, MulMod(scaled[j], characters->weight(j, m), p),
+                       p);
+      }
+      const int column = static_cast<int>((int64_t{r} * k + m) % d);
+      std::vector<int64_t>& diagonal = diagonals[(column - r + d) % d];
+      if (diagonal.empty()) diagonal.resize(d, 0);
+      diagonal[r] = static_cast<int64_t>(AddMod(diagonal[r], entry, p));
+    }
+  }
+  return LinearTransform::FromDiagonals(d, std::move(diagonals));
+}
+
+EncryptedRouting::EncryptedRouting(const FheBackend& backend,
+                                   double weight_scale)
+    : backend_(backend), weight_scale_(weight_scale) {}
+
+RotationKeySet EncryptedRouting::Rotations(int degree) {
+  return RotationKeySet::BabyStepGiantStep(degree, degree,
+                                           BabyStepCount(degree));
+}
+
+int64_t EncryptedRouting::encodings() const {
+  absl::MutexLock lock(&mu_);
+  return encodings_;
+}
+
+absl::StatusOr<std::shared_ptr<const EncodedLinearTransform>>
+EncryptedRouting::Encoded(const RoutingTable& table, size_t patch) const {
+  {
+    absl::MutexLock lock(&mu_);
+    if (table.version > version_ ||
+        (table.version == version_ &&
+         cache_.size() != table.operators.size())) {
+      version_ = table.version;
+      cache_.assign(table.operators.size(), nullptr);
+    }
+    if (table.version == version_ && cache_[patch] != nullptr) {
+      return cache_[patch];
+    }
+  }
+
+  auto transform = CompileEncryptedRouting(
+      table.operators[patch], weight_scale_, backend_.message_degree());
+  if (!transform.ok()) return transform.status();
+  auto encoded = transform->Encode(backend_);
+  if (!encoded.ok()) return encoded.status();
+  auto shared =
+      std::make_shared<const EncodedLinearTransform>(*std::move(encoded));
+
+  absl::MutexLock lock(&mu_);
+  ++encodings_;
+  // Tables older than the cached version are served uncached.
+  if (table.version == version_ && cache_.size() > patch) {
+    cache_[patch] = shared;
+  }
+  return shared;
+}
+
+absl::StatusOr<Ciphertext> EncryptedRouting::Apply(
+    const RoutingTable& table, size_t patch, const Ciphertext& input) const {
+  if (patch >= table.operators.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid patch index: %d (table has %d operators)", patch,
+        table.operators.size()));
+  }
+  if (table.operators[patch].basis() != WeightBasis::kFpCharacters) {
+    return absl::FailedPreconditionError(
+        "Routing weights were fit on rounded projections; encrypted routing "
+        "needs weights fit on the F_p characters (SolverOptions::weight_basis)");
+  }
+  auto encoded = Encoded(table, patch);
+  if (!encoded.ok()) return encoded.status();
+  return (*encoded)->Apply(input);
+}
+
+}  // namespace f2chat
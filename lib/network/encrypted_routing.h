@@ -0,0 +1,120 @@
+// lib/network/encrypted_routing.h
+//
+// Local routing φₚ on encrypted polynomials.
+//
+// Operators in WeightBasis::kFpCharacters (a SheafRouter created with
+// SolverOptions::weight_basis = kFpCharacters) weigh the exact F_p
+// characters yⱼ of CharacterTransform. With fixed-point weights
+// ŵ[r][j] = round(scale · w[r][j]) mod p, encrypted routing evaluates
+//   output[r] = Σⱼ ŵ[r][j] · yⱼ[(r·k) mod d],   r < num_positions
+// (slot r reads the window starting at r·k, as in RoutingOperator::Apply).
+// That is linear in the input, so each operator compiles to a d×d matrix
+// over F_p and is evaluated with the Halevi–Shoup diagonal method
+// (LinearTransform).
+//
+// Decrypted outputs carry the factor `scale`: they equal
+// scale · Apply(c) mod p when the weights are integers, and otherwise
+// differ by the fixed-point rounding of the weights times the projections.
+// Weights in kRoundedProjections multiply rounded real projections, which
+// BGV cannot evaluate, and are rejected.
+//
+// Key Properties:
+// - One operator: O(√d) key switches (g + d/g − 2 for g = BabyStepCount(d))
+//   and one plaintext product per non-zero diagonal
+// - Encoded diagonals are cached per operator and routing table version;
+//   a newer table version drops the cache and is encoded on first use
+// - Weights with k ≠ kNumCharacters leave the input unchanged, as in
+//   RoutingOperator::Apply
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_ENCRYPTED_ROUTING_H_
+#define F2CHAT_LIB_NETWORK_ENCRYPTED_ROUTING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "lib/crypto/fhe_backend.h"
+#include "lib/crypto/linear_transform.h"
+#include "lib/crypto/polynomial_params.h"
+#include "lib/crypto/rotation_keys.h"
+#include "lib/network/routing_operator.h"
+#include "lib/network/routing_table.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+
+namespace f2chat {
+
+// Compiles the F_p-character map of `op` (see file comment; op's weights
+// are read as kFpCharacters weights) into a matrix on d-coefficient
+// messages.
+//
+// Args:
+//   op: Compiled routing operator
+//   weight_scale: Fixed-point scale of the weights (e.g. 1000)
+//   degree: Message degree d
+//
+// Returns:
+//   Linear transform (identity if op has the wrong character count)
+//   InvalidArgument if the degree is not a power of two
+absl::StatusOr<LinearTransform> CompileEncryptedRouting(
+    const RoutingOperator& op, double weight_scale,
+    int degree = RingParams::kDegree);
+
+// Applies a routing table's operators to ciphertexts.
+//
+// Thread Safety: Apply is thread-safe; encoding a missing operator happens
+// outside the lock.
+class EncryptedRouting {
+ public:
+  // Args:
+  //   backend: Backend of the ciphertexts (must outlive this object)
+  //   weight_scale: Fixed-point scale of the weights
+  EncryptedRouting(const FheBackend& backend, double weight_scale);
+
+  EncryptedRouting(const EncryptedRouting&) = delete;
+  EncryptedRouting& operator=(const EncryptedRouting&) = delete;
+
+  // Enc(c) → Enc(scale · output) for operator `patch` of `table`, with
+  // output the F_p-character map of the file comment.
+  //
+  // Tables are told apart by RoutingTable::version, so `table` should be
+  // published (VersionedRoutingTable::Publish); tables older than the
+  // newest one seen are encoded per call and not cached.
+  //
+  // Returns:
+  //   Routed ciphertext
+  //   InvalidArgument if `patch` is out of range
+  //   FailedPrecondition if the operator is not in
+  //   WeightBasis::kFpCharacters, or the key pair lacks Rotations()
+  absl::StatusOr<Ciphertext> Apply(const RoutingTable& table, size_t patch,
+                                   const Ciphertext& input) const;
+
+  // Rotations every operator may need: RotationKeySet::BabyStepGiantStep
+  // over all d diagonals.
+  static RotationKeySet Rotations(int degree = RingParams::kDegree);
+
+  // Operators encoded so far (cache misses).
+  int64_t encodings() const;
+
+ private:
+  absl::StatusOr<std::shared_ptr<const EncodedLinearTransform>> Encoded(
+      const RoutingTable& table, size_t patch) const;
+
+  const FheBackend& backend_;
+  double weight_scale_;
+
+  mutable absl::Mutex mu_;
+  mutable uint64_t version_ ABSL_GUARDED_BY(mu_) = 0;
+  // Encoded operators of table `version_` (null until first use).
+  mutable std::vector<std::shared_ptr<const EncodedLinearTransform>> cache_
+      ABSL_GUARDED_BY(mu_);
+  mutable int64_t encodings_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_ENCRYPTED_ROUTING_H_
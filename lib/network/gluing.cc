@@ -1,30 +1,90 @@
 // lib/network/gluing.cc
 #include "lib/network/gluing.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace f2chat {
 
+namespace {
+// Coefficients per early-exit block (one vectorizable inner loop).
+constexpr int kBlock = 16;
+}  // namespace
+
 bool GluingConstraint::Verify(
     const Polynomial& routed_poly,
     double tolerance) const {
   // Check: routed_poly ≈ boundary_poly
-  auto routed_coeffs = routed_poly.Decode();
-  auto boundary_coeffs = boundary_poly.Decode();
+  return GluingVerifier(tolerance).Within(routed_poly, boundary_poly);
+}
 
-  if (routed_coeffs.size() != boundary_coeffs.size()) {
-    return false;
+bool GluingConstraint::VerifyAgreement(
+    const Polynomial& routed_1,
+    const Polynomial& routed_2,
+    double tolerance) const {
+  // Check: φ₁(boundary_poly) ≈ φ₂(boundary_poly)
+  return GluingVerifier(tolerance).Within(routed_1, routed_2);
+}
+
+GluingVerifier::GluingVerifier(double tolerance) {
+  // distance < tolerance  ⇔  squared distance ≤ ⌈tolerance²⌉ − 1 (integers)
+  double squared = tolerance * tolerance;
+  limit_ = tolerance <= 0.0 ? -1
+         : squared >= 9.0e18 ? std::numeric_limits<int64_t>::max()
+                             : static_cast<int64_t>(std::ceil(squared)) - 1;
+}
+
+int64_t GluingVerifier::ModDistanceSquared(
+    const Polynomial& a, const Polynomial& b, int64_t limit) {
+  const auto& a_coeffs = a.coefficients();
+  const auto& b_coeffs = b.coefficients();
+  const int64_t p = RingParams::kModulus;
+  const int n = static_cast<int>(std::min(a_coeffs.size(), b_coeffs.size()));
+  const int64_t* x = a_coeffs.data();
+  const int64_t* y = b_coeffs.data();
+
+  int64_t total = 0;
+  int i = 0;
+  for (; i + kBlock <= n; i += kBlock) {
+    // Coefficients are reduced to [0, p), so a − b ∈ (−p, p).
+    int64_t block = 0;
+    for (int t = 0; t < kBlock; ++t) {
+      int64_t d = x[i + t] - y[i + t];
+      d = d < 0 ? -d : d;
+      d = std::min(d, p - d);
+      block += d * d;
+    }
+    total += block;
+    if (total > limit) return total;  // Early exit
   }
+  for (; i < n; ++i) {
+    int64_t d = x[i] - y[i];
+    d = d < 0 ? -d : d;
+    d = std::min(d, p - d);
+    total += d * d;
+  }
+  return total;
+}
 
-  // Compute L2 error
-  double error = 0.0;
-  for (size_t i = 0; i < routed_coeffs.size(); ++i) {
-    double diff = static_cast<double>(routed_coeffs[i] - boundary_coeffs[i]);
-    error += diff * diff;
+bool GluingVerifier::Within(
+    const Polynomial& routed, const Polynomial& reference) const {
+  if (routed.coefficients().size() != reference.coefficients().size()) {
+    return false;
   }
-  error = std::sqrt(error);
+  return limit_ >= 0 && ModDistanceSquared(routed, reference, limit_) <= limit_;
+}
 
-  return error < tolerance;
+std::vector<int64_t> GluingVerifier::Verify(
+    const std::vector<Check>& checks, size_t num_constraints) const {
+  std::vector<int64_t> violations(num_constraints, 0);
+  for (const Check& check : checks) {
+    if (check.constraint >= num_constraints) continue;
+    if (!Within(*check.routed, *check.reference)) {
+      ++violations[check.constraint];
+    }
+  }
+  return violations;
 }
 
 GluingConstraint GluingConstraintBuilder::CreateContinuity(
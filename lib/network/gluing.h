@@ -57,7 +57,8 @@ struct GluingConstraint {
 
   // Verifies that routing satisfies this gluing constraint.
   //
-  // Checks: φ₂(φ₁(boundary_poly)) ≈ boundary_poly (within tolerance)
+  // Checks: φ₂(φ₁(boundary_poly)) ≈ boundary_poly (within tolerance, using
+  // the mod-p distance of GluingVerifier)
   //
   // Args:
   //   routed_poly: Result of applying φ₂ ∘ φ₁
@@ -66,6 +67,72 @@ struct GluingConstraint {
   // Returns:
   //   true if constraint satisfied, false otherwise
   bool Verify(const Polynomial& routed_poly, double tolerance = 1e-6) const;
+
+  // Verifies the learned form of this constraint: both patches route the
+  // boundary identically.
+  //
+  // Checks: φ₁(boundary_poly) ≈ φ₂(boundary_poly) (within tolerance)
+  //
+  // This depends only on the weights, so SheafRouter checks it once per
+  // published weight set instead of per message.
+  //
+  // Args:
+  //   routed_1: φ₁(boundary_poly)
+  //   routed_2: φ₂(boundary_poly)
+  //   tolerance: Allowed mod-p L2 error
+  //
+  // Returns:
+  //   true if both routings agree on the boundary
+  bool VerifyAgreement(
+      const Polynomial& routed_1,
+      const Polynomial& routed_2,
+      double tolerance = 1e-6) const;
+};
+
+// Gluing verifier.
+//
+// Distances are mod-p aware: coefficients live in Z_p, so the per-slot
+// difference is min(|a − b| mod p, p − |a − b| mod p) (0 and p − 1 are one
+// apart, not p − 1). Squared distances accumulate exactly in int64 over
+// fixed-size coefficient blocks (branch-free, auto-vectorized), and a check
+// stops at the first block that already exceeds the tolerance.
+//
+// Thread Safety: Immutable after construction (thread-safe).
+class GluingVerifier {
+ public:
+  // One comparison: `routed` must be within tolerance of `reference`.
+  struct Check {
+    size_t constraint = 0;                // Index of the gluing checked
+    const Polynomial* routed = nullptr;
+    const Polynomial* reference = nullptr;  // Boundary, or the other φ
+  };
+
+  // Args:
+  //   tolerance: Maximum mod-p L2 distance (a check passes if < tolerance)
+  explicit GluingVerifier(double tolerance = 1e-6);
+
+  // Runs every check (one Within() each) and counts the failures per
+  // constraint.
+  //
+  // Returns:
+  //   Violation count per constraint (size num_constraints); checks with
+  //   constraint >= num_constraints are ignored
+  //
+  // Performance: O(checks * n) worst case, less with early exit
+  std::vector<int64_t> Verify(
+      const std::vector<Check>& checks, size_t num_constraints) const;
+
+  // Single comparison (same distance and tolerance as Verify).
+  bool Within(const Polynomial& routed, const Polynomial& reference) const;
+
+  // Squared mod-p L2 distance, stopping early once it exceeds `limit`
+  // (the returned value is then some number > limit).
+  static int64_t ModDistanceSquared(
+      const Polynomial& a, const Polynomial& b, int64_t limit);
+
+ private:
+  // Largest squared distance that still passes (distance < tolerance).
+  int64_t limit_;
 };
 
 // Builder for gluing constraints.
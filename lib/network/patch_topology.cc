@@ -0,0 +1,129 @@
+// lib/network/patch_topology.cc
+#include "lib/network/patch_topology.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+
+namespace f2chat {
+
+namespace {
+// `*shared` for writing, copied first if another topology copy holds it.
+// Owners are only added by copying this topology (the writer), so a count
+// of 1 cannot rise concurrently; the fence orders our writes after the
+// reads of copies that released it.
+template <typename T>
+T& Unshared(std::shared_ptr<T>& shared) {
+  if (shared.use_count() > 1) {
+    shared = std::make_shared<T>(*shared);
+  } else {
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  return *shared;
+}
+}  // namespace
+
+size_t PatchTopology::AddPatch() {
+  // Isolated vertex: no existing plan can pass through it.
+  Unshared(adjacency_).emplace_back();
+  plans_.push_back(nullptr);
+  return adjacency_->size() - 1;
+}
+
+void PatchTopology::AddEdge(size_t a, size_t b) {
+  if (a == b || a >= adjacency_->size() || b >= adjacency_->size()) {
+    return;
+  }
+  const auto& neighbors_a = (*adjacency_)[a];
+  if (std::binary_search(neighbors_a.begin(), neighbors_a.end(), b)) {
+    return;  // Parallel gluing: same edge
+  }
+  Adjacency& adjacency = Unshared(adjacency_);
+  auto& from_a = adjacency[a];
+  from_a.insert(std::lower_bound(from_a.begin(), from_a.end(), b), b);
+  auto& from_b = adjacency[b];
+  from_b.insert(std::lower_bound(from_b.begin(), from_b.end(), a), a);
+  ++num_edges_;
+
+  // The edge only becomes a BFS tree edge for sources that see its two
+  // ends at different depths (or see exactly one of them).
+  for (auto& plans : plans_) {
+    if (plans == nullptr) continue;
+    const auto& distance = plans->distance;
+    int da = a < distance.size() ? distance[a] : -1;
+    int db = b < distance.size() ? distance[b] : -1;
+    if (da != db) {
+      plans = nullptr;
+    }
+  }
+}
+
+void PatchTopology::AssignEndpoint(const Polynomial& endpoint, size_t patch) {
+  Unshared(endpoints_)[endpoint.coefficients()] = patch;
+}
+
+void PatchTopology::Refresh() {
+  for (size_t source = 0; source < plans_.size(); ++source) {
+    if (plans_[source] == nullptr) {
+      plans_[source] = BuildPlans(source);
+      ++sources_built_;
+    }
+  }
+}
+
+std::shared_ptr<const PatchTopology::SourcePlans> PatchTopology::BuildPlans(
+    size_t source) const {
+  const Adjacency& adjacency = *adjacency_;
+  const size_t n = adjacency.size();
+  auto plans = std::make_shared<SourcePlans>();
+  plans->distance.assign(n, -1);
+  plans->paths.resize(n);
+
+  std::deque<size_t> queue = {source};
+  plans->distance[source] = 0;
+  plans->paths[source] = {source};
+  while (!queue.empty()) {
+    size_t u = queue.front();
+    queue.pop_front();
+    for (size_t v : adjacency[u]) {
+      if (plans->distance[v] >= 0) continue;
+      plans->distance[v] = plans->distance[u] + 1;
+      // Parent's plan is final when it is dequeued: extend it by one hop.
+      plans->paths[v] = plans->paths[u];
+      plans->paths[v].push_back(v);
+      queue.push_back(v);
+    }
+  }
+  return plans;
+}
+
+std::optional<size_t> PatchTopology::PatchOf(const Polynomial& endpoint) const {
+  auto it = endpoints_->find(endpoint.coefficients());
+  if (it == endpoints_->end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+const std::vector<size_t>* PatchTopology::Plan(size_t source, size_t dest) const {
+  if (source >= plans_.size() || plans_[source] == nullptr) {
+    return nullptr;
+  }
+  const SourcePlans& plans = *plans_[source];
+  if (dest >= plans.distance.size() || plans.distance[dest] < 0) {
+    return nullptr;
+  }
+  return &plans.paths[dest];
+}
+
+const std::vector<size_t>* PatchTopology::PlanFor(
+    const Polynomial& source_id, const Polynomial& dest_id) const {
+  auto source = PatchOf(source_id);
+  auto dest = PatchOf(dest_id);
+  if (!source.has_value() || !dest.has_value()) {
+    return nullptr;
+  }
+  return Plan(*source, *dest);
+}
+
+}  // namespace f2chat
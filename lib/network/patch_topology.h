@@ -0,0 +1,121 @@
+// lib/network/patch_topology.h
+//
+// Patch adjacency graph and cached shortest-path routing plans.
+//
+// Patches are vertices; every gluing constraint is an (undirected) edge
+// between its two patches. A routing plan is the sequence of patches a
+// message crosses from the patch owning its source endpoint to the patch
+// owning its destination endpoint, i.e. a shortest path in hop count.
+//
+// Plans are precomputed for all pairs: one BFS per source patch yields
+// the plans to every destination. BFS visits neighbours in ascending
+// index order and keeps the first parent found, so plans are
+// deterministic. Topology changes invalidate incrementally:
+//
+//   - a new patch is an isolated vertex; existing plans stay valid
+//   - a new edge (u, v) can only change the BFS tree of source s if
+//     dist(s, u) ≠ dist(s, v) (an edge between two vertices at the same
+//     depth is never a tree edge), so only those sources are rebuilt
+//
+// Copies share everything that is expensive to duplicate: per-source plans
+// are immutable, and the adjacency lists and endpoint map are copied only
+// on the first write after a copy. Publishing a topology with each routing
+// table therefore copies one pointer per patch, and a later AddEdge or
+// AssignEndpoint copies only the structure it edits.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_PATCH_TOPOLOGY_H_
+#define F2CHAT_LIB_NETWORK_PATCH_TOPOLOGY_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "lib/crypto/polynomial.h"
+#include "absl/container/flat_hash_map.h"
+
+namespace f2chat {
+
+// Patch adjacency graph with an all-pairs plan cache.
+//
+// Thread Safety: Const methods are thread-safe; mutation requires
+// external synchronization (SheafRouter's writer lock).
+class PatchTopology {
+ public:
+  PatchTopology() = default;
+
+  // Adds an isolated patch.
+  //
+  // Returns:
+  //   Index of the new patch
+  size_t AddPatch();
+
+  // Adds the edge between two patches (no-op for self-loops and
+  // duplicate edges) and invalidates the plans it may change.
+  void AddEdge(size_t a, size_t b);
+
+  // Maps an endpoint id (source or destination polynomial) to the patch
+  // that owns it. Re-assigning an endpoint moves it.
+  void AssignEndpoint(const Polynomial& endpoint, size_t patch);
+
+  // Rebuilds invalidated plans.
+  //
+  // Performance: O(stale sources * (patches + edges + patches²))
+  void Refresh();
+
+  // Patch owning `endpoint`, if any.
+  std::optional<size_t> PatchOf(const Polynomial& endpoint) const;
+
+  // Shortest path from `source` to `dest` (both included, in routing
+  // order).
+  //
+  // Returns:
+  //   Plan, or nullptr if `dest` is unreachable or the source's plans are
+  //   stale (call Refresh first)
+  //
+  // Performance: O(1)
+  const std::vector<size_t>* Plan(size_t source, size_t dest) const;
+
+  // Plan between the patches owning two endpoints (nullptr if either
+  // endpoint is unassigned or no path exists).
+  const std::vector<size_t>* PlanFor(
+      const Polynomial& source_id, const Polynomial& dest_id) const;
+
+  size_t num_patches() const { return adjacency_->size(); }
+  size_t num_edges() const { return num_edges_; }
+
+  // Sorted neighbours of a patch.
+  const std::vector<size_t>& neighbors(size_t patch) const {
+    return (*adjacency_)[patch];
+  }
+
+  // Number of per-source BFS runs so far (incremental invalidation
+  // diagnostics).
+  int64_t sources_built() const { return sources_built_; }
+
+ private:
+  // BFS tree of one source: hop distances and the plan to every patch
+  // reachable at build time.
+  struct SourcePlans {
+    std::vector<int> distance;  // -1 = unreachable
+    std::vector<std::vector<size_t>> paths;
+  };
+
+  std::shared_ptr<const SourcePlans> BuildPlans(size_t source) const;
+
+  using Adjacency = std::vector<std::vector<size_t>>;
+  using EndpointMap = absl::flat_hash_map<std::vector<int64_t>, size_t>;
+
+  // Shared with copies; mutated through Unshared() (copy-on-write).
+  std::shared_ptr<Adjacency> adjacency_ = std::make_shared<Adjacency>();
+  size_t num_edges_ = 0;
+  std::vector<std::shared_ptr<const SourcePlans>> plans_;  // nullptr = stale
+  std::shared_ptr<EndpointMap> endpoints_ = std::make_shared<EndpointMap>();
+  int64_t sources_built_ = 0;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_PATCH_TOPOLOGY_H_
@@ -0,0 +1,161 @@
+// lib/network/routing_operator.cc
+#include "lib/network/routing_operator.h"
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include "lib/crypto/character_transform.h"
+#include "lib/crypto/ntt.h"
+
+namespace f2chat {
+
+RoutingOperator RoutingOperator::Compile(
+    const RoutingWeights& weights, WeightBasis basis) {
+  auto storage = std::make_shared<std::vector<double>>();
+  storage->reserve(
+      static_cast<size_t>(weights.num_positions()) * weights.num_characters());
+  for (const auto& row : weights.weights) {
+    storage->insert(storage->end(), row.begin(), row.end());
+  }
+
+  RoutingOperator op;
+  op.table_ = storage->data();
+  op.num_positions_ = weights.num_positions();
+  op.num_characters_ = weights.num_characters();
+  op.basis_ = basis;
+  op.owner_ = std::move(storage);
+  return op;
+}
+
+RoutingOperator RoutingOperator::View(
+    const double* table,
+    int num_positions,
+    int num_characters,
+    std::shared_ptr<const void> owner,
+    WeightBasis basis) {
+  RoutingOperator op;
+  op.table_ = table;
+  op.num_positions_ = num_positions;
+  op.num_characters_ = num_characters;
+  op.basis_ = basis;
+  op.owner_ = std::move(owner);
+  return op;
+}
+
+void RoutingOperator::CharacterValues(
+    WeightBasis basis, const int64_t* coefficients, int position,
+    double* values) {
+  const int n = RingParams::kDegree;
+  const int k = RingParams::kNumCharacters;
+  if (basis == WeightBasis::kFpCharacters) {
+    const CharacterTransform& characters = CharacterTransform::Default();
+    const int start = (position * k) % n;
+    for (int j = 0; j < k; ++j) {
+      values[j] = static_cast<double>(LiftCentered(
+          characters.ProjectSlot(coefficients, n, j, start),
+          RingParams::kModulus));
+    }
+    return;
+  }
+  for (int j = 0; j < k; ++j) {
+    values[j] = static_cast<double>(
+        Polynomial::ProjectWindow(coefficients, j, position));
+  }
+}
+
+Polynomial RoutingOperator::Apply(const Polynomial& input) const {
+  const int n = RingParams::kDegree;
+  const int k = RingParams::kNumCharacters;
+
+  // Mirrors ApplyRoutingWeights: mismatched weights leave input unchanged.
+  if (num_characters_ != k) {
+    return input;
+  }
+
+  // Window starts are multiples of gcd(k, n); cache projections per window.
+  const int stride = std::gcd(k, n);
+  std::vector<double> projections(static_cast<size_t>(n / stride) * k);
+  std::vector<bool> projected(n / stride, false);
+
+  std::vector<int64_t> result_coeffs(n, 0);
+  for (int p = 0; p < num_positions_ && p < n; ++p) {
+    int window = ((p * k) % n) / stride;
+    double* values = &projections[static_cast<size_t>(window) * k];
+    if (!projected[window]) {
+      CharacterValues(basis_, input.coefficients().data(), p, values);
+      projected[window] = true;
+    }
+
+    // Σⱼ w[p][j] * Proj_χⱼ(input)[p]
+    const double* row = table_ + static_cast<size_t>(p) * num_characters_;
+    double weighted_sum = 0.0;
+    for (int j = 0; j < k; ++j) {
+      weighted_sum += row[j] * values[j];
+    }
+    result_coeffs[p] = static_cast<int64_t>(std::round(weighted_sum));
+  }
+
+  return Polynomial(result_coeffs);
+}
+
+void RoutingOperator::ApplyBatch(
+    const PolynomialBatch& input, PolynomialBatch* output) const {
+  const int n = RingParams::kDegree;
+  const int k = RingParams::kNumCharacters;
+  const size_t batch = input.size();
+
+  if (num_characters_ != k) {
+    *output = input;
+    return;
+  }
+  output->Resize(batch);
+
+  // Same window cache as Apply, for every row: projections[window][row][j].
+  const int stride = std::gcd(k, n);
+  const size_t window_size = batch * k;
+  std::vector<double> projections((n / stride) * window_size);
+  std::vector<bool> projected(n / stride, false);
+
+  for (int p = 0; p < n; ++p) {
+    if (p >= num_positions_) {
+      for (size_t i = 0; i < batch; ++i) {
+        output->row(i)[p] = 0;
+      }
+      continue;
+    }
+
+    int window = ((p * k) % n) / stride;
+    double* values = &projections[window * window_size];
+    if (!projected[window]) {
+      for (size_t i = 0; i < batch; ++i) {
+        CharacterValues(basis_, input.row(i), p, &values[i * k]);
+      }
+      projected[window] = true;
+    }
+
+    // Σⱼ w[p][j] * Proj_χⱼ(input)[p], one weight row for the whole batch.
+    const double* row = table_ + static_cast<size_t>(p) * num_characters_;
+    for (size_t i = 0; i < batch; ++i) {
+      double weighted_sum = 0.0;
+      for (int j = 0; j < k; ++j) {
+        weighted_sum += row[j] * values[i * k + j];
+      }
+      int64_t coefficient =
+          static_cast<int64_t>(std::round(weighted_sum)) % RingParams::kModulus;
+      output->row(i)[p] =
+          coefficient < 0 ? coefficient + RingParams::kModulus : coefficient;
+    }
+  }
+}
+
+RoutingWeights RoutingOperator::ToWeights() const {
+  RoutingWeights weights;
+  weights.weights.resize(num_positions_);
+  for (int p = 0; p < num_positions_; ++p) {
+    const double* row = table_ + static_cast<size_t>(p) * num_characters_;
+    weights.weights[p].assign(row, row + num_characters_);
+  }
+  return weights;
+}
+
+}  // namespace f2chat
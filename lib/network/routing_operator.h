@@ -0,0 +1,112 @@
+// lib/network/routing_operator.h
+//
+// Compiled local routing operator φₚ.
+//
+// RoutingWeights stores one heap vector per position, and
+// RoutingPolynomial::ApplyRoutingWeights projects the input onto every
+// character over every slot (and copies each projection per position).
+// A RoutingOperator flattens the weights into one row-major
+// positions × characters table and evaluates only the projection values
+// the output needs: slot p reads the window starting at (p·k mod n), so
+// each distinct window is projected once.
+//
+// Weights multiply the character values of their WeightBasis:
+//
+//   - kRoundedProjections: the rounded real projections of
+//     RoutingPolynomial::ApplyRoutingWeights (default)
+//   - kFpCharacters: the exact F_p projections yⱼ of CharacterTransform,
+//     lifted to (−p/2, p/2], so output[p] = round(Σⱼ w[p][j]·ỹⱼ[(p·k) mod n]).
+//     Being linear mod p, this map can be evaluated on ciphertexts
+//     (EncryptedRouting)
+//
+// The table is either owned or borrowed (e.g. from a memory-mapped
+// RoutingSnapshot); operators are cheap to copy and share their table.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_ROUTING_OPERATOR_H_
+#define F2CHAT_LIB_NETWORK_ROUTING_OPERATOR_H_
+
+#include <memory>
+#include "lib/crypto/polynomial.h"
+#include "lib/crypto/polynomial_batch.h"
+#include "lib/crypto/routing_polynomial.h"
+
+namespace f2chat {
+
+// Compiled routing operator (flat weight table).
+//
+// Thread Safety: Immutable after construction; Apply is thread-safe.
+class RoutingOperator {
+ public:
+  // Compiles weights (fit in `basis`) into an owned flat table.
+  static RoutingOperator Compile(
+      const RoutingWeights& weights,
+      WeightBasis basis = WeightBasis::kRoundedProjections);
+
+  // Wraps an existing row-major table without copying.
+  //
+  // Args:
+  //   table: num_positions × num_characters doubles (row-major)
+  //   owner: Keeps the table's storage alive (e.g. a file mapping)
+  //   basis: Character values the weights were fit on
+  static RoutingOperator View(
+      const double* table,
+      int num_positions,
+      int num_characters,
+      std::shared_ptr<const void> owner,
+      WeightBasis basis = WeightBasis::kRoundedProjections);
+
+  // Character values output position `position` weighs: the
+  // kNumCharacters projections in `basis` of the window starting at
+  // (position·k mod n) of `coefficients` (kDegree values in [0, p)).
+  // SheafSystem trains on the same values.
+  //
+  // Performance: O(k²)
+  static void CharacterValues(WeightBasis basis, const int64_t* coefficients,
+                              int position, double* values);
+
+  RoutingOperator() = default;
+
+  // Applies φₚ (for kRoundedProjections, the same result as
+  // RoutingPolynomial::ApplyRoutingWeights).
+  //
+  // Performance: O(n * k) (one projection per distinct window and
+  // character, one k-term dot product per position)
+  Polynomial Apply(const Polynomial& input) const;
+
+  // Applies φₚ to every row of a batch (row i of `output` = Apply(row i
+  // of `input`)). Each window is projected once per row and each weight
+  // row is reused across the whole batch. `output` is resized to match
+  // and must not alias `input`.
+  //
+  // Performance: O(batch * n * k)
+  void ApplyBatch(const PolynomialBatch& input, PolynomialBatch* output) const;
+
+  // Weight w[p][j].
+  double weight(int position, int character) const {
+    return table_[position * num_characters_ + character];
+  }
+
+  int num_positions() const { return num_positions_; }
+  int num_characters() const { return num_characters_; }
+  WeightBasis basis() const { return basis_; }
+
+  // Row-major table (num_positions × num_characters).
+  const double* table() const { return table_; }
+
+  // Expands back to nested RoutingWeights.
+  RoutingWeights ToWeights() const;
+
+ private:
+  const double* table_ = nullptr;
+  int num_positions_ = 0;
+  int num_characters_ = 0;
+  WeightBasis basis_ = WeightBasis::kRoundedProjections;
+  std::shared_ptr<const void> owner_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_ROUTING_OPERATOR_H_
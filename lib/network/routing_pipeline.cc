@@ -0,0 +1,195 @@
+// lib/network/routing_pipeline.cc
+#include "lib/network/routing_pipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include "lib/crypto/routing_polynomial.h"
+#include "lib/runtime/cpu_affinity.h"
+#include "absl/strings/str_cat.h"
+
+namespace f2chat {
+
+namespace {
+// Spin briefly, then back off so idle stages do not hold a core.
+class Backoff {
+ public:
+  void Idle() {
+    if (++spins_ < 64) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+  }
+  void Reset() { spins_ = 0; }
+
+ private:
+  int spins_ = 0;
+};
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<RoutingPipeline>> RoutingPipeline::Create(
+    const SheafRouter& router, const PipelineOptions& options) {
+  if (options.batch_size == 0 || options.ring_capacity == 0) {
+    return absl::InvalidArgumentError(
+        "Pipeline batch size and ring capacity must be positive");
+  }
+  if (options.num_stages < 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid number of pipeline stages: ", options.num_stages));
+  }
+
+  int num_stages = options.num_stages;
+  if (num_stages == 0) {
+    auto table = router.routing_table();
+    if (table == nullptr) {
+      return absl::FailedPreconditionError(
+          "No routing weights learned. Call LearnRouting() first.");
+    }
+    num_stages =
+        std::clamp(static_cast<int>(table->operators.size()), 1, NumCores());
+  }
+  return std::unique_ptr<RoutingPipeline>(
+      new RoutingPipeline(router, options, num_stages));
+}
+
+RoutingPipeline::RoutingPipeline(
+    const SheafRouter& router, const PipelineOptions& options, int num_stages)
+    : router_(router), options_(options) {
+  for (int i = 0; i <= num_stages; ++i) {
+    rings_.push_back(std::make_unique<Ring>(options_.ring_capacity));
+  }
+  for (int i = 0; i < num_stages; ++i) {
+    stages_.emplace_back(&RoutingPipeline::RunStage, this, i);
+    if (options_.pin_stages) {
+      PinThreadToCore(stages_.back(), (options_.first_core + i) % NumCores());
+    }
+  }
+}
+
+RoutingPipeline::~RoutingPipeline() {
+  stop_.store(true, std::memory_order_release);
+  for (auto& stage : stages_) {
+    stage.join();
+  }
+}
+
+void RoutingPipeline::ApplyStage(int stage, Batch& batch) const {
+  const size_t size = batch.messages.size();
+  if (stage == 0) {
+    // Same plan lookup as SheafRouter::Route.
+    const PatchTopology* topology = batch.table->topology.get();
+    batch.plans.assign(size, nullptr);
+    batch.next_steps.assign(size, 0);
+    for (size_t i = 0; i < size; ++i) {
+      const RouteRequest& request = batch.requests[batch.begin + i];
+      batch.messages[i] = RoutingPolynomial::EncodeRoute(
+          request.source_id, request.dest_id, request.message);
+      if (topology != nullptr) {
+        batch.plans[i] = topology->PlanFor(request.source_id, request.dest_id);
+      }
+    }
+  }
+
+  // Contiguous patch group [first, last) of this stage, read from the
+  // replica on the stage thread's node.
+  const auto& operators = batch.table->LocalOperators();
+  const size_t num_stages = stages_.size();
+  const size_t first = stage * operators.size() / num_stages;
+  const size_t last = (stage + 1) * operators.size() / num_stages;
+  const bool last_stage = static_cast<size_t>(stage) + 1 == num_stages;
+  for (size_t i = 0; i < size; ++i) {
+    const std::vector<size_t>* plan = batch.plans[i];
+    const size_t length = plan != nullptr ? plan->size() : operators.size();
+    size_t& step = batch.next_steps[i];
+    for (; step < length; ++step) {
+      const size_t patch = plan != nullptr ? (*plan)[step] : step;
+      if (!last_stage && (patch < first || patch >= last)) {
+        break;  // A later stage owns it (or the last stage, if earlier)
+      }
+      batch.messages[i] = operators[patch].Apply(batch.messages[i]);
+    }
+  }
+}
+
+void RoutingPipeline::RunStage(int stage) {
+  Ring& in = *rings_[stage];
+  Ring& out = *rings_[stage + 1];
+  Backoff backoff;
+  Batch batch;
+  while (!stop_.load(std::memory_order_acquire)) {
+    if (!in.TryPop(batch)) {
+      backoff.Idle();
+      continue;
+    }
+    backoff.Reset();
+    ApplyStage(stage, batch);
+    while (!out.TryPush(std::move(batch))) {
+      if (stop_.load(std::memory_order_acquire)) return;
+      backoff.Idle();
+    }
+    backoff.Reset();
+  }
+}
+
+absl::StatusOr<std::vector<Polynomial>> RoutingPipeline::RouteStream(
+    const std::vector<RouteRequest>& requests) {
+  absl::MutexLock lock(&stream_mu_);
+  auto table = router_.routing_table();
+  if (table == nullptr) {
+    return absl::FailedPreconditionError(
+        "No routing weights learned. Call LearnRouting() first.");
+  }
+  if (!table->violated_gluings.empty()) {
+    const auto& gluing = table->gluings[table->violated_gluings.front()];
+    return absl::InternalError(absl::StrCat(
+        "Gluing constraint violated: ",
+        gluing.patch_1_id, " → ", gluing.patch_2_id));
+  }
+
+  // The caller feeds the first ring and drains the last one, interleaved
+  // so a full pipeline never blocks on an undrained output ring.
+  std::vector<Polynomial> results(requests.size());
+  Ring& head = *rings_.front();
+  Ring& tail = *rings_.back();
+  size_t submitted = 0;
+  size_t completed = 0;
+  Batch pending;
+  bool has_pending = false;
+  Backoff backoff;
+  while (completed < requests.size()) {
+    bool progress = false;
+
+    if (!has_pending && submitted < requests.size()) {
+      const size_t size =
+          std::min(options_.batch_size, requests.size() - submitted);
+      pending.table = table;
+      pending.requests = requests.data();
+      pending.begin = submitted;
+      pending.messages.assign(size, Polynomial());
+      submitted += size;
+      has_pending = true;
+    }
+    if (has_pending && head.TryPush(std::move(pending))) {
+      pending = Batch();
+      has_pending = false;
+      progress = true;
+    }
+
+    Batch done;
+    if (tail.TryPop(done)) {
+      std::move(done.messages.begin(), done.messages.end(),
+                results.begin() + done.begin);
+      completed += done.messages.size();
+      progress = true;
+    }
+
+    if (progress) {
+      backoff.Reset();
+    } else {
+      backoff.Idle();
+    }
+  }
+  return results;
+}
+
+}  // namespace f2chat
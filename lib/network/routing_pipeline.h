@@ -0,0 +1,138 @@
+// lib/network/routing_pipeline.h
+//
+// Streaming router: patches as pipeline stages.
+//
+// SheafRouter::Route carries one message through every patch before the
+// next message starts. For sustained streams, RoutingPipeline splits the
+// patch sequence into contiguous stage groups, runs each stage on its own
+// thread (pinned to a core on Linux) and connects consecutive stages with
+// lock-free SPSC rings carrying batches of polynomials:
+//
+//   caller ─▶ [encode + φ₀..φₐ] ─▶ ring ─▶ [φₐ₊₁..φ_b] ─▶ ring ─▶ ... ─▶ caller
+//
+// Once the pipeline is full, throughput is set by the slowest stage
+// rather than by the sum of all stages. Stages are long-running spinning
+// loops, so they get dedicated threads rather than Executor tasks; size
+// the pipeline and the executor's core set so they do not overlap.
+//
+// Each message follows the same patches as Route: its PatchTopology plan
+// when its endpoints have one, every patch otherwise. A stage applies the
+// message's next plan steps while they fall in its patch group; steps that
+// go back to an earlier group are finished by the last stage, so plans
+// that run against the stage order lose their overlap but not their
+// result. Gluings are checked once per stream against the table the
+// stream uses; sampled audits are not run.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_ROUTING_PIPELINE_H_
+#define F2CHAT_LIB_NETWORK_ROUTING_PIPELINE_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "lib/crypto/polynomial.h"
+#include "lib/network/routing_table.h"
+#include "lib/network/sheaf_router.h"
+#include "lib/runtime/spsc_ring.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+
+namespace f2chat {
+
+// One message to route.
+struct RouteRequest {
+  Polynomial message;
+  Polynomial source_id;
+  Polynomial dest_id;
+};
+
+// Pipeline shape.
+struct PipelineOptions {
+  // Number of stage threads (0 = one per patch, capped at the number of
+  // hardware threads). Patches are split into contiguous groups.
+  int num_stages = 0;
+
+  // Messages per batch handed between stages.
+  size_t batch_size = 32;
+
+  // Batches buffered between two stages.
+  size_t ring_capacity = 16;
+
+  // Pin stage i to core (first_core + i) mod cores (Linux only;
+  // best effort, ignored if the affinity call fails).
+  bool pin_stages = true;
+  int first_core = 0;
+};
+
+// Pipeline-parallel router over a SheafRouter's published weights.
+//
+// Thread Safety: RouteStream calls are serialized internally (the caller
+// thread is the single producer of the first ring and the single consumer
+// of the last). The router must outlive the pipeline; retraining while
+// streaming is fine (each stream routes with the table current at its
+// start).
+class RoutingPipeline {
+ public:
+  // Starts the stage threads.
+  //
+  // Returns:
+  //   Pipeline, or InvalidArgument for a zero batch size / ring capacity
+  static absl::StatusOr<std::unique_ptr<RoutingPipeline>> Create(
+      const SheafRouter& router, const PipelineOptions& options = {});
+
+  ~RoutingPipeline();
+
+  RoutingPipeline(const RoutingPipeline&) = delete;
+  RoutingPipeline& operator=(const RoutingPipeline&) = delete;
+
+  // Routes a stream of messages (results in input order).
+  //
+  // Returns:
+  //   Routed polynomials, same as Route
+  //   FailedPrecondition if nothing was learned yet
+  //   Internal if the published weights violate a gluing
+  //
+  // Performance: O(messages * patches * n * k / stages) wall time once
+  // the pipeline is full
+  absl::StatusOr<std::vector<Polynomial>> RouteStream(
+      const std::vector<RouteRequest>& requests);
+
+  int num_stages() const { return static_cast<int>(stages_.size()); }
+
+ private:
+  // Unit of work flowing through the rings.
+  struct Batch {
+    std::shared_ptr<const RoutingTable> table;
+    const RouteRequest* requests = nullptr;  // Encoded by stage 0
+    size_t begin = 0;                        // Index of the first message
+    std::vector<Polynomial> messages;
+    // Per message: plan (nullptr = every patch) and next step to apply.
+    std::vector<const std::vector<size_t>*> plans;
+    std::vector<size_t> next_steps;
+  };
+  using Ring = SpscRing<Batch>;
+
+  RoutingPipeline(const SheafRouter& router, const PipelineOptions& options,
+                  int num_stages);
+
+  // Stage loop: pop, apply this stage's patch group, push downstream.
+  void RunStage(int stage);
+
+  // Applies the plan steps of a batch that fall in stage `stage`'s patch
+  // group (all remaining steps on the last stage).
+  void ApplyStage(int stage, Batch& batch) const;
+
+  const SheafRouter& router_;
+  PipelineOptions options_;
+  std::vector<std::unique_ptr<Ring>> rings_;  // rings_[i] feeds stage i
+  std::vector<std::thread> stages_;
+  std::atomic<bool> stop_{false};
+  absl::Mutex stream_mu_;  // One stream at a time
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_ROUTING_PIPELINE_H_
@@ -0,0 +1,238 @@
+// lib/network/routing_snapshot.cc
+#include "lib/network/routing_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include "absl/strings/str_cat.h"
+
+namespace f2chat {
+
+namespace {
+constexpr char kMagic[8] = {'F', '2', 'C', 'R', 'O', 'U', 'T', 'E'};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_bytes;
+  uint32_t degree;
+  uint32_t num_characters;
+  int64_t modulus;
+  uint64_t fingerprint;
+  double obstruction;
+  uint32_t success;
+  uint32_t solve_path;
+  uint32_t num_patches;
+  uint32_t weight_basis;  // WeightBasis (0 = rounded projections)
+  uint64_t checksum;  // FNV-1a over bytes [header_bytes, file_size)
+};
+
+struct DirectoryEntry {
+  uint32_t num_positions;
+  uint32_t num_characters;
+  uint64_t offset;
+};
+
+static_assert(sizeof(FileHeader) % alignof(double) == 0);
+static_assert(sizeof(DirectoryEntry) % alignof(double) == 0);
+
+uint64_t Fnv1a(const unsigned char* data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Read-only file mapping (unmapped when the last operator drops it).
+class MappedFile {
+ public:
+  MappedFile(const void* data, size_t size) : data_(data), size_(size) {}
+  ~MappedFile() { munmap(const_cast<void*>(data_), size_); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const unsigned char* bytes() const {
+    return static_cast<const unsigned char*>(data_);
+  }
+  size_t size() const { return size_; }
+
+ private:
+  const void* data_;
+  size_t size_;
+};
+
+absl::Status ErrnoError(const std::string& what, const std::string& path) {
+  int error = errno;
+  std::string message = absl::StrCat(what, " ", path, ": ", std::strerror(error));
+  return error == ENOENT ? absl::NotFoundError(message)
+                         : absl::InternalError(message);
+}
+}  // namespace
+
+absl::Status RoutingSnapshot::Write(
+    const std::string& path,
+    const SnapshotMetadata& metadata,
+    const std::vector<RoutingOperator>& operators) {
+  // Serialize into one buffer: header, directory, tables.
+  const size_t directory_bytes = operators.size() * sizeof(DirectoryEntry);
+  size_t offset = sizeof(FileHeader) + directory_bytes;
+
+  std::vector<DirectoryEntry> directory(operators.size());
+  for (size_t i = 0; i < operators.size(); ++i) {
+    directory[i].num_positions = operators[i].num_positions();
+    directory[i].num_characters = operators[i].num_characters();
+    directory[i].offset = offset;
+    offset += sizeof(double) *
+        static_cast<size_t>(operators[i].num_positions()) *
+        operators[i].num_characters();
+  }
+
+  std::vector<unsigned char> buffer(offset);
+  std::memcpy(buffer.data() + sizeof(FileHeader), directory.data(),
+              directory_bytes);
+  for (size_t i = 0; i < operators.size(); ++i) {
+    std::memcpy(buffer.data() + directory[i].offset, operators[i].table(),
+                sizeof(double) * directory[i].num_positions *
+                    directory[i].num_characters);
+  }
+
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.header_bytes = sizeof(FileHeader);
+  header.degree = RingParams::kDegree;
+  header.num_characters = RingParams::kNumCharacters;
+  header.modulus = RingParams::kModulus;
+  header.fingerprint = metadata.fingerprint;
+  header.obstruction = metadata.obstruction;
+  header.success = metadata.success ? 1 : 0;
+  header.solve_path = static_cast<uint32_t>(metadata.solve_path);
+  header.weight_basis = static_cast<uint32_t>(metadata.weight_basis);
+  header.num_patches = static_cast<uint32_t>(operators.size());
+  header.checksum = Fnv1a(buffer.data() + sizeof(FileHeader),
+                          buffer.size() - sizeof(FileHeader));
+  std::memcpy(buffer.data(), &header, sizeof(header));
+
+  // Atomic replace: readers never observe a partially written snapshot.
+  const std::string temporary = absl::StrCat(path, ".tmp");
+  std::FILE* file = std::fopen(temporary.c_str(), "wb");
+  if (file == nullptr) {
+    return ErrnoError("Cannot create", temporary);
+  }
+  bool written = std::fwrite(buffer.data(), 1, buffer.size(), file) ==
+                     buffer.size() &&
+                 std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+  if (std::fclose(file) != 0 || !written) {
+    auto status = ErrnoError("Cannot write", temporary);
+    std::remove(temporary.c_str());
+    return status;
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    auto status = ErrnoError("Cannot rename snapshot to", path);
+    std::remove(temporary.c_str());
+    return status;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<RoutingSnapshot> RoutingSnapshot::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return ErrnoError("Cannot open", path);
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    auto status = ErrnoError("Cannot stat", path);
+    close(fd);
+    return status;
+  }
+  const size_t size = static_cast<size_t>(info.st_size);
+  if (size < sizeof(FileHeader)) {
+    close(fd);
+    return absl::DataLossError(absl::StrCat("Truncated snapshot: ", path));
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping stays valid after close.
+  if (data == MAP_FAILED) {
+    return ErrnoError("Cannot map", path);
+  }
+  auto mapping = std::make_shared<const MappedFile>(data, size);
+
+  FileHeader header;
+  std::memcpy(&header, mapping->bytes(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.header_bytes != sizeof(FileHeader)) {
+    return absl::DataLossError(absl::StrCat("Not a routing snapshot: ", path));
+  }
+  if (header.version != kVersion) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Unsupported snapshot version ", header.version, " (expected ",
+        kVersion, ")"));
+  }
+  if (header.degree != RingParams::kDegree ||
+      header.num_characters != RingParams::kNumCharacters ||
+      header.modulus != RingParams::kModulus) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Snapshot ring parameters (n=", header.degree, ", k=",
+        header.num_characters, ", p=", header.modulus,
+        ") do not match this build"));
+  }
+
+  const size_t directory_end = sizeof(FileHeader) +
+      static_cast<size_t>(header.num_patches) * sizeof(DirectoryEntry);
+  if (directory_end > size) {
+    return absl::DataLossError(absl::StrCat("Truncated snapshot: ", path));
+  }
+  if (Fnv1a(mapping->bytes() + sizeof(FileHeader),
+            size - sizeof(FileHeader)) != header.checksum) {
+    return absl::DataLossError(absl::StrCat("Snapshot checksum mismatch: ", path));
+  }
+
+  if (header.weight_basis >
+      static_cast<uint32_t>(WeightBasis::kFpCharacters)) {
+    return absl::DataLossError(absl::StrCat(
+        "Unknown weight basis ", header.weight_basis, " in snapshot: ", path));
+  }
+
+  RoutingSnapshot snapshot;
+  snapshot.metadata_.fingerprint = header.fingerprint;
+  snapshot.metadata_.obstruction = header.obstruction;
+  snapshot.metadata_.success = header.success != 0;
+  snapshot.metadata_.solve_path = static_cast<SolvePath>(header.solve_path);
+  snapshot.metadata_.weight_basis =
+      static_cast<WeightBasis>(header.weight_basis);
+
+  snapshot.operators_.reserve(header.num_patches);
+  for (uint32_t i = 0; i < header.num_patches; ++i) {
+    DirectoryEntry entry;
+    std::memcpy(&entry,
+                mapping->bytes() + sizeof(FileHeader) + i * sizeof(entry),
+                sizeof(entry));
+    const size_t table_bytes = sizeof(double) *
+        static_cast<size_t>(entry.num_positions) * entry.num_characters;
+    if (entry.offset % alignof(double) != 0 || entry.offset < directory_end ||
+        entry.offset > size || table_bytes > size - entry.offset) {
+      return absl::DataLossError(absl::StrCat(
+          "Snapshot table ", i, " out of bounds: ", path));
+    }
+    snapshot.operators_.push_back(RoutingOperator::View(
+        reinterpret_cast<const double*>(mapping->bytes() + entry.offset),
+        static_cast<int>(entry.num_positions),
+        static_cast<int>(entry.num_characters),
+        mapping, snapshot.metadata_.weight_basis));
+  }
+  return snapshot;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,86 @@
+// lib/network/routing_snapshot.h
+//
+// Versioned binary snapshot of learned routing (memory-mapped at startup).
+//
+// Layout (native byte order, all offsets from the start of the file):
+//
+//   Header      magic "F2CROUTE", version, ring parameters (n, k, p),
+//               problem fingerprint, obstruction, success, solve path,
+//               patch count, weight basis, FNV-1a checksum of everything after the header
+//   Directory   one {num_positions, num_characters, offset} entry per patch
+//   Tables      row-major positions × characters doubles, 8-byte aligned
+//
+// Open() maps the file read-only and wraps each table in a RoutingOperator
+// without copying, so a restarted router can route as soon as the file is
+// mapped and validated (no LearnRouting).
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_ROUTING_SNAPSHOT_H_
+#define F2CHAT_LIB_NETWORK_ROUTING_SNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lib/network/routing_operator.h"
+#include "lib/network/sheaf_system.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+namespace f2chat {
+
+// Scalar fields of a snapshot.
+struct SnapshotMetadata {
+  uint64_t fingerprint = 0;  // SheafRouter::fingerprint() of the problem
+  double obstruction = 0.0;
+  bool success = false;
+  SolvePath solve_path = SolvePath::kDouble;
+  WeightBasis weight_basis = WeightBasis::kRoundedProjections;
+};
+
+// Read-only routing snapshot.
+//
+// Thread Safety: Immutable; copies share the underlying mapping.
+class RoutingSnapshot {
+ public:
+  static constexpr uint32_t kVersion = 1;
+
+  // Writes a snapshot atomically (temporary file + rename).
+  //
+  // Args:
+  //   path: Destination file
+  //   metadata: Fingerprint, obstruction, success, solve path, weight basis
+  //   operators: Compiled per-patch operators
+  //
+  // Returns:
+  //   OK, or Internal on I/O failure
+  static absl::Status Write(
+      const std::string& path,
+      const SnapshotMetadata& metadata,
+      const std::vector<RoutingOperator>& operators);
+
+  // Maps a snapshot read-only and validates it.
+  //
+  // Returns:
+  //   Snapshot whose operators borrow the mapping
+  //   NotFound / Internal on I/O failure
+  //   DataLoss if the file is truncated, malformed or fails its checksum
+  //   FailedPrecondition if the version or ring parameters differ
+  //
+  // Performance: O(file size) (checksum pass), no weight copies
+  static absl::StatusOr<RoutingSnapshot> Open(const std::string& path);
+
+  const SnapshotMetadata& metadata() const { return metadata_; }
+  const std::vector<RoutingOperator>& operators() const { return operators_; }
+
+ private:
+  RoutingSnapshot() = default;
+
+  SnapshotMetadata metadata_;
+  std::vector<RoutingOperator> operators_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_ROUTING_SNAPSHOT_H_
@@ -0,0 +1,33 @@
+// lib/network/routing_table.cc
+#include "lib/network/routing_table.h"
+
+namespace f2chat {
+
+uint64_t VersionedRoutingTable::Publish(RoutingTable table) {
+  table.version = next_version_.fetch_add(1, std::memory_order_relaxed);
+  const uint64_t version = table.version;
+
+  // Build the new version completely before it becomes visible.
+  std::shared_ptr<const RoutingTable> next =
+      std::make_shared<const RoutingTable>(std::move(table));
+
+  // Concurrent publishers may finish out of order; never replace a newer
+  // version with an older one.
+  std::shared_ptr<const RoutingTable> current =
+      current_.load(std::memory_order_acquire);
+  while (current == nullptr || current->version < version) {
+    if (current_.compare_exchange_weak(current, next,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      break;
+    }
+  }
+  return version;
+}
+
+uint64_t VersionedRoutingTable::version() const {
+  auto table = Acquire();
+  return table != nullptr ? table->version : 0;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,115 @@
+// lib/network/routing_table.h
+//
+// Versioned routing table for hot swaps under live traffic.
+//
+// Learned routing is published as an immutable RoutingTable behind an
+// atomic shared_ptr (read-copy-update):
+//
+//   - readers (SheafRouter::Route) take a reference to the current table
+//     with one atomic load and route against it; they never wait for a
+//     writer to train or build a table
+//   - writers build a complete new table off to the side and publish it
+//     with one atomic store
+//   - a replaced table is freed when the last reader still holding it
+//     finishes (shared_ptr reference count), so there is no grace-period
+//     bookkeeping
+//
+// The load and store are not lock-free: libstdc++ implements
+// std::atomic<std::shared_ptr> with a lock bit in the control pointer,
+// held while the reference count is adjusted. A reader can therefore wait
+// briefly for a concurrent Acquire or Publish (a few atomic operations,
+// never a table build), and is_lock_free() is false.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_ROUTING_TABLE_H_
+#define F2CHAT_LIB_NETWORK_ROUTING_TABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "lib/network/gluing.h"
+#include "lib/network/patch_topology.h"
+#include "lib/network/routing_operator.h"
+#include "lib/network/sheaf_system.h"
+#include "lib/runtime/node_replicated.h"
+
+namespace f2chat {
+
+// One immutable version of the learned routing.
+struct RoutingTable {
+  uint64_t version = 0;  // Assigned by VersionedRoutingTable::Publish
+
+  // Compiled operators φₚ (one per patch, all in the weight basis of
+  // SolverOptions::weight_basis).
+  std::vector<RoutingOperator> operators;
+
+  // Node-local copies of `operators` on multi-node machines (empty on a
+  // single node).
+  NodeReplicated<std::vector<RoutingOperator>> node_operators;
+
+  // Operators to route with on the calling thread's NUMA node.
+  const std::vector<RoutingOperator>& LocalOperators() const {
+    return node_operators.num_replicas() > 1 ? node_operators.Local()
+                                             : operators;
+  }
+
+  // Gluing graph and route plans over `operators` (refreshed, immutable).
+  std::shared_ptr<const PatchTopology> topology;
+
+  // Gluing constraints the operators were learned against, with the
+  // operator indices of their two patches.
+  std::vector<GluingConstraint> gluings;
+  std::vector<std::pair<size_t, size_t>> gluing_patches;
+
+  // Gluings whose agreement φ₁(boundary) ≈ φ₂(boundary) failed when the
+  // table was published (indices into `gluings`).
+  std::vector<size_t> violated_gluings;
+
+  // SheafRouter::fingerprint() of the problem the table was learned for.
+  uint64_t fingerprint = 0;
+
+  double obstruction = 0.0;
+  bool success = false;
+  SolvePath solve_path = SolvePath::kDouble;
+};
+
+// Atomically swappable pointer to the current RoutingTable.
+//
+// Thread Safety: Acquire and Publish may be called concurrently from any
+// number of threads; both take the shared_ptr's internal lock for a few
+// atomic operations (see file comment).
+class VersionedRoutingTable {
+ public:
+  VersionedRoutingTable() = default;
+  VersionedRoutingTable(const VersionedRoutingTable&) = delete;
+  VersionedRoutingTable& operator=(const VersionedRoutingTable&) = delete;
+
+  // Current table (nullptr until the first Publish).
+  //
+  // The returned table stays valid for as long as the caller holds it,
+  // even if a newer version is published meanwhile.
+  std::shared_ptr<const RoutingTable> Acquire() const {
+    return current_.load(std::memory_order_acquire);
+  }
+
+  // Publishes `table` as the next version.
+  //
+  // Returns:
+  //   Version number assigned to the table (strictly increasing)
+  uint64_t Publish(RoutingTable table);
+
+  // Version of the current table (0 if none).
+  uint64_t version() const;
+
+ private:
+  std::atomic<std::shared_ptr<const RoutingTable>> current_;
+  std::atomic<uint64_t> next_version_{1};
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_ROUTING_TABLE_H_
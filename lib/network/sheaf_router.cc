@@ -1,241 +1,668 @@
 // lib/network/sheaf_router.cc
 #include "lib/network/sheaf_router.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include "lib/crypto/polynomial_batch.h"
 #include "absl/strings/str_cat.h"
 
 namespace f2chat {
 
+namespace {
+// Stable 64-bit FNV-1a over the problem definition (absl::Hash is seeded
+// per process, so it cannot identify a problem across restarts).
+class Fingerprinter {
+ public:
+  void Add(const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash_ ^= bytes[i];
+      hash_ *= 0x100000001b3ULL;
+    }
+  }
+  template <typename T>
+  void AddValue(T value) { Add(&value, sizeof(value)); }
+  void Add(const std::string& value) {
+    AddValue(value.size());
+    Add(value.data(), value.size());
+  }
+  void Add(const Polynomial& poly) {
+    const auto& coefficients = poly.coefficients();
+    Add(coefficients.data(), coefficients.size() * sizeof(int64_t));
+  }
+  void Add(const std::vector<RoutingExample>& examples) {
+    AddValue(examples.size());
+    for (const auto& example : examples) {
+      Add(example.source_poly);
+      Add(example.destination_poly);
+      Add(example.message_poly);
+      Add(example.expected_output);
+    }
+  }
+  uint64_t hash() const { return hash_; }
+
+ private:
+  uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+
+uint64_t ProblemFingerprint(
+    const RoutingProblem& problem, const SolverOptions& options) {
+  Fingerprinter fp;
+  fp.AddValue(static_cast<int>(options.weight_basis));
+  fp.AddValue(static_cast<int>(options.precision));
+  fp.AddValue(static_cast<int>(options.sketch));
+  fp.AddValue(options.sketch_factor);
+  fp.AddValue(options.sketch_seed);
+
+  fp.AddValue(problem.patches.size());
+  for (const auto& patch : problem.patches) {
+    fp.Add(patch->patch_id());
+    for (const auto& row : patch->weights().weights) {
+      fp.AddValue(row.size());
+      fp.Add(row.data(), row.size() * sizeof(double));
+    }
+  }
+  fp.AddValue(problem.gluings.size());
+  for (const auto& gluing : problem.gluings) {
+    fp.Add(gluing.patch_1_id);
+    fp.Add(gluing.patch_2_id);
+    fp.AddValue(static_cast<int>(gluing.type));
+    fp.Add(gluing.boundary_poly);
+  }
+  fp.Add(problem.examples);
+
+  // Hash map iteration order is unspecified: visit local examples by id.
+  std::vector<const std::string*> ids;
+  for (const auto& [id, examples] : problem.local_examples) {
+    if (!examples.empty()) ids.push_back(&id);
+  }
+  std::sort(ids.begin(), ids.end(),
+            [](const std::string* a, const std::string* b) { return *a < *b; });
+  for (const std::string* id : ids) {
+    fp.Add(*id);
+    fp.Add(problem.local_examples.at(*id));
+  }
+  return fp.hash();
+}
+}  // namespace
+
 absl::StatusOr<SheafRouter> SheafRouter::Create(
-    const RoutingProblem& problem) {
+    const RoutingProblem& problem,
+    const SolverOptions& options,
+    const RouterOptions& router_options) {
   if (problem.patches.empty()) {
     return absl::InvalidArgumentError("No patches provided");
   }
+  if (!(router_options.audit_rate >= 0.0 && router_options.audit_rate <= 1.0)) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Audit rate must be in [0, 1]: ", router_options.audit_rate));
+  }
 
-  return SheafRouter(problem);
+  SheafRouter router(problem, options, router_options);
+  auto status = router.ValidateProblem();
+  if (!status.ok()) {
+    return status;
+  }
+  router.fingerprint_ = ProblemFingerprint(router.problem_, options);
+  return router;
 }
 
-SheafRouter::SheafRouter(const RoutingProblem& problem)
-    : problem_(problem) {}
+SheafRouter::SheafRouter(
+    const RoutingProblem& problem,
+    const SolverOptions& options,
+    const RouterOptions& router_options)
+    : problem_(problem),
+      options_(options),
+      router_options_(router_options),
+      system_(options),
+      writer_mu_(std::make_unique<absl::Mutex>()),
+      table_(std::make_unique<VersionedRoutingTable>()),
+      arena_(std::make_unique<BatchArena>(NumaTopology::System().num_nodes())),
+      audit_(std::make_unique<AuditState>()) {}
+
+absl::Status SheafRouter::ValidateProblem() {
+  for (size_t i = 0; i < problem_.patches.size(); ++i) {
+    const auto& patch = problem_.patches[i];
+    if (patch == nullptr) {
+      return absl::InvalidArgumentError(absl::StrCat("Patch ", i, " is null"));
+    }
+    if (patch->weights().num_characters() != RingParams::kNumCharacters) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Patch ", patch->patch_id(), ": routing weights must have ",
+          RingParams::kNumCharacters, " characters"));
+    }
+    if (!patch_index_.emplace(patch->patch_id(), i).second) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Duplicate patch id: ", patch->patch_id()));
+    }
+    topology_.AddPatch();
+  }
+
+  for (const auto& gluing : problem_.gluings) {
+    if (!patch_index_.contains(gluing.patch_1_id) ||
+        !patch_index_.contains(gluing.patch_2_id)) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Gluing references unknown patch: ",
+          gluing.patch_1_id, " → ", gluing.patch_2_id));
+    }
+    topology_.AddEdge(patch_index_.at(gluing.patch_1_id),
+                      patch_index_.at(gluing.patch_2_id));
+  }
+
+  for (const auto& endpoint : problem_.endpoints) {
+    auto it = patch_index_.find(endpoint.patch_id);
+    if (it == patch_index_.end()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Endpoint references unknown patch: ", endpoint.patch_id));
+    }
+    topology_.AssignEndpoint(endpoint.id, it->second);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SheafRouter::EnsureSystem() {
+  if (system_ready_) {
+    return absl::OkStatus();
+  }
+
+  // Step 1-2: Local systems (one block per patch, shared examples + local)
+  system_.SetSharedExamples(problem_.examples);
+
+  for (size_t i = 0; i < problem_.patches.size(); ++i) {
+    const auto& patch = problem_.patches[i];
+    auto local_it = problem_.local_examples.find(patch->patch_id());
+    auto status = system_.SetPatch(
+        i, *patch,
+        local_it != problem_.local_examples.end()
+            ? local_it->second : std::vector<RoutingExample>{});
+    if (!status.ok()) {
+      return status;
+    }
+  }
 
-absl::StatusOr<RoutingResult> SheafRouter::LearnRouting() {
+  // Step 3-4: Gluing system (boundary constraints, zero RHS)
+  for (const auto& gluing : problem_.gluings) {
+    auto status = AddGluingToSystem(gluing);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  system_ready_ = true;
+  return absl::OkStatus();
+}
+
+absl::Status SheafRouter::AddGluingToSystem(const GluingConstraint& gluing) {
+  auto it_1 = patch_index_.find(gluing.patch_1_id);
+  auto it_2 = patch_index_.find(gluing.patch_2_id);
+  if (it_1 == patch_index_.end() || it_2 == patch_index_.end()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Gluing references unknown patch: ",
+        gluing.patch_1_id, " → ", gluing.patch_2_id));
+  }
+  return system_.AddGluing(it_1->second, it_2->second, gluing.boundary_poly);
+}
+
+absl::StatusOr<RoutingResult> SheafRouter::LearnRouting(
+    const CancellationToken& token, const ProgressCallback& progress) {
   // Algorithm 2.1 from paper: Unified Sheaf Learner
   //
-  // Step 1-2: Assemble local system (patch routing)
-  std::vector<std::vector<double>> A_local;
-  std::vector<double> b_local;
-  AssembleLocalSystem(A_local, b_local);
+  // Steps 5-6 (global solve) run on the cached block system; blocks are
+  // only refactored when their patch, examples or gluings changed.
+  absl::MutexLock lock(writer_mu_.get());
+  auto status = EnsureSystem();
+  if (!status.ok()) {
+    return status;
+  }
+  return Solve(token, progress);
+}
 
-  // Step 3-4: Assemble gluing system (boundary constraints)
-  std::vector<std::vector<double>> A_gluing;
-  AssembleGluingSystem(A_gluing);
+absl::StatusOr<RoutingResult> SheafRouter::UpdatePatch(
+    std::shared_ptr<Patch> patch,
+    const std::vector<RoutingExample>& local_examples) {
+  if (patch == nullptr) {
+    return absl::InvalidArgumentError("Patch is null");
+  }
+  absl::MutexLock lock(writer_mu_.get());
+  auto ready = EnsureSystem();
+  if (!ready.ok()) {
+    return ready;
+  }
 
-  // Step 5: Form global system
-  std::vector<std::vector<double>> A_sheaf = A_local;
-  std::vector<double> b_sheaf = b_local;
+  auto it = patch_index_.find(patch->patch_id());
+  size_t index = it != patch_index_.end() ? it->second : problem_.patches.size();
 
-  // Append gluing constraints (with zero RHS)
-  for (const auto& gluing_row : A_gluing) {
-    A_sheaf.push_back(gluing_row);
-    b_sheaf.push_back(0.0);  // Gluing constraints: C · w = 0
+  auto status = system_.SetPatch(index, *patch, local_examples);
+  if (!status.ok()) {
+    return status;
   }
 
-  // Step 6: Solve least-squares: w* = (A^H A)^{-1} A^H b
-  auto w_or = SolveLeastSquares(A_sheaf, b_sheaf);
-  if (!w_or.ok()) {
-    return w_or.status();
+  if (index == problem_.patches.size()) {
+    patch_index_[patch->patch_id()] = index;
+    problem_.patches.push_back(patch);
+    topology_.AddPatch();
+  } else {
+    problem_.patches[index] = patch;
   }
+  problem_.local_examples[patch->patch_id()] = local_examples;
+  fingerprint_ = ProblemFingerprint(problem_, options_);
 
-  auto w = std::move(w_or).value();
+  return Solve();
+}
 
-  // Compute residual: ||A w - b||²
-  double residual = 0.0;
-  for (size_t i = 0; i < A_sheaf.size(); ++i) {
-    double predicted = 0.0;
-    for (size_t j = 0; j < w.size() && j < A_sheaf[i].size(); ++j) {
-      predicted += A_sheaf[i][j] * w[j];
-    }
-    double error = predicted - (i < b_sheaf.size() ? b_sheaf[i] : 0.0);
-    residual += error * error;
+absl::StatusOr<RoutingResult> SheafRouter::AddGluing(
+    const GluingConstraint& gluing) {
+  absl::MutexLock lock(writer_mu_.get());
+  auto status = EnsureSystem();
+  if (status.ok()) {
+    status = AddGluingToSystem(gluing);
+  }
+  if (!status.ok()) {
+    return status;
+  }
+  problem_.gluings.push_back(gluing);
+  topology_.AddEdge(patch_index_.at(gluing.patch_1_id),
+                    patch_index_.at(gluing.patch_2_id));
+  fingerprint_ = ProblemFingerprint(problem_, options_);
+
+  return Solve();
+}
+
+absl::StatusOr<RoutingResult> SheafRouter::Solve(
+    const CancellationToken& token, const ProgressCallback& progress) {
+  auto solution_or = system_.Solve(token, progress);
+  if (!solution_or.ok()) {
+    return solution_or.status();
   }
+  auto solution = std::move(solution_or).value();
 
   // Package result
   RoutingResult result;
-  result.obstruction = residual;
-  result.success = (residual < 1e-6);  // Zero obstruction → success
+  result.obstruction = solution.obstruction;
+  result.success = (solution.obstruction < 1e-6);  // Zero obstruction → success
+  result.solve_path = solution.path;
 
-  // TODO: Unpack w into per-patch weights
-  // For now, create default weights for each patch
-  for (size_t i = 0; i < problem_.patches.size(); ++i) {
+  // Unpack w into per-patch weights (one row per output position).
+  result.patch_weights.reserve(problem_.patches.size());
+  for (const auto& learned : solution.patch_weights) {
     RoutingWeights weights;
-    weights.weights.resize(8);  // 8 positions (network depth)
-    for (auto& position_weights : weights.weights) {
-      position_weights.resize(RingParams::kNumCharacters, 1.0 / RingParams::kNumCharacters);
+    weights.weights.resize(learned.rows());
+    for (int p = 0; p < learned.rows(); ++p) {
+      weights.weights[p].resize(learned.cols());
+      for (int j = 0; j < learned.cols(); ++j) {
+        weights.weights[p][j] = learned(p, j);
+      }
     }
-    result.patch_weights.push_back(weights);
+    result.patch_weights.push_back(std::move(weights));
+  }
+
+  // Compile flat operators and publish them as the next table version;
+  // in-flight routes finish on the version they started with.
+  RoutingTable table;
+  table.operators.reserve(result.patch_weights.size());
+  for (const auto& weights : result.patch_weights) {
+    table.operators.push_back(
+        RoutingOperator::Compile(weights, options_.weight_basis));
   }
+  table.fingerprint = fingerprint_;
+  table.obstruction = result.obstruction;
+  table.success = result.success;
+  table.solve_path = result.solve_path;
+  result.violated_gluings = VerifyAndPublish(std::move(table));
 
   last_result_ = result;
   return result;
 }
 
-absl::StatusOr<Polynomial> SheafRouter::Route(
-    const Polynomial& message_poly,
-    const Polynomial& source_id,
-    const Polynomial& dest_id) const {
-  if (last_result_.patch_weights.empty()) {
-    return absl::FailedPreconditionError(
-        "No routing weights learned. Call LearnRouting() first.");
-  }
+bool SheafRouter::GluingAgrees(const RoutingTable& table, size_t g) const {
+  const auto [a, b] = table.gluing_patches[g];
+  const GluingConstraint& gluing = table.gluings[g];
+  return gluing.VerifyAgreement(
+      table.operators[a].Apply(gluing.boundary_poly),
+      table.operators[b].Apply(gluing.boundary_poly),
+      router_options_.gluing_tolerance);
+}
 
-  // Encode routing information
-  Polynomial routed = RoutingPolynomial::EncodeRoute(
-      source_id, dest_id, message_poly);
+std::vector<size_t> SheafRouter::VerifyAndPublish(RoutingTable table) {
+  table.gluings = problem_.gluings;
+  table.gluing_patches.clear();
+  for (const auto& gluing : table.gluings) {
+    table.gluing_patches.emplace_back(patch_index_.at(gluing.patch_1_id),
+                                      patch_index_.at(gluing.patch_2_id));
+  }
 
-  // Apply local routing at each patch
-  for (size_t i = 0; i < problem_.patches.size(); ++i) {
-    routed = problem_.patches[i]->ApplyLocalRouting(routed);
+  // Prove the gluings once for this weight set: route every boundary
+  // through both patches, then check every agreement.
+  const size_t num_gluings = table.gluings.size();
+  std::vector<Polynomial> routed;
+  routed.reserve(2 * num_gluings);
+  std::vector<GluingVerifier::Check> checks(num_gluings);
+  for (size_t g = 0; g < num_gluings; ++g) {
+    const auto [a, b] = table.gluing_patches[g];
+    const Polynomial& boundary = table.gluings[g].boundary_poly;
+    routed.push_back(table.operators[a].Apply(boundary));
+    routed.push_back(table.operators[b].Apply(boundary));
+  }
+  for (size_t g = 0; g < num_gluings; ++g) {
+    checks[g] = {g, &routed[2 * g], &routed[2 * g + 1]};
   }
 
-  // Verify gluing constraints
-  for (const auto& gluing : problem_.gluings) {
-    if (!gluing.Verify(routed, 1e-6)) {
-      return absl::InternalError(absl::StrCat(
-          "Gluing constraint violated: ",
-          gluing.patch_1_id, " → ", gluing.patch_2_id));
+  auto violations = GluingVerifier(router_options_.gluing_tolerance)
+      .Verify(checks, num_gluings);
+  table.violated_gluings.clear();
+  for (size_t g = 0; g < num_gluings; ++g) {
+    if (violations[g] > 0) {
+      table.violated_gluings.push_back(g);
     }
   }
 
-  return routed;
-}
+  // Only sources whose plans the last topology change touched rebuild.
+  topology_.Refresh();
+  table.topology = std::make_shared<const PatchTopology>(topology_);
+
+  // On multi-socket machines, copy the operators into every node's memory
+  // so routes never read weights across sockets. Copying a RoutingOperator
+  // only shares its table, so each node task recompiles its own.
+  Executor& executor = Executor::OrDefault(router_options_.executor);
+  if (executor.topology().num_nodes() > 1) {
+    const auto& operators = table.operators;
+    table.node_operators = NodeReplicated<std::vector<RoutingOperator>>::Build(
+        executor, [&operators] {
+          std::vector<RoutingOperator> local;
+          local.reserve(operators.size());
+          for (const RoutingOperator& op : operators) {
+            local.push_back(
+                RoutingOperator::Compile(op.ToWeights(), op.basis()));
+          }
+          return local;
+        });
+  }
 
-double SheafRouter::VerifyConsistency(
-    const RoutingResult& result,
-    double /*tolerance*/) const {
-  // Residual is the cohomological obstruction
-  return result.obstruction;
+  std::vector<size_t> violated = table.violated_gluings;
+  table_->Publish(std::move(table));
+  return violated;
 }
 
-void SheafRouter::AssembleLocalSystem(
-    std::vector<std::vector<double>>& A,
-    std::vector<double>& b) const {
-  // For each training example, create design matrix rows
-  // A[i] = character projections at all positions
-  // b[i] = expected output value
+absl::Status SheafRouter::SaveSnapshot(const std::string& path) const {
+  auto table = table_->Acquire();
+  if (table == nullptr) {
+    return absl::FailedPreconditionError(
+        "No routing weights learned. Call LearnRouting() first.");
+  }
 
-  A.clear();
-  b.clear();
+  SnapshotMetadata metadata;
+  metadata.fingerprint = table->fingerprint;
+  metadata.obstruction = table->obstruction;
+  metadata.success = table->success;
+  metadata.solve_path = table->solve_path;
+  metadata.weight_basis = options_.weight_basis;
+  return RoutingSnapshot::Write(path, metadata, table->operators);
+}
 
-  for (const auto& example : problem_.examples) {
-    // Project input to characters
-    auto char_projs = example.message_poly.ProjectToAllCharacters();
+absl::Status SheafRouter::LoadSnapshot(const std::string& path) {
+  absl::MutexLock lock(writer_mu_.get());
+  auto snapshot_or = RoutingSnapshot::Open(path);
+  if (!snapshot_or.ok()) {
+    return snapshot_or.status();
+  }
+  const RoutingSnapshot& snapshot = snapshot_or.value();
 
-    // Flatten to design matrix row
-    std::vector<double> row;
-    for (const auto& proj : char_projs) {
-      auto coeffs = proj.Decode();
-      for (auto coeff : coeffs) {
-        row.push_back(static_cast<double>(coeff));
-      }
-    }
+  if (snapshot.metadata().fingerprint != fingerprint_) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Snapshot ", path, " was learned for a different routing problem"));
+  }
+  if (snapshot.operators().size() != problem_.patches.size()) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Snapshot has ", snapshot.operators().size(), " patches, expected ",
+        problem_.patches.size()));
+  }
 
-    A.push_back(row);
+  // Operators borrow the mapping; weights are expanded only on demand.
+  RoutingTable table;
+  table.operators = snapshot.operators();
+  table.fingerprint = fingerprint_;
+  table.obstruction = snapshot.metadata().obstruction;
+  table.success = snapshot.metadata().success;
+  table.solve_path = snapshot.metadata().solve_path;
+
+  last_result_ = RoutingResult();
+  last_result_.obstruction = snapshot.metadata().obstruction;
+  last_result_.success = snapshot.metadata().success;
+  last_result_.solve_path = snapshot.metadata().solve_path;
+  last_result_.violated_gluings = VerifyAndPublish(std::move(table));
+  return absl::OkStatus();
+}
 
-    // Expected output (flatten expected polynomial)
-    auto expected_coeffs = example.expected_output.Decode();
-    if (!expected_coeffs.empty()) {
-      b.push_back(static_cast<double>(expected_coeffs[0]));  // Use first coeff as target
-    } else {
-      b.push_back(0.0);
-    }
+absl::Status SheafRouter::CheckTable(
+    const RoutingTable* table, uint64_t routes) const {
+  if (table == nullptr) {
+    return absl::FailedPreconditionError(
+        "No routing weights learned. Call LearnRouting() first.");
   }
 
-  // If no examples, create dummy system (identity)
-  if (A.empty()) {
-    A.push_back({1.0});
-    b.push_back(1.0);
+  // Gluings were verified when this table was published.
+  if (!table->violated_gluings.empty()) {
+    const auto& gluing = table->gluings[table->violated_gluings.front()];
+    return absl::InternalError(absl::StrCat(
+        "Gluing constraint violated: ",
+        gluing.patch_1_id, " → ", gluing.patch_2_id));
   }
-}
-
-void SheafRouter::AssembleGluingSystem(
-    std::vector<std::vector<double>>& A) const {
-  A.clear();
 
-  // For each gluing constraint, create constraint row
-  // Constraint: C · w = 0
-  //
-  // This enforces: φ₂(φ₁(boundary)) = boundary
+  // Sampled audit: route i is audited when ⌊(i+1)·rate⌋ > ⌊i·rate⌋, which
+  // spaces audits evenly without a random number generator. A batch of
+  // routes runs the audits due for all of them (each gluing at most once).
+  const double rate = router_options_.audit_rate;
+  if (rate > 0.0 && !table->gluings.empty() && routes > 0) {
+    uint64_t i = audit_->routes.fetch_add(routes, std::memory_order_relaxed);
+    auto due = static_cast<uint64_t>(
+        std::floor((i + routes) * rate) - std::floor(i * rate));
+    due = std::min<uint64_t>(due, table->gluings.size());
+    for (uint64_t a = 0; a < due; ++a) {
+      int64_t run = audit_->runs.fetch_add(1, std::memory_order_relaxed);
+      size_t g = static_cast<size_t>(run) % table->gluings.size();
+      if (!GluingAgrees(*table, g)) {
+        audit_->failures.fetch_add(1, std::memory_order_relaxed);
+        const auto& gluing = table->gluings[g];
+        return absl::InternalError(absl::StrCat(
+            "Gluing audit failed: ",
+            gluing.patch_1_id, " → ", gluing.patch_2_id));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
 
-  for (size_t i = 0; i < problem_.gluings.size(); ++i) {
-    // Create constraint row
-    // For simplicity, just add a zero-row (no-op constraint)
-    // In full implementation, would compute actual constraint matrix
-    // from character projections of boundary polynomial
+const std::vector<size_t>* SheafRouter::PlanOf(
+    const RoutingTable& table,
+    const Polynomial& source_id,
+    const Polynomial& dest_id) {
+  return table.topology != nullptr
+      ? table.topology->PlanFor(source_id, dest_id) : nullptr;
+}
 
-    std::vector<double> constraint_row(
-        RingParams::kNumCharacters * RingParams::kDegree, 0.0);
+absl::StatusOr<Polynomial> SheafRouter::Route(
+    const Polynomial& message_poly,
+    const Polynomial& source_id,
+    const Polynomial& dest_id) const {
+  // One atomic load; the table stays alive until this route returns, even
+  // if a writer publishes a new version meanwhile.
+  auto table = table_->Acquire();
+  auto status = CheckTable(table.get(), 1);
+  if (!status.ok()) {
+    return status;
+  }
 
-    // TODO: Compute proper constraint from boundary polynomial
-    // For now, just ensure row has correct size
+  // Encode routing information
+  Polynomial routed = RoutingPolynomial::EncodeRoute(
+      source_id, dest_id, message_poly);
 
-    A.push_back(constraint_row);
+  // Apply local routing at each patch on the plan (learned weights)
+  const auto& operators = table->LocalOperators();
+  const std::vector<size_t>* plan = PlanOf(*table, source_id, dest_id);
+  if (plan != nullptr) {
+    for (size_t patch : *plan) {
+      routed = operators[patch].Apply(routed);
+    }
+  } else {
+    for (const auto& op : operators) {
+      routed = op.Apply(routed);
+    }
   }
-}
 
-absl::StatusOr<std::vector<double>> SheafRouter::SolveLeastSquares(
-    const std::vector<std::vector<double>>& A,
-    const std::vector<double>& b) const {
-  // Solve: w* = (A^H A)^{-1} A^H b
-  //
-  // For simplicity, using normal equations (not numerically stable for large systems).
-  // Production implementation should use QR decomposition or SVD.
+  return routed;
+}
 
-  if (A.empty() || b.empty()) {
-    return absl::InvalidArgumentError("Empty system");
+absl::StatusOr<std::vector<Polynomial>> SheafRouter::RouteBatch(
+    absl::Span<const Polynomial> messages,
+    absl::Span<const Polynomial> source_ids,
+    absl::Span<const Polynomial> dest_ids,
+    const CancellationToken& token,
+    const ProgressCallback& progress) const {
+  if (source_ids.size() != messages.size() ||
+      dest_ids.size() != messages.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "RouteBatch spans differ in length: ", messages.size(), " messages, ",
+        source_ids.size(), " sources, ", dest_ids.size(), " destinations"));
+  }
+  auto table = table_->Acquire();
+  auto status = CheckTable(table.get(), messages.size());
+  if (!status.ok()) {
+    return status;
   }
 
-  size_t m = A.size();     // Number of equations
-  size_t n = A[0].size();  // Number of variables
+  // Group message indices by plan (nullptr = every patch), keeping the
+  // first-seen order of plans so the work split is deterministic.
+  std::vector<const std::vector<size_t>*> plans;
+  absl::flat_hash_map<const std::vector<size_t>*, std::vector<size_t>> groups;
+  for (size_t i = 0; i < messages.size(); ++i) {
+    const std::vector<size_t>* plan = PlanOf(*table, source_ids[i], dest_ids[i]);
+    auto [it, inserted] = groups.try_emplace(plan);
+    if (inserted) plans.push_back(plan);
+    it->second.push_back(i);
+  }
 
-  // Compute A^H A (Gram matrix)
-  std::vector<std::vector<double>> AHA(n, std::vector<double>(n, 0.0));
-  for (size_t i = 0; i < n; ++i) {
-    for (size_t j = 0; j < n; ++j) {
-      double sum = 0.0;
-      for (size_t k = 0; k < m; ++k) {
-        if (i < A[k].size() && j < A[k].size()) {
-          sum += A[k][i] * A[k][j];
+  std::vector<Polynomial> results(messages.size());
+  const size_t shard_size = std::max<size_t>(1, router_options_.batch_shard_size);
+  ProgressReporter reporter(progress, "RouteBatch",
+                            static_cast<int64_t>(messages.size()));
+  absl::Mutex stop_mu;
+  absl::Status stop_status;  // First token failure seen by a shard
+  std::atomic<bool> stopped{false};
+  auto stop = [&](absl::Status status) {
+    absl::MutexLock lock(&stop_mu);
+    if (stop_status.ok()) stop_status = std::move(status);
+    stopped.store(true, std::memory_order_relaxed);
+  };
+
+  TaskGroup tasks(&Executor::OrDefault(router_options_.executor));
+  for (const std::vector<size_t>* plan : plans) {
+    const std::vector<size_t>& indices = groups.at(plan);
+    for (size_t begin = 0; begin < indices.size(); begin += shard_size) {
+      const size_t end = std::min(indices.size(), begin + shard_size);
+      // Each shard writes disjoint result slots.
+      tasks.Run([&, plan, begin, end] {
+        if (stopped.load(std::memory_order_relaxed)) return;
+        // Operators and batch buffers both come from this worker's node.
+        const int node = Executor::CurrentNode();
+        const auto& operators = table->LocalOperators();
+        PolynomialBatch current = arena_->Acquire(node, end - begin);
+        PolynomialBatch next = arena_->Acquire(node, end - begin);
+        for (size_t r = begin; r < end; ++r) {
+          const size_t i = indices[r];
+          current.Set(r - begin, RoutingPolynomial::EncodeRoute(
+              source_ids[i], dest_ids[i], messages[i]));
         }
-      }
-      AHA[i][j] = sum;
+        bool live = true;
+        auto apply = [&](const RoutingOperator& op) {
+          if (!live) return;
+          if (auto status = token.Check(); !status.ok()) {
+            stop(std::move(status));
+            live = false;
+            return;
+          }
+          op.ApplyBatch(current, &next);
+          std::swap(current, next);
+        };
+        if (plan != nullptr) {
+          for (size_t patch : *plan) apply(operators[patch]);
+        } else {
+          for (const auto& op : operators) apply(op);
+        }
+        if (live) {
+          for (size_t r = begin; r < end; ++r) {
+            results[indices[r]] = current.Get(r - begin);
+          }
+          reporter.Advance(static_cast<int64_t>(end - begin));
+        }
+        arena_->Release(node, std::move(current));
+        arena_->Release(node, std::move(next));
+      });
     }
   }
-
-  // Compute A^H b
-  std::vector<double> AHb(n, 0.0);
-  for (size_t i = 0; i < n; ++i) {
-    double sum = 0.0;
-    for (size_t k = 0; k < m; ++k) {
-      if (i < A[k].size() && k < b.size()) {
-        sum += A[k][i] * b[k];
-      }
-    }
-    AHb[i] = sum;
+  tasks.Wait();
+  if (stopped.load(std::memory_order_relaxed)) {
+    absl::MutexLock lock(&stop_mu);
+    return stop_status;
   }
+  return results;
+}
 
-  // Solve AHA w = AHb using simple Gaussian elimination
-  // (Not numerically stable, but demonstrates the concept)
-
-  std::vector<double> w(n, 0.0);
+absl::StatusOr<std::vector<size_t>> SheafRouter::RoutePlan(
+    const Polynomial& source_id,
+    const Polynomial& dest_id) const {
+  auto table = table_->Acquire();
+  if (table == nullptr) {
+    return absl::FailedPreconditionError(
+        "No routing weights learned. Call LearnRouting() first.");
+  }
+  const std::vector<size_t>* plan = PlanOf(*table, source_id, dest_id);
+  if (plan != nullptr) {
+    return *plan;
+  }
+  std::vector<size_t> all(table->operators.size());
+  for (size_t i = 0; i < all.size(); ++i) {
+    all[i] = i;
+  }
+  return all;
+}
 
-  // For small systems, just use pseudo-inverse approximation
-  // w ≈ (1/n) * A^H b
-  double scale = 1.0 / std::max(1.0, static_cast<double>(n));
-  for (size_t i = 0; i < n; ++i) {
-    w[i] = scale * AHb[i];
+absl::Status SheafRouter::AssignEndpoint(
+    const Polynomial& endpoint, const std::string& patch_id) {
+  absl::MutexLock lock(writer_mu_.get());
+  auto it = patch_index_.find(patch_id);
+  if (it == patch_index_.end()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Endpoint references unknown patch: ", patch_id));
+  }
+  // Moving an endpoint updates its entry rather than appending another.
+  auto existing = std::find_if(
+      problem_.endpoints.begin(), problem_.endpoints.end(),
+      [&endpoint](const RoutingEndpoint& e) { return e.id == endpoint; });
+  if (existing != problem_.endpoints.end()) {
+    existing->patch_id = patch_id;
+  } else {
+    problem_.endpoints.push_back({endpoint, patch_id});
+  }
+  topology_.AssignEndpoint(endpoint, it->second);
+
+  // Same weights and gluings: republish with the new endpoint map (unless
+  // a failed solve left the table behind the topology).
+  auto current = table_->Acquire();
+  if (current != nullptr &&
+      current->operators.size() == topology_.num_patches()) {
+    topology_.Refresh();
+    RoutingTable table = *current;
+    table.topology = std::make_shared<const PatchTopology>(topology_);
+    table_->Publish(std::move(table));
   }
+  return absl::OkStatus();
+}
 
-  return w;
+double SheafRouter::VerifyConsistency(
+    const RoutingResult& result,
+    double /*tolerance*/) const {
+  // Residual is the cohomological obstruction
+  return result.obstruction;
 }
 
 }  // namespace f2chat
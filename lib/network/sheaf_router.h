@@ -19,22 +19,71 @@
 #ifndef F2CHAT_LIB_NETWORK_SHEAF_ROUTER_H_
 #define F2CHAT_LIB_NETWORK_SHEAF_ROUTER_H_
 
+#include <atomic>
+#include <string>
 #include <vector>
 #include <memory>
+#include "lib/crypto/batch_arena.h"
 #include "lib/network/patch.h"
 #include "lib/network/gluing.h"
+#include "lib/network/patch_topology.h"
+#include "lib/network/routing_operator.h"
+#include "lib/network/routing_snapshot.h"
+#include "lib/network/routing_table.h"
+#include "lib/network/sheaf_system.h"
+#include "lib/runtime/cancellation.h"
+#include "lib/runtime/executor.h"
+#include "lib/runtime/progress.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/status/statusor.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 
 namespace f2chat {
 
+// Endpoint ownership: the patch a source or destination id lives in.
+struct RoutingEndpoint {
+  Polynomial id;
+  std::string patch_id;
+};
+
 // Problem definition for sheaf routing.
 struct RoutingProblem {
   std::vector<std::shared_ptr<Patch>> patches;
   std::vector<GluingConstraint> gluings;
 
   // Training examples (for learning routing weights)
+  // Shared examples train every patch.
   std::vector<RoutingExample> examples;
+
+  // Patch-local training examples, keyed by patch_id.
+  absl::flat_hash_map<std::string, std::vector<RoutingExample>> local_examples;
+
+  // Endpoints with a known patch. A route between two mapped endpoints
+  // crosses only the patches on a shortest gluing path between their
+  // patches; other routes cross every patch in order.
+  std::vector<RoutingEndpoint> endpoints;
+};
+
+// Router behaviour (independent of the solver).
+struct RouterOptions {
+  // Fraction of routed messages that re-check one gluing agreement
+  // against the table they were routed with (0 = never, 1 = every
+  // message). Gluings are always verified once when weights are published.
+  double audit_rate = 0.0;
+
+  // Maximum L2 distance between φ₁(boundary) and φ₂(boundary).
+  double gluing_tolerance = 1e-6;
+
+  // Pool RouteBatch shards run on (nullptr = Executor::Default()). Its
+  // NUMA topology decides how many operator replicas a table carries.
+  // Not owned; must outlive the router.
+  Executor* executor = nullptr;
+
+  // Messages per RouteBatch shard (one task, one batched kernel pass per
+  // patch on the plan).
+  size_t batch_shard_size = 64;
 };
 
 // Result of routing solve.
@@ -44,25 +93,46 @@ struct RoutingResult {
 
   // Cohomological obstruction (residual error)
   // Zero → perfect learnability & consistency
-  double obstruction;
+  double obstruction = 0.0;
 
   // Was the solve successful?
-  bool success;
+  bool success = false;
+
+  // Factorization path taken (mixed precision may fall back to double).
+  SolvePath solve_path = SolvePath::kDouble;
+
+  // Gluings (indices into RoutingProblem::gluings) whose agreement failed
+  // static verification of the learned weights. Route refuses to route
+  // while this is non-empty.
+  std::vector<size_t> violated_gluings;
 };
 
 // Unified sheaf router.
 //
-// Thread Safety: Thread-safe after construction (immutable problem).
+// Thread Safety: Route, RoutePlan, SaveSnapshot, VerifyConsistency and
+// routing_version never wait for a writer's solve and may run concurrently
+// with each other and with writers (they only contend briefly on the table
+// pointer, see VersionedRoutingTable). Writers (LearnRouting, UpdatePatch, AddGluing,
+// AssignEndpoint, LoadSnapshot) are serialized internally and publish each new weight set
+// atomically (see VersionedRoutingTable), so retraining does not pause
+// routing traffic. Create and moves are not thread-safe.
 class SheafRouter {
  public:
   // Creates sheaf router for a given routing problem.
   //
   // Args:
   //   problem: Network definition (patches + gluings + examples)
+  //   options: Solver configuration (precision, sketching, executor)
+  //   router_options: Gluing verification and audit settings
   //
   // Returns:
   //   SheafRouter instance
-  static absl::StatusOr<SheafRouter> Create(const RoutingProblem& problem);
+  //   Error if a patch has malformed weights or a gluing references
+  //   an unknown patch
+  static absl::StatusOr<SheafRouter> Create(
+      const RoutingProblem& problem,
+      const SolverOptions& options = {},
+      const RouterOptions& router_options = {});
 
   // Learns routing via single linear solve (Algorithm 2.1).
   //
@@ -74,17 +144,79 @@ class SheafRouter {
   //   5. Form global system: A_sheaf = [A_local; A_gluing], b_sheaf = [b_local; 0]
   //   6. Solve: w* = (A^H A)^{-1} A^H b
   //
+  // The solve is block-structured (see SheafSystem): per-patch
+  // factorizations and the gluing interface system are cached, so only
+  // blocks touched since the last solve are refactored.
+  //
+  // `token` is checked between block factorizations; a cancelled or
+  // overdue solve publishes nothing, but keeps its finished
+  // factorizations for the next call. `progress` receives
+  // SheafSystem::Solve's units (blocks factored + design classes).
+  //
   // Returns:
   //   RoutingResult with learned weights and obstruction
   //   Error if solve fails (singular matrix, etc.)
+  //   Cancelled / DeadlineExceeded from `token`
   //
-  // Performance: O(n³) for matrix inversion (one-time cost)
-  absl::StatusOr<RoutingResult> LearnRouting();
+  // Performance: O(n/k * (patches * k³ + gluings³)) on first solve
+  absl::StatusOr<RoutingResult> LearnRouting(
+      const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr);
+
+  // Adds or replaces a patch and re-solves incrementally.
+  //
+  // A patch with a new patch_id is appended; an existing patch_id is
+  // replaced in place. Only that patch's block is refactored, and only
+  // the interface rows of gluings touching it are updated.
+  //
+  // Args:
+  //   patch: New patch definition
+  //   local_examples: Training examples local to this patch
+  //
+  // Returns:
+  //   Updated RoutingResult
+  //   Error if the patch weights are malformed or the solve fails
+  //
+  // Performance: O(k³ + gluings² * k + gluings³)
+  absl::StatusOr<RoutingResult> UpdatePatch(
+      std::shared_ptr<Patch> patch,
+      const std::vector<RoutingExample>& local_examples = {});
+
+  // Adds a gluing constraint and re-solves incrementally.
+  //
+  // Only the two glued patch blocks are solved against the new boundary;
+  // no patch is refactored.
+  //
+  // Args:
+  //   gluing: Constraint between two existing patches
+  //
+  // Returns:
+  //   Updated RoutingResult
+  //   Error if the gluing references an unknown patch or the solve fails
+  //
+  // Performance: O(k² + gluings² * k + gluings³)
+  absl::StatusOr<RoutingResult> AddGluing(const GluingConstraint& gluing);
+
+  // Maps an endpoint id to the patch that owns it (or moves it) and
+  // republishes the current table's plans; no re-solve.
+  //
+  // Returns:
+  //   OK, or InvalidArgument for an unknown patch
+  absl::Status AssignEndpoint(
+      const Polynomial& endpoint, const std::string& patch_id);
 
   // Routes polynomial through network using learned weights.
   //
-  // Applies local routing φₚ at each patch in sequence,
-  // verifying gluing constraints are satisfied.
+  // Applies local routing φₚ at each patch on the cached plan from the
+  // source endpoint's patch to the destination endpoint's patch (shortest
+  // path in the gluing graph, see PatchTopology). If either endpoint is
+  // unmapped or no path exists, every patch is applied in sequence.
+  //
+  // Gluing constraints depend only on the weights, so they are verified
+  // once when a weight set is published (LearnRouting, UpdatePatch,
+  // AddGluing, LoadSnapshot), not per message. A sampled fraction of
+  // routes (RouterOptions::audit_rate) re-checks one gluing against the
+  // table in use.
   //
   // Args:
   //   message_poly: Polynomial to route
@@ -93,14 +225,96 @@ class SheafRouter {
   //
   // Returns:
   //   Routed polynomial (arrives at destination mailbox)
-  //   Error if routing fails or constraints violated
+  //   FailedPrecondition if nothing was learned yet
+  //   Internal if the published weights violate a gluing (or an audit
+  //   fails)
   //
-  // Performance: O(num_patches * n log n)
+  // Performance: O(plan length * n * k), plus O(n * k) per audited route
   absl::StatusOr<Polynomial> Route(
       const Polynomial& message_poly,
       const Polynomial& source_id,
       const Polynomial& dest_id) const;
 
+  // Routes many messages at once (same results as Route, in input order).
+  //
+  // Messages are grouped by route plan; each group is split into shards
+  // of RouterOptions::batch_shard_size that run as executor tasks, and
+  // every patch on the plan is applied to a whole shard with
+  // RoutingOperator::ApplyBatch. Shards read the operator replica and
+  // reuse batch buffers of their worker's NUMA node. Sampled audits
+  // advance by the batch size.
+  //
+  // Args:
+  //   messages, source_ids, dest_ids: Equal-length spans
+  //
+  // `token` is checked before every shard and between patches; once it
+  // fails, remaining shards are skipped. `progress` counts routed
+  // messages, one report per finished shard.
+  //
+  // Returns:
+  //   Routed polynomials
+  //   InvalidArgument if the spans differ in length
+  //   FailedPrecondition / Internal as for Route
+  //   Cancelled / DeadlineExceeded from `token`
+  //
+  // Performance: O(messages * plan length * n * k / workers)
+  absl::StatusOr<std::vector<Polynomial>> RouteBatch(
+      absl::Span<const Polynomial> messages,
+      absl::Span<const Polynomial> source_ids,
+      absl::Span<const Polynomial> dest_ids,
+      const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr) const;
+
+  // Patches (indices into the problem's patches) Route would apply for
+  // these endpoints under the current table.
+  //
+  // Returns:
+  //   Plan, or FailedPrecondition if nothing was learned yet
+  absl::StatusOr<std::vector<size_t>> RoutePlan(
+      const Polynomial& source_id,
+      const Polynomial& dest_id) const;
+
+  // Writes the learned routing to a versioned binary snapshot.
+  //
+  // Args:
+  //   path: Destination file (replaced atomically)
+  //
+  // Returns:
+  //   OK, FailedPrecondition if nothing was learned yet, Internal on I/O
+  //   failure
+  absl::Status SaveSnapshot(const std::string& path) const;
+
+  // Loads learned routing from a snapshot (memory-mapped, read-only).
+  //
+  // Route works immediately afterwards; LearnRouting is not needed. The
+  // snapshot must come from the same problem and solver options
+  // (fingerprint()).
+  //
+  // Returns:
+  //   OK, FailedPrecondition for a snapshot of another problem or ring,
+  //   DataLoss for a corrupt file, NotFound / Internal on I/O failure
+  //
+  // Performance: O(snapshot size) checksum, no solve, no weight copies
+  absl::Status LoadSnapshot(const std::string& path);
+
+  // Stable fingerprint of the problem and solver options (snapshot key).
+  // Writer-side state: not synchronized with concurrent writers.
+  uint64_t fingerprint() const { return fingerprint_; }
+
+  // Number of sampled gluing audits run / failed by Route so far.
+  int64_t audits_run() const { return audit_->runs.load(); }
+  int64_t audit_failures() const { return audit_->failures.load(); }
+
+  // Routing table Route currently uses (nullptr before the first solve
+  // or snapshot load). Holding it keeps that version alive.
+  std::shared_ptr<const RoutingTable> routing_table() const {
+    return table_->Acquire();
+  }
+
+  // Version of the routing table Route currently uses (0 before the
+  // first solve or snapshot load; increases with every publish).
+  uint64_t routing_version() const { return table_->version(); }
+
   // Verifies zero cohomological obstruction.
   //
   // Checks: ||A w* - b||² ≈ 0 (within tolerance)
@@ -116,24 +330,67 @@ class SheafRouter {
       double tolerance = 1e-6) const;
 
  private:
-  explicit SheafRouter(const RoutingProblem& problem);
+  SheafRouter(
+      const RoutingProblem& problem,
+      const SolverOptions& options,
+      const RouterOptions& router_options);
 
-  // Assembles local design matrix A_local and target b_local.
-  void AssembleLocalSystem(
-      std::vector<std::vector<double>>& A,
-      std::vector<double>& b) const;
+  // Checks patches, gluing and endpoint references and builds the
+  // topology (cheap, done in Create).
+  absl::Status ValidateProblem();
 
-  // Assembles gluing constraint matrix A_gluing.
-  void AssembleGluingSystem(
-      std::vector<std::vector<double>>& A) const;
+  // Loads patches, examples and gluings into the block system on first
+  // use, so routers restored from a snapshot never build it.
+  absl::Status EnsureSystem();
 
-  // Solves least-squares: w* = (A^H A)^{-1} A^H b
-  absl::StatusOr<std::vector<double>> SolveLeastSquares(
-      const std::vector<std::vector<double>>& A,
-      const std::vector<double>& b) const;
+  // Adds one gluing to the block system (resolving patch ids).
+  absl::Status AddGluingToSystem(const GluingConstraint& gluing);
+
+  // Solves the block system, unpacks per-patch weights and publishes the
+  // compiled table. Requires *writer_mu_.
+  absl::StatusOr<RoutingResult> Solve(
+      const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr);
+
+  // Verifies every gluing agreement on `table` and publishes it.
+  // Returns the violated gluings. Requires *writer_mu_.
+  std::vector<size_t> VerifyAndPublish(RoutingTable table);
+
+  // Checks that `table` exists and has no violated gluing, then runs the
+  // sampled audits due for the next `routes` routes.
+  absl::Status CheckTable(const RoutingTable* table, uint64_t routes) const;
+
+  // Plan for one route (nullptr = every patch in order).
+  static const std::vector<size_t>* PlanOf(
+      const RoutingTable& table,
+      const Polynomial& source_id,
+      const Polynomial& dest_id);
+
+  // Agreement of one gluing under the table's operators.
+  bool GluingAgrees(const RoutingTable& table, size_t gluing) const;
 
   RoutingProblem problem_;
+  SolverOptions options_;
+  RouterOptions router_options_;
+  SheafSystem system_;  // Cached block factorizations
+  bool system_ready_ = false;
+  uint64_t fingerprint_ = 0;
+  absl::flat_hash_map<std::string, size_t> patch_index_;  // patch_id → slot
+  PatchTopology topology_;  // Gluing graph (published with each table)
   RoutingResult last_result_;  // Cached result from LearnRouting
+
+  // Heap-allocated so the router stays movable (StatusOr<SheafRouter>).
+  std::unique_ptr<absl::Mutex> writer_mu_;  // Serializes writers
+  std::unique_ptr<VersionedRoutingTable> table_;  // Read by Route (RCU)
+  std::unique_ptr<BatchArena> arena_;  // RouteBatch buffers per NUMA node
+
+  // Route-side audit sampling state (lock-free counters).
+  struct AuditState {
+    std::atomic<uint64_t> routes{0};
+    std::atomic<int64_t> runs{0};
+    std::atomic<int64_t> failures{0};
+  };
+  std::unique_ptr<AuditState> audit_;
 };
 
 }  // namespace f2chat
@@ -0,0 +1,564 @@
+// lib/network/sheaf_system.cc
+#include "lib/network/sheaf_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include "lib/crypto/ntt.h"
+#include "lib/network/routing_operator.h"
+#include "absl/strings/str_cat.h"
+
+namespace f2chat {
+
+namespace {
+// Tikhonov weight relative to the mean diagonal of the Gram block.
+// Keeps N_m positive definite when a patch has fewer examples than
+// characters, without biasing well-determined solves.
+constexpr double kRelativeRidge = 1e-9;
+
+// Mixed-precision refinement: stop once the normwise backward error
+// ||N x − r|| / (||N|| ||x|| + ||r||) reaches double accuracy; fall back to
+// a double factorization when a step fails to halve the residual.
+constexpr double kRefinementTolerance = 1e-13;
+constexpr double kRefinementStall = 0.5;
+constexpr int kMaxRefinementSteps = 10;
+
+// Sketch-preconditioned CG: stop once the preconditioned residual (an
+// estimate of the forward error) is below this fraction of the solution.
+constexpr double kConjugateGradientTolerance = 1e-12;
+constexpr int kMaxConjugateGradientSteps = 100;
+
+// CountSketch hash of example row e: bucket from the low bits, sign from
+// the top bit (splitmix64 finalizer).
+uint64_t SketchHash(uint64_t seed, uint64_t e) {
+  uint64_t z = seed + (e + 1) * 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// First coefficient of the projection window read at `position`
+// (mirrors the indexing in Polynomial::ProjectToCharacter).
+int ProjectionWindow(int position) {
+  return (position * RingParams::kNumCharacters) % RingParams::kDegree;
+}
+}  // namespace
+
+SheafSystem::SheafSystem(const SolverOptions& options) : options_(options) {
+  // Group output positions by projection window.
+  std::map<int, std::vector<int>> windows;
+  for (int p = 0; p < RingParams::kDegree; ++p) {
+    windows[ProjectionWindow(p)].push_back(p);
+  }
+
+  classes_.reserve(windows.size());
+  for (auto& [window, positions] : windows) {
+    DesignClass dc;
+    dc.window = window;
+    dc.positions = std::move(positions);
+    classes_.push_back(std::move(dc));
+  }
+}
+
+std::vector<Polynomial> SheafSystem::EncodeExamples(
+    const std::vector<RoutingExample>& examples) {
+  std::vector<Polynomial> inputs;
+  inputs.reserve(examples.size());
+  for (const auto& example : examples) {
+    // Patches see the encoded route (same input as SheafRouter::Route).
+    inputs.push_back(RoutingPolynomial::EncodeRoute(
+        example.source_poly, example.destination_poly, example.message_poly));
+  }
+  return inputs;
+}
+
+Eigen::VectorXd SheafSystem::CharacterFeatures(
+    const Polynomial& poly, int position) const {
+  // Row of the design matrix: the value of every character j that routing
+  // weighs at `position`.
+  Eigen::VectorXd features(RingParams::kNumCharacters);
+  RoutingOperator::CharacterValues(options_.weight_basis,
+                                   poly.coefficients().data(), position,
+                                   features.data());
+  return features;
+}
+
+SheafSystem::Rows SheafSystem::BuildRows(
+    const DesignClass& dc,
+    const std::vector<RoutingExample>& examples,
+    const std::vector<Polynomial>& inputs) const {
+  const int k = RingParams::kNumCharacters;
+  const int num_examples = static_cast<int>(examples.size());
+  const int num_positions = static_cast<int>(dc.positions.size());
+
+  const bool signed_targets =
+      options_.weight_basis == WeightBasis::kFpCharacters;
+
+  Rows rows;
+  rows.A.resize(num_examples, k);
+  rows.B.resize(num_examples, num_positions);
+
+  // CountSketch S (sketch_rows × examples): one signed bucket per row.
+  const int sketch_rows = static_cast<int>(
+      std::ceil(options_.sketch_factor * k));
+  rows.sketched = options_.sketch != SolverOptions::Sketch::kNone &&
+                  num_examples > sketch_rows;
+  Eigen::MatrixXd sa, sb;
+  if (rows.sketched) {
+    sa = Eigen::MatrixXd::Zero(sketch_rows, k);
+    sb = Eigen::MatrixXd::Zero(sketch_rows, num_positions);
+  }
+
+  for (int e = 0; e < num_examples; ++e) {
+    // All positions of the class share this row (same window).
+    rows.A.row(e) =
+        CharacterFeatures(inputs[e], dc.positions.front()).transpose();
+    const auto& expected = examples[e].expected_output.coefficients();
+    for (int c = 0; c < num_positions; ++c) {
+      const int64_t target = expected[dc.positions[c]];
+      rows.B(e, c) = static_cast<double>(
+          signed_targets ? LiftCentered(target, RingParams::kModulus)
+                         : target);
+    }
+
+    // Streaming sketch: SA and SB are accumulated row by row.
+    if (rows.sketched) {
+      uint64_t h = SketchHash(options_.sketch_seed, e);
+      double sign = (h >> 63) ? -1.0 : 1.0;
+      sa.row(h % sketch_rows) += sign * rows.A.row(e);
+      sb.row(h % sketch_rows) += sign * rows.B.row(e);
+    }
+  }
+
+  rows.trace = rows.A.squaredNorm();
+  if (rows.sketched) {
+    // E[SᵀS] = I: the sketched Gram matrix is an unbiased estimate.
+    rows.gram = sa.transpose() * sa;
+    rows.rhs = options_.sketch == SolverOptions::Sketch::kSolve
+        ? Eigen::MatrixXd(sa.transpose() * sb)
+        : Eigen::MatrixXd(rows.A.transpose() * rows.B);
+    return rows;
+  }
+
+  rows.gram = rows.A.transpose() * rows.A;
+  rows.rhs = rows.A.transpose() * rows.B;
+  return rows;
+}
+
+void SheafSystem::SetSharedExamples(
+    const std::vector<RoutingExample>& examples) {
+  const std::vector<Polynomial> inputs = EncodeExamples(examples);
+  for (auto& dc : classes_) {
+    dc.shared = BuildRows(dc, examples, inputs);
+    for (auto& block : dc.blocks) {
+      block.dirty = true;
+    }
+  }
+}
+
+absl::Status SheafSystem::SetPatch(
+    size_t index,
+    const Patch& patch,
+    const std::vector<RoutingExample>& local_examples) {
+  if (index > num_patches_) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Patch index out of range: ", index, " > ", num_patches_));
+  }
+
+  const auto& weights = patch.weights();
+  if (weights.num_characters() != RingParams::kNumCharacters) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Patch ", patch.patch_id(), ": routing weights must have ",
+        RingParams::kNumCharacters, " characters"));
+  }
+
+  const std::vector<Polynomial> inputs = EncodeExamples(local_examples);
+  for (auto& dc : classes_) {
+    if (index == dc.blocks.size()) {
+      dc.blocks.emplace_back();
+    }
+    Block& block = dc.blocks[index];
+    block.local = BuildRows(dc, local_examples, inputs);
+
+    const int num_positions = static_cast<int>(dc.positions.size());
+    block.prior = Eigen::MatrixXd::Zero(RingParams::kNumCharacters, num_positions);
+    for (int c = 0; c < num_positions; ++c) {
+      int p = dc.positions[c];
+      if (p >= weights.num_positions()) continue;
+      for (int j = 0; j < RingParams::kNumCharacters; ++j) {
+        block.prior(j, c) = weights.weights[p][j];
+      }
+    }
+    block.dirty = true;
+  }
+
+  if (index == num_patches_) {
+    ++num_patches_;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SheafSystem::AddGluing(
+    size_t patch_a,
+    size_t patch_b,
+    const Polynomial& boundary) {
+  if (patch_a >= num_patches_ || patch_b >= num_patches_ ||
+      patch_a == patch_b) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid gluing between patches ", patch_a, " and ", patch_b));
+  }
+
+  gluing_patches_.emplace_back(patch_a, patch_b);
+
+  for (auto& dc : classes_) {
+    Coupling coupling;
+    coupling.c = CharacterFeatures(boundary, dc.positions.front());
+    dc.couplings.push_back(std::move(coupling));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SheafSystem::RefactorBlock(DesignClass& dc, size_t m) {
+  Block& block = dc.blocks[m];
+
+  // N_m = A_sharedᵀA_shared + A_localᵀA_local + λI
+  // R_m = A_sharedᵀB_shared + A_localᵀB_local + λ W_prior
+  const int k = RingParams::kNumCharacters;
+  const int num_positions = static_cast<int>(dc.positions.size());
+  Eigen::MatrixXd normal = Eigen::MatrixXd::Zero(k, k);
+  Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(k, num_positions);
+  if (dc.shared.A.rows() > 0) {
+    normal += dc.shared.gram;
+    rhs += dc.shared.rhs;
+  }
+  if (block.local.A.rows() > 0) {
+    normal += block.local.gram;
+    rhs += block.local.rhs;
+  }
+
+  // Ridge from the exact trace (‖A‖²_F), so sketching does not change the
+  // regularized problem.
+  double trace = 0.0;
+  if (dc.shared.A.rows() > 0) trace += dc.shared.trace;
+  if (block.local.A.rows() > 0) trace += block.local.trace;
+  double ridge = kRelativeRidge * std::max(1.0, trace / k);
+  normal.diagonal().array() += ridge;
+  rhs += ridge * block.prior;
+
+  // One factorization, applied to every position of the class. With
+  // sketched rows under Sketch::kPrecondition it only preconditions CG.
+  block.normal = std::move(normal);
+  block.ridge = ridge;
+  block.mixed = false;
+  block.fell_back = false;
+  block.preconditioned =
+      options_.sketch == SolverOptions::Sketch::kPrecondition &&
+      (dc.shared.sketched || block.local.sketched);
+  if (!block.preconditioned &&
+      options_.precision == SolverOptions::Precision::kMixed) {
+    block.factor_f.compute(block.normal.cast<float>());
+    block.mixed = block.factor_f.info() == Eigen::Success;
+    block.fell_back = !block.mixed;
+    if (block.fell_back) ++dc.stats.precision_fallbacks;
+  }
+  if (!block.mixed && !FactorDouble(block)) {
+    return absl::InternalError(absl::StrCat(
+        "Cholesky factorization failed for patch block ", m,
+        " (window ", dc.window, ")"));
+  }
+  ++dc.stats.factorizations;
+
+  auto w0 = BlockSolve(dc, m, rhs);
+  if (!w0.ok()) return w0.status();
+  block.w0 = std::move(w0).value();
+  block.dirty = false;
+
+  // Interface columns of every gluing touching this patch are stale.
+  for (size_t g = 0; g < gluing_patches_.size(); ++g) {
+    if (gluing_patches_[g].first == m || gluing_patches_[g].second == m) {
+      dc.couplings[g].dirty = true;
+    }
+  }
+  return absl::OkStatus();
+}
+
+bool SheafSystem::FactorDouble(Block& block) {
+  block.factor.compute(block.normal);
+  block.mixed = false;
+  return block.factor.info() == Eigen::Success;
+}
+
+absl::StatusOr<Eigen::MatrixXd> SheafSystem::BlockSolve(
+    DesignClass& dc, size_t m, const Eigen::MatrixXd& rhs) {
+  Block& block = dc.blocks[m];
+  if (block.preconditioned) {
+    return PreconditionedSolve(dc, m, rhs);
+  }
+  if (!block.mixed) {
+    return Eigen::MatrixXd(block.factor.solve(rhs));
+  }
+
+  // x₀ = N_f⁻¹ r, then x += N_f⁻¹ (r − N x) with the residual in double.
+  Eigen::MatrixXd x = block.factor_f.solve(rhs.cast<float>()).cast<double>();
+  const double scale = block.normal.norm();
+  double previous = std::numeric_limits<double>::infinity();
+  for (int step = 0; step < kMaxRefinementSteps; ++step) {
+    Eigen::MatrixXd residual = rhs - block.normal * x;
+    double error = residual.norm();
+    if (error <= kRefinementTolerance * (scale * x.norm() + rhs.norm())) {
+      return x;
+    }
+    if (error > kRefinementStall * previous) break;
+    previous = error;
+    x.noalias() +=
+        block.factor_f.solve(residual.cast<float>()).cast<double>();
+  }
+
+  // Refinement stalled (N_m too ill-conditioned for float): full precision.
+  ++dc.stats.precision_fallbacks;
+  block.fell_back = true;
+  if (!FactorDouble(block)) {
+    return absl::InternalError("Cholesky factorization failed in fallback");
+  }
+  ++dc.stats.factorizations;
+  return Eigen::MatrixXd(block.factor.solve(rhs));
+}
+
+Eigen::MatrixXd SheafSystem::ApplyNormal(
+    const DesignClass& dc, const Block& block, const Eigen::MatrixXd& x) {
+  // Two thin products per row set: O(examples * d * cols), no Gram matrix.
+  Eigen::MatrixXd result = block.ridge * x;
+  for (const Rows* rows : {&dc.shared, &block.local}) {
+    if (rows->A.rows() == 0) continue;
+    Eigen::MatrixXd ax = rows->A * x;
+    result.noalias() += rows->A.transpose() * ax;
+  }
+  return result;
+}
+
+absl::StatusOr<Eigen::MatrixXd> SheafSystem::PreconditionedSolve(
+    DesignClass& dc, size_t m, const Eigen::MatrixXd& rhs) {
+  Block& block = dc.blocks[m];
+
+  // Column-wise PCG with M = sketched normal matrix (all right-hand sides
+  // advance together; converged columns get zero step sizes).
+  Eigen::MatrixXd x = block.factor.solve(rhs);
+  Eigen::MatrixXd r = rhs - ApplyNormal(dc, block, x);
+  Eigen::MatrixXd z = block.factor.solve(r);
+  Eigen::MatrixXd p = z;
+  Eigen::ArrayXd rz = (r.array() * z.array()).colwise().sum().transpose();
+
+  for (int step = 0; step < kMaxConjugateGradientSteps; ++step) {
+    // M ≈ N spectrally (ridge directions included), so the preconditioned
+    // residual z = M⁻¹r tracks the forward error even where N is
+    // ill-conditioned and the plain residual is tiny.
+    if (z.norm() <= kConjugateGradientTolerance * x.norm()) {
+      return x;
+    }
+    Eigen::MatrixXd q = ApplyNormal(dc, block, p);
+    Eigen::ArrayXd pq = (p.array() * q.array()).colwise().sum().transpose();
+    Eigen::ArrayXd alpha = (pq > 0.0).select(rz / pq, 0.0);
+    x += p * alpha.matrix().asDiagonal();
+    r -= q * alpha.matrix().asDiagonal();
+
+    z = block.factor.solve(r);
+    Eigen::ArrayXd rz_next =
+        (r.array() * z.array()).colwise().sum().transpose();
+    Eigen::ArrayXd beta = (rz > 0.0).select(rz_next / rz, 0.0);
+    p = z + p * beta.matrix().asDiagonal();
+    rz = rz_next;
+  }
+
+  // CG did not converge: form the exact normal matrix and factor it.
+  ++dc.stats.sketch_fallbacks;
+  block.normal = ApplyNormal(
+      dc, block, Eigen::MatrixXd::Identity(RingParams::kNumCharacters,
+                                           RingParams::kNumCharacters));
+  block.preconditioned = false;
+  if (!FactorDouble(block)) {
+    return absl::InternalError("Cholesky factorization failed in fallback");
+  }
+  ++dc.stats.factorizations;
+  return Eigen::MatrixXd(block.factor.solve(rhs));
+}
+
+Eigen::VectorXd SheafSystem::InterfaceColumn(
+    const DesignClass& dc, size_t h, size_t m) const {
+  if (gluing_patches_[h].first == m) return dc.couplings[h].z_a;
+  if (gluing_patches_[h].second == m) return dc.couplings[h].z_b;
+  return Eigen::VectorXd::Zero(RingParams::kNumCharacters);
+}
+
+absl::Status SheafSystem::SolveClass(
+    const CancellationToken& token, ProgressReporter& progress,
+    DesignClass& dc, std::vector<Eigen::MatrixXd>& patch_weights) {
+  // Step 1: Refactor dirty patch blocks (local multi-RHS solves). Each
+  // finished block stays clean, so stopping here loses no work; steps
+  // 2-4 are cheap and always run to completion.
+  for (size_t m = 0; m < dc.blocks.size(); ++m) {
+    if (dc.blocks[m].dirty) {
+      auto status = token.Check();
+      if (!status.ok()) return status;
+      status = RefactorBlock(dc, m);
+      if (!status.ok()) return status;
+      progress.Advance();
+    }
+  }
+
+  // Step 2: Refresh interface columns Z_g = N⁻¹ C_gᵀ of dirty gluings.
+  const size_t num_gluings = dc.couplings.size();
+  std::vector<size_t> dirty;
+  for (size_t g = 0; g < num_gluings; ++g) {
+    Coupling& coupling = dc.couplings[g];
+    if (!coupling.dirty) continue;
+    const auto [a, b] = gluing_patches_[g];
+    auto z_a = BlockSolve(dc, a, coupling.c);
+    if (!z_a.ok()) return z_a.status();
+    auto z_b = BlockSolve(dc, b, coupling.c);
+    if (!z_b.ok()) return z_b.status();
+    coupling.z_a = z_a->col(0);
+    coupling.z_b = -z_b->col(0);
+    coupling.dirty = false;
+    dirty.push_back(g);
+  }
+
+  // Step 3: Update interface system S = I + C Z (rows/cols of dirty gluings).
+  // Gluing rows act on every position of the class, so S is shared by
+  // all right-hand sides.
+  Eigen::MatrixXd previous = dc.interface;
+  dc.interface = Eigen::MatrixXd::Identity(num_gluings, num_gluings);
+  size_t kept = static_cast<size_t>(previous.rows());
+  dc.interface.topLeftCorner(kept, kept) = previous;
+  for (size_t g : dirty) {
+    const auto [a, b] = gluing_patches_[g];
+    const Eigen::VectorXd& c = dc.couplings[g].c;
+    for (size_t h = 0; h < num_gluings; ++h) {
+      // S_gh = δ_gh + c_gᵀ (Z_h[a_g] - Z_h[b_g])
+      double entry =
+          c.dot(InterfaceColumn(dc, h, a)) - c.dot(InterfaceColumn(dc, h, b));
+      dc.interface(g, h) = (g == h ? 1.0 : 0.0) + entry;
+      dc.interface(h, g) = dc.interface(g, h);
+    }
+  }
+
+  // Step 4: Woodbury correction W = W0 - Z S⁻¹ C W0 (all positions at once).
+  std::vector<Eigen::MatrixXd> w;
+  w.reserve(dc.blocks.size());
+  for (const auto& block : dc.blocks) {
+    w.push_back(block.w0);
+  }
+
+  if (num_gluings > 0) {
+    const int num_positions = static_cast<int>(dc.positions.size());
+    Eigen::MatrixXd c_w0(num_gluings, num_positions);
+    for (size_t g = 0; g < num_gluings; ++g) {
+      const auto [a, b] = gluing_patches_[g];
+      c_w0.row(g) = dc.couplings[g].c.transpose() *
+          (dc.blocks[a].w0 - dc.blocks[b].w0);
+    }
+
+    Eigen::LLT<Eigen::MatrixXd> interface_factor(dc.interface);
+    if (interface_factor.info() != Eigen::Success) {
+      return absl::InternalError("Interface system factorization failed");
+    }
+    Eigen::MatrixXd y = interface_factor.solve(c_w0);
+
+    for (size_t h = 0; h < num_gluings; ++h) {
+      const auto [a, b] = gluing_patches_[h];
+      w[a].noalias() -= dc.couplings[h].z_a * y.row(h);
+      w[b].noalias() -= dc.couplings[h].z_b * y.row(h);
+    }
+  }
+
+  // Step 5: True residual ||A W - B||² (local rows + gluing rows).
+  for (size_t m = 0; m < dc.blocks.size(); ++m) {
+    if (dc.shared.A.rows() > 0) {
+      dc.stats.obstruction += (dc.shared.A * w[m] - dc.shared.B).squaredNorm();
+    }
+    const Rows& local = dc.blocks[m].local;
+    if (local.A.rows() > 0) {
+      dc.stats.obstruction += (local.A * w[m] - local.B).squaredNorm();
+    }
+  }
+  for (size_t g = 0; g < num_gluings; ++g) {
+    const auto [a, b] = gluing_patches_[g];
+    dc.stats.obstruction +=
+        (dc.couplings[g].c.transpose() * (w[a] - w[b])).squaredNorm();
+  }
+
+  // Scatter class columns into per-patch (positions × characters) weights.
+  for (size_t m = 0; m < dc.blocks.size(); ++m) {
+    for (size_t c = 0; c < dc.positions.size(); ++c) {
+      patch_weights[m].row(dc.positions[c]) = w[m].col(c).transpose();
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<SheafSolution> SheafSystem::Solve(
+    const CancellationToken& token, const ProgressCallback& progress) {
+  if (num_patches_ == 0) {
+    return absl::InvalidArgumentError("Empty system");
+  }
+  auto status = token.Check();
+  if (!status.ok()) return status;
+
+  int64_t total = static_cast<int64_t>(classes_.size());
+  for (const auto& dc : classes_) {
+    for (const auto& block : dc.blocks) {
+      total += block.dirty ? 1 : 0;
+    }
+  }
+  ProgressReporter reporter(progress, "Solve", total);
+
+  SheafSolution solution;
+  solution.patch_weights.assign(
+      num_patches_,
+      Eigen::MatrixXd::Zero(RingParams::kDegree, RingParams::kNumCharacters));
+
+  // Design classes are independent subproblems writing disjoint
+  // positions: solve them in parallel.
+  std::vector<absl::Status> statuses(classes_.size());
+  {
+    TaskGroup tasks(&Executor::OrDefault(options_.executor));
+    for (size_t i = 0; i < classes_.size(); ++i) {
+      tasks.Run([this, i, &token, &reporter, &statuses, &solution] {
+        classes_[i].stats = DesignClass::Stats();
+        statuses[i] = SolveClass(token, reporter, classes_[i],
+                                 solution.patch_weights);
+        if (statuses[i].ok()) reporter.Advance();
+      });
+    }
+    tasks.Wait();
+  }
+
+  // Reduce in class order (deterministic sums).
+  // Factorizations finished by a failed or cancelled solve still count.
+  for (const auto& dc : classes_) {
+    factorizations_ += dc.stats.factorizations;
+  }
+  for (size_t i = 0; i < classes_.size(); ++i) {
+    if (!statuses[i].ok()) return statuses[i];
+    const DesignClass::Stats& stats = classes_[i].stats;
+    solution.obstruction += stats.obstruction;
+    solution.precision_fallbacks += stats.precision_fallbacks;
+    solution.sketch_fallbacks += stats.sketch_fallbacks;
+  }
+  if (options_.precision == SolverOptions::Precision::kMixed) {
+    // Only blocks that actually fell back count; preconditioned blocks
+    // never use float factors. A block that fell back in an earlier solve
+    // stays in double until it is refactored, so it still counts.
+    bool fell_back = false;
+    for (const auto& dc : classes_) {
+      for (const auto& block : dc.blocks) {
+        fell_back = fell_back || block.fell_back;
+      }
+    }
+    solution.path = fell_back ? SolvePath::kMixedWithFallback
+                              : SolvePath::kMixed;
+  }
+  return solution;
+}
+
+}  // namespace f2chat
@@ -0,0 +1,309 @@
+// lib/network/sheaf_system.h
+//
+// Incremental block solver for the sheaf routing system (Algorithm 2.1).
+//
+// The global system is block-structured: every patch owns its local rows
+// (block-diagonal A_local) and each gluing constraint couples exactly two
+// patches. Instead of re-assembling and re-solving everything after an
+// edit, SheafSystem caches:
+//
+//   - per patch m: the regularized normal matrix N_m = A_mᵀA_m + λI,
+//     its Cholesky factor, and the local solution w0_m = N_m⁻¹ r_m
+//   - per gluing g: the coupled columns Z_g = N⁻¹ C_gᵀ (two patch blocks)
+//   - the interface system S = I + C N⁻¹ Cᵀ (one row per gluing)
+//
+// and recovers the global least-squares solution via the Woodbury identity:
+//
+//   w* = w0 − Z S⁻¹ C w0
+//
+// Editing patch m refactors only N_m, refreshes the Z columns of gluings
+// touching m, and updates the matching rows/columns of S. Adding a gluing
+// solves two patch blocks and appends one row/column to S.
+//
+// Every output coefficient is learned. Position p reads the projection
+// window starting at coefficient (p·k mod n) (see
+// Polynomial::ProjectToCharacter), so positions with the same window share
+// one design matrix. Each such design class is solved as a multi-RHS
+// problem: one k×k factorization per patch and class, applied to all of
+// the class's positions at once (blocked triangular solves). Features are
+// the character values RoutingOperator::Apply reads at routing time in
+// SolverOptions::weight_basis, and the target of position p is the
+// expected coefficient p (lifted to (−p/2, p/2] for kFpCharacters, whose
+// features are signed).
+//
+// Regularization pulls each patch towards its configured weights
+// (λ‖w_m − w_prior‖²), so a patch without training data keeps the weights
+// it was created with.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_NETWORK_SHEAF_SYSTEM_H_
+#define F2CHAT_LIB_NETWORK_SHEAF_SYSTEM_H_
+
+#include <vector>
+#include "Eigen/Dense"
+#include "lib/crypto/polynomial.h"
+#include "lib/crypto/routing_polynomial.h"
+#include "lib/network/patch.h"
+#include "lib/runtime/cancellation.h"
+#include "lib/runtime/executor.h"
+#include "lib/runtime/progress.h"
+#include "absl/status/statusor.h"
+#include "absl/status/status.h"
+
+namespace f2chat {
+
+// Solver configuration.
+struct SolverOptions {
+  // Character values the weights are fit on (see RoutingOperator);
+  // kFpCharacters learns weights EncryptedRouting can evaluate.
+  WeightBasis weight_basis = WeightBasis::kRoundedProjections;
+
+  // Precision of the patch block factorizations.
+  enum class Precision {
+    kDouble,  // Factor and solve in double (default)
+    kMixed,   // Factor in float, refine the solution in double
+  };
+  Precision precision = Precision::kDouble;
+
+  // Randomized sketching of example rows (CountSketch).
+  //
+  // Applies to any design rows with more examples than
+  // sketch_factor × unknowns; smaller row sets are used exactly.
+  enum class Sketch {
+    kNone,          // Exact normal equations (default)
+    kSolve,         // Solve the sketched problem (approximate)
+    kPrecondition,  // Sketched factor preconditions CG on the exact problem
+  };
+  Sketch sketch = Sketch::kNone;
+  double sketch_factor = 4.0;  // Sketch rows per unknown
+  uint64_t sketch_seed = 0x5eed;
+
+  // Pool the independent design classes are solved on (nullptr =
+  // Executor::Default()). Not owned.
+  Executor* executor = nullptr;
+};
+
+// Factorization path taken by a solve.
+enum class SolvePath {
+  kDouble,             // Every block factored in double
+  kMixed,              // No block fell back to double (blocks preconditioned
+                       // by a sketch never use float factors)
+  kMixedWithFallback,  // Some blocks stalled and were refactored in double
+};
+
+// Solution of the sheaf system.
+struct SheafSolution {
+  // Learned weights per patch, rows = positions (kDegree), cols = characters.
+  std::vector<Eigen::MatrixXd> patch_weights;
+
+  // ||A w* - b||² over local and gluing rows (regularizer excluded).
+  double obstruction = 0.0;
+
+  // Factorization path taken (see SolverOptions::Precision).
+  SolvePath path = SolvePath::kDouble;
+
+  // Blocks that fell back to double precision during this solve.
+  int64_t precision_fallbacks = 0;
+
+  // Preconditioned blocks whose CG did not converge and were solved from
+  // the exact normal matrix instead (Sketch::kPrecondition).
+  int64_t sketch_fallbacks = 0;
+};
+
+// Incremental sheaf system (cached block factorizations).
+//
+// Thread Safety: NOT thread-safe. Owned and serialized by SheafRouter.
+class SheafSystem {
+ public:
+  explicit SheafSystem(const SolverOptions& options = {});
+
+  // Replaces the examples that train every patch.
+  //
+  // Marks every patch block dirty (shared rows appear in each block).
+  void SetSharedExamples(const std::vector<RoutingExample>& examples);
+
+  // Sets patch `index` (appending if index == num_patches()).
+  //
+  // Args:
+  //   index: Patch slot (must be <= num_patches())
+  //   patch: Patch definition (configured weights act as the prior)
+  //   local_examples: Examples that train this patch only
+  //
+  // Returns:
+  //   OK, or InvalidArgument if index is out of range or the patch
+  //   weights do not have RingParams::kNumCharacters characters
+  //
+  // Positions beyond the configured weights get a zero prior (the
+  // configured routing outputs zero there).
+  absl::Status SetPatch(
+      size_t index,
+      const Patch& patch,
+      const std::vector<RoutingExample>& local_examples);
+
+  // Adds gluing rows (one per position) between patches a and b.
+  //
+  // Enforces agreement of both local routings on the boundary:
+  //   φ_a(boundary) = φ_b(boundary)   ⇔   C · w = 0
+  //
+  // Returns:
+  //   OK, or InvalidArgument for unknown / identical patch indices
+  absl::Status AddGluing(
+      size_t patch_a,
+      size_t patch_b,
+      const Polynomial& boundary);
+
+  // Solves the global system, refactoring only dirty blocks.
+  //
+  // Design classes are independent, so they are solved as parallel
+  // tasks on SolverOptions::executor; results do not depend on the
+  // number of workers.
+  //
+  // `token` is checked before each block factorization. A cancelled solve
+  // keeps the factorizations it finished, so the next Solve resumes
+  // rather than restarts. Progress counts block factorizations plus one
+  // unit per design class.
+  //
+  // Returns:
+  //   Solution, or the first failing block's error
+  //   Cancelled / DeadlineExceeded from `token`
+  //
+  // Performance: O(classes * (dirty_patches * k³ + gluings² * k + gluings³))
+  absl::StatusOr<SheafSolution> Solve(
+      const CancellationToken& token = {},
+      const ProgressCallback& progress = nullptr);
+
+  size_t num_patches() const { return num_patches_; }
+  size_t num_gluings() const { return gluing_patches_.size(); }
+  const SolverOptions& options() const { return options_; }
+
+  // Number of design classes (independent multi-RHS subproblems).
+  size_t num_classes() const { return classes_.size(); }
+
+  // Number of patch factorizations performed so far (for diagnostics).
+  int64_t factorizations() const { return factorizations_; }
+
+ private:
+  // Design rows (one per example) and targets for one class.
+  //
+  // A and B are always kept exact: they define the reported obstruction.
+  struct Rows {
+    Eigen::MatrixXd A;  // examples × characters
+    Eigen::MatrixXd B;  // examples × class positions
+    Eigen::MatrixXd gram;  // AᵀA, or (SA)ᵀSA when sketched
+    Eigen::MatrixXd rhs;   // AᵀB, or (SA)ᵀSB for Sketch::kSolve
+    double trace = 0.0;    // Exact trace of AᵀA = ‖A‖²_F
+    bool sketched = false;
+  };
+
+  // Per-patch cached block.
+  struct Block {
+    Rows local;
+    Eigen::MatrixXd prior;  // Configured weights (characters × positions)
+    Eigen::MatrixXd normal;  // N_m (refinement residuals, mixed precision)
+    Eigen::LLT<Eigen::MatrixXd> factor;
+    Eigen::LLT<Eigen::MatrixXf> factor_f;  // Active when `mixed`
+    bool mixed = false;
+    bool fell_back = false;  // Mixed precision fell back to double since
+                             // the last refactor
+    bool preconditioned = false;  // `factor` is a sketched preconditioner
+    double ridge = 0.0;
+    Eigen::MatrixXd w0;  // N_m⁻¹ r_m (characters × positions)
+    bool dirty = true;
+  };
+
+  // Per-gluing cached interface column.
+  struct Coupling {
+    Eigen::VectorXd c;    // Boundary character features
+    Eigen::VectorXd z_a;  // N_a⁻¹ c
+    Eigen::VectorXd z_b;  // -N_b⁻¹ c
+    bool dirty = true;
+  };
+
+  // Positions sharing one projection window (one design matrix).
+  struct DesignClass {
+    int window = 0;              // First coefficient of the window
+    std::vector<int> positions;  // Output positions in this class
+    Rows shared;
+    std::vector<Block> blocks;        // One per patch
+    std::vector<Coupling> couplings;  // One per gluing
+
+    // Interface system S = I + C N⁻¹ Cᵀ (cached, updated per dirty coupling).
+    Eigen::MatrixXd interface;
+
+    // Counters of the current Solve() (classes solve concurrently, so each
+    // keeps its own and Solve() sums them in class order).
+    struct Stats {
+      double obstruction = 0.0;
+      int64_t factorizations = 0;
+      int64_t precision_fallbacks = 0;
+      int64_t sketch_fallbacks = 0;
+    };
+    Stats stats;
+  };
+
+  // Encoded route of every example (what routing applies φₚ to).
+  static std::vector<Polynomial> EncodeExamples(
+      const std::vector<RoutingExample>& examples);
+
+  // Builds design rows of class `dc` from encoded examples, sketching
+  // them in the same pass when SolverOptions::sketch applies.
+  Rows BuildRows(
+      const DesignClass& dc,
+      const std::vector<RoutingExample>& examples,
+      const std::vector<Polynomial>& inputs) const;
+
+  // Character features of a polynomial at a position's window, in
+  // SolverOptions::weight_basis.
+  Eigen::VectorXd CharacterFeatures(const Polynomial& poly,
+                                    int position) const;
+
+  // Refactors block m of class dc and recomputes its local solution.
+  absl::Status RefactorBlock(DesignClass& dc, size_t m);
+
+  // Solves N_m x = rhs with the block's active factorization.
+  //
+  // Mixed precision: the float solution is refined in double against the
+  // cached N_m until the backward error reaches double accuracy. If the
+  // refinement stalls, the block is refactored in double and stays there
+  // until its next refactor.
+  absl::StatusOr<Eigen::MatrixXd> BlockSolve(
+      DesignClass& dc, size_t m, const Eigen::MatrixXd& rhs);
+
+  // Preconditioned CG on the exact normal equations of block m (applied
+  // matrix-free through the example rows), with the sketched factor as
+  // preconditioner. Falls back to the exact factorization if CG does not
+  // converge.
+  absl::StatusOr<Eigen::MatrixXd> PreconditionedSolve(
+      DesignClass& dc, size_t m, const Eigen::MatrixXd& rhs);
+
+  // N_m X = AᵀA X + λX over shared and local rows.
+  static Eigen::MatrixXd ApplyNormal(
+      const DesignClass& dc, const Block& block, const Eigen::MatrixXd& x);
+
+  // Factors N_m in double (default path and mixed-precision fallback).
+  bool FactorDouble(Block& block);
+
+  // Solves one design class, writing its positions of the patch weights
+  // and its dc.stats (touches no other shared state).
+  absl::Status SolveClass(
+      const CancellationToken& token, ProgressReporter& progress,
+      DesignClass& dc, std::vector<Eigen::MatrixXd>& patch_weights);
+
+  // Interface column of coupling h restricted to patch m (zero if h
+  // does not touch m).
+  Eigen::VectorXd InterfaceColumn(
+      const DesignClass& dc, size_t h, size_t m) const;
+
+  SolverOptions options_;
+  std::vector<DesignClass> classes_;
+  size_t num_patches_ = 0;
+  std::vector<std::pair<size_t, size_t>> gluing_patches_;  // (a, b)
+
+  int64_t factorizations_ = 0;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_NETWORK_SHEAF_SYSTEM_H_
@@ -0,0 +1,33 @@
+// lib/runtime/cancellation.cc
+#include "lib/runtime/cancellation.h"
+
+namespace f2chat {
+
+CancellationToken CancellationToken::Create(absl::Time deadline) {
+  CancellationToken token;
+  token.state_ = std::make_shared<State>();
+  token.state_->deadline = deadline;
+  return token;
+}
+
+void CancellationToken::Cancel() const {
+  if (state_ != nullptr) {
+    state_->cancelled.store(true, std::memory_order_relaxed);
+  }
+}
+
+absl::Status CancellationToken::Check() const {
+  if (state_ == nullptr) {
+    return absl::OkStatus();
+  }
+  if (state_->cancelled.load(std::memory_order_relaxed)) {
+    return absl::CancelledError("Operation cancelled");
+  }
+  if (state_->deadline != absl::InfiniteFuture() &&
+      absl::Now() >= state_->deadline) {
+    return absl::DeadlineExceededError("Deadline exceeded");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace f2chat
@@ -0,0 +1,75 @@
+// lib/runtime/cancellation.h
+//
+// Cooperative cancellation and deadlines.
+//
+// A CancellationToken is a cheap, copyable handle on shared state: every
+// copy observes Cancel() from any other copy. Long-running operations
+// call Check() at loop granularity and return its status, so a server can
+// shed work whose caller has gone away or whose deadline has passed
+// instead of finishing it.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_CANCELLATION_H_
+#define F2CHAT_LIB_RUNTIME_CANCELLATION_H_
+
+#include <atomic>
+#include <memory>
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+
+namespace f2chat {
+
+// Cancellation flag plus optional deadline.
+//
+// Thread Safety: Thread-safe; copies share the flag.
+class CancellationToken {
+ public:
+  // Token that is never cancelled and has no deadline (Check() is free).
+  CancellationToken() = default;
+
+  // Cancellable token.
+  //
+  // Args:
+  //   deadline: Time after which Check() fails (InfiniteFuture = none)
+  static CancellationToken Create(
+      absl::Time deadline = absl::InfiniteFuture());
+
+  // Cancellable token expiring `timeout` from now.
+  static CancellationToken WithTimeout(absl::Duration timeout) {
+    return Create(absl::Now() + timeout);
+  }
+
+  // Cancels every copy of this token (no-op for a default token).
+  void Cancel() const;
+
+  bool cancelled() const {
+    return state_ != nullptr &&
+           state_->cancelled.load(std::memory_order_relaxed);
+  }
+
+  absl::Time deadline() const {
+    return state_ != nullptr ? state_->deadline : absl::InfiniteFuture();
+  }
+
+  // Returns:
+  //   OK while live
+  //   Cancelled after Cancel()
+  //   DeadlineExceeded once the deadline has passed
+  //
+  // Performance: one relaxed load, plus a clock read if a deadline is set
+  absl::Status Check() const;
+
+ private:
+  struct State {
+    std::atomic<bool> cancelled{false};
+    absl::Time deadline = absl::InfiniteFuture();
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_CANCELLATION_H_
@@ -0,0 +1,60 @@
+// lib/runtime/cpu_affinity.cc
+#include "lib/runtime/cpu_affinity.h"
+
+#include <algorithm>
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace f2chat {
+
+int NumCores() {
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+bool PinThreadToCore(std::thread& thread, int core) {
+#ifdef __linux__
+  if (core < 0 || core >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t cores;
+  CPU_ZERO(&cores);
+  CPU_SET(core, &cores);
+  return pthread_setaffinity_np(
+      thread.native_handle(), sizeof(cores), &cores) == 0;
+#else
+  (void)thread;
+  (void)core;
+  return false;
+#endif
+}
+
+absl::StatusOr<std::vector<int>> ParseCoreList(absl::string_view spec) {
+  std::vector<int> cores;
+  for (absl::string_view item : absl::StrSplit(spec, ',', absl::SkipEmpty())) {
+    item = absl::StripAsciiWhitespace(item);
+    std::vector<absl::string_view> bounds = absl::StrSplit(item, '-');
+    int first = 0;
+    int last = 0;
+    if (bounds.size() > 2 || !absl::SimpleAtoi(bounds[0], &first) ||
+        !absl::SimpleAtoi(bounds.back(), &last) || first < 0 ||
+        last < first) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid core range '", item, "' in '", spec, "'"));
+    }
+    for (int core = first; core <= last; ++core) {
+      if (std::find(cores.begin(), cores.end(), core) == cores.end()) {
+        cores.push_back(core);
+      }
+    }
+  }
+  return cores;
+}
+
+}  // namespace f2chat
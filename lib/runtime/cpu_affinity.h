@@ -0,0 +1,40 @@
+// lib/runtime/cpu_affinity.h
+//
+// Core sets and thread pinning.
+//
+// Pinning is best effort: it is implemented with pthread_setaffinity_np
+// on Linux and is a no-op elsewhere; a restricted cpuset (containers) may
+// reject a core, in which case the thread keeps its current affinity.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_CPU_AFFINITY_H_
+#define F2CHAT_LIB_RUNTIME_CPU_AFFINITY_H_
+
+#include <thread>
+#include <vector>
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace f2chat {
+
+// Hardware threads available to the process (at least 1).
+int NumCores();
+
+// Pins a thread to one core.
+//
+// Returns:
+//   true if the affinity was applied
+bool PinThreadToCore(std::thread& thread, int core);
+
+// Parses a core list such as "0-3,8,10-11" (Linux cpuset syntax).
+//
+// Returns:
+//   Cores in the order listed (duplicates removed)
+//   InvalidArgument for malformed ranges or negative cores
+absl::StatusOr<std::vector<int>> ParseCoreList(absl::string_view spec);
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_CPU_AFFINITY_H_
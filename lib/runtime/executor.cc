@@ -0,0 +1,283 @@
+// lib/runtime/executor.cc
+#include "lib/runtime/executor.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include "lib/runtime/cpu_affinity.h"
+
+namespace f2chat {
+
+namespace {
+// Worker identity of the calling thread (for owner-side pushes).
+thread_local const Executor* current_executor = nullptr;
+thread_local int current_worker = -1;
+
+absl::Mutex default_mu(absl::kConstInit);
+Executor* default_executor ABSL_GUARDED_BY(default_mu) = nullptr;
+ExecutorOptions* default_options ABSL_GUARDED_BY(default_mu) = nullptr;
+}  // namespace
+
+Executor::Executor(const ExecutorOptions& options)
+    : topology_(options.topology != nullptr ? *options.topology
+                                            : NumaTopology::System()) {
+  int num_workers = options.num_workers;
+  if (num_workers <= 0) {
+    num_workers = options.cores.empty()
+        ? NumCores() : static_cast<int>(options.cores.size());
+  }
+  std::vector<int> worker_cores(num_workers, -1);
+  node_workers_.resize(topology_.num_nodes());
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+    if (options.pin_workers) {
+      worker_cores[i] = options.cores.empty()
+          ? i % NumCores() : options.cores[i % options.cores.size()];
+      workers_[i]->node = topology_.NodeOfCore(worker_cores[i]);
+      node_workers_[workers_[i]->node].push_back(i);
+    }
+  }
+
+  // Victims in ring order from each worker, same-node workers first.
+  steal_order_.resize(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    auto& order = steal_order_[i];
+    for (int offset = 1; offset < num_workers; ++offset) {
+      order.push_back((i + offset) % num_workers);
+    }
+    std::stable_partition(order.begin(), order.end(), [&](int victim) {
+      return workers_[victim]->node == workers_[i]->node;
+    });
+  }
+
+  // Start threads only once every deque exists (workers steal from all).
+  for (int i = 0; i < num_workers; ++i) {
+    workers_[i]->thread = std::thread(&Executor::WorkerLoop, this, i);
+    if (worker_cores[i] >= 0) {
+      pinned_workers_ +=
+          PinThreadToCore(workers_[i]->thread, worker_cores[i]) ? 1 : 0;
+    }
+  }
+}
+
+Executor& Executor::Default() {
+  absl::MutexLock lock(&default_mu);
+  if (default_executor == nullptr) {
+    ExecutorOptions options;
+    bool configured = false;
+    if (default_options != nullptr) {
+      options = *default_options;
+      configured = true;
+    } else if (const char* cores = std::getenv("F2CHAT_EXECUTOR_CORES")) {
+      // A malformed variable falls back to the unconfigured default.
+      auto parsed = ParseCoreList(cores);
+      if (parsed.ok() && !parsed->empty()) {
+        options.cores = *std::move(parsed);
+        options.pin_workers = true;
+        configured = true;
+      }
+    }
+    // Node-aware scheduling needs workers that stay on their node, but an
+    // explicit configuration (e.g. pin_workers = false) always wins.
+    if (!configured && NumaTopology::System().num_nodes() > 1) {
+      options.pin_workers = true;
+    }
+    default_executor = new Executor(options);
+  }
+  return *default_executor;
+}
+
+absl::Status Executor::ConfigureDefault(const ExecutorOptions& options) {
+  absl::MutexLock lock(&default_mu);
+  if (default_executor != nullptr) {
+    return absl::FailedPreconditionError(
+        "Default executor already started; configure it before first use");
+  }
+  delete default_options;
+  default_options = new ExecutorOptions(options);
+  return absl::OkStatus();
+}
+
+Executor::~Executor() {
+  stopping_.store(true);
+  wake_epoch_.fetch_add(1);
+  wake_epoch_.notify_all();
+  for (auto& worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void Executor::Schedule(std::function<void()> task) {
+  int index = current_executor == this
+      ? current_worker
+      : static_cast<int>(next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                         workers_.size());
+  Push(index, std::move(task));
+}
+
+void Executor::ScheduleOnNode(int node, std::function<void()> task) {
+  if (node < 0 || node >= static_cast<int>(node_workers_.size()) ||
+      node_workers_[node].empty()) {
+    Schedule(std::move(task));
+    return;
+  }
+  const auto& candidates = node_workers_[node];
+  int index = current_executor == this && workers_[current_worker]->node == node
+      ? current_worker
+      : candidates[next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                   candidates.size()];
+  Push(index, std::move(task));
+}
+
+int Executor::CurrentNode() {
+  if (current_executor != nullptr) {
+    int node = current_executor->workers_[current_worker]->node;
+    if (node >= 0) return node;
+  }
+  return NumaTopology::System().CurrentNode();
+}
+
+void Executor::Push(int index, std::function<void()> task) {
+  {
+    Worker& worker = *workers_[index];
+    absl::MutexLock lock(&worker.mu);
+    worker.tasks.push_back(std::move(task));
+    pending_.fetch_add(1);
+  }
+  // Pairs with the sleeper's sleepers_ increment then pending_ check
+  // (both sequentially consistent): either it sees this task or we see it.
+  if (sleepers_.load() > 0) {
+    wake_epoch_.fetch_add(1);
+    wake_epoch_.notify_one();
+  }
+}
+
+std::function<void()> Executor::Pop(Worker& worker, bool front) {
+  std::function<void()> task;
+  if (front) {
+    task = std::move(worker.tasks.front());
+    worker.tasks.pop_front();
+  } else {
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+  }
+  // Under the deque lock, so pending_ > 0 always means a task is queued
+  // somewhere and an awake worker never spins on a drained count.
+  pending_.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+bool Executor::TryTake(int index, std::function<void()>& task) {
+  {
+    Worker& own = *workers_[index];
+    absl::MutexLock lock(&own.mu);
+    if (!own.tasks.empty()) {
+      task = Pop(own, /*front=*/false);
+      return true;
+    }
+  }
+  const int thief_node = workers_[index]->node;
+  for (int v : steal_order_[index]) {
+    Worker& victim = *workers_[v];
+    absl::MutexLock lock(&victim.mu);
+    if (!victim.tasks.empty()) {
+      task = Pop(victim, /*front=*/true);
+      steals_.fetch_add(1, std::memory_order_relaxed);
+      if (thief_node >= 0 && victim.node >= 0 && victim.node != thief_node) {
+        cross_node_steals_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Executor::RunOneTask() {
+  int index = current_executor == this
+      ? current_worker
+      : static_cast<int>(next_worker_.load(std::memory_order_relaxed) %
+                         workers_.size());
+  std::function<void()> task;
+  if (!TryTake(index, task)) {
+    return false;
+  }
+  task();
+  return true;
+}
+
+void Executor::WorkerLoop(int index) {
+  current_executor = this;
+  current_worker = index;
+  while (true) {
+    if (RunOneTask()) continue;
+
+    // Sleep until there is work anywhere, or shutdown with none left. The
+    // epoch is read before registering, so a push after it wakes us.
+    const uint32_t epoch = wake_epoch_.load();
+    sleepers_.fetch_add(1);
+    if (pending_.load() > 0) {
+      sleepers_.fetch_sub(1);
+      continue;
+    }
+    if (stopping_.load()) {
+      sleepers_.fetch_sub(1);
+      return;
+    }
+    wake_epoch_.wait(epoch);
+    sleepers_.fetch_sub(1);
+  }
+}
+
+TaskGroup::TaskGroup(Executor* executor)
+    : executor_(executor), state_(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() { Wait(); }
+
+void TaskGroup::Run(std::function<void()> task) {
+  RunOnNode(-1, std::move(task));  // No node: plain Schedule
+}
+
+void TaskGroup::RunOnNode(int node, std::function<void()> task) {
+  if (executor_ == nullptr) {
+    task();
+    return;
+  }
+  {
+    absl::MutexLock lock(&state_->mu);
+    ++state_->outstanding;
+  }
+  executor_->ScheduleOnNode(node, [state = state_, task = std::move(task)] {
+    task();
+    absl::MutexLock lock(&state->mu);
+    --state->outstanding;
+  });
+}
+
+void TaskGroup::Wait() {
+  State& state = *state_;
+  while (true) {
+    {
+      absl::MutexLock lock(&state.mu);
+      if (state.Done()) return;
+    }
+    // Help instead of blocking; sleep briefly only if nothing is runnable
+    // (our tasks are running on other threads).
+    if (executor_ == nullptr || !executor_->RunOneTask()) {
+      absl::MutexLock lock(&state.mu);
+      state.mu.AwaitWithTimeout(absl::Condition(&state, &State::Done),
+                                absl::Milliseconds(1));
+    }
+  }
+}
+
+void ParallelFor(Executor* executor, size_t begin, size_t end, size_t grain,
+                 const std::function<void(size_t, size_t)>& body) {
+  grain = std::max<size_t>(1, grain);
+  TaskGroup group(executor);
+  for (size_t chunk = begin; chunk < end; chunk += grain) {
+    const size_t chunk_end = std::min(end, chunk + grain);
+    group.Run([&body, chunk, chunk_end] { body(chunk, chunk_end); });
+  }
+  group.Wait();
+}
+
+}  // namespace f2chat
@@ -0,0 +1,222 @@
+// lib/runtime/executor.h
+//
+// Work-stealing thread pool.
+//
+// Each worker owns a deque of tasks. A worker pushes and pops its own
+// tasks at the back (LIFO, cache-warm) and, when its deque is empty,
+// steals from the front of another worker's deque (FIFO, oldest and
+// typically largest work first). Tasks scheduled from outside the pool
+// are spread round-robin over the workers.
+//
+// TaskGroup tracks a set of tasks; Wait() runs pending tasks on the
+// calling thread while it waits, so waiting from inside a task (nested
+// parallelism) cannot deadlock the pool. ParallelFor splits an index range
+// into task-sized chunks.
+//
+// f2chat subsystems share one process-wide pool (Executor::Default())
+// instead of starting their own threads, so a server runs exactly one
+// worker per configured core. Its core set comes from
+// Executor::ConfigureDefault or, failing that, the F2CHAT_EXECUTOR_CORES
+// environment variable (e.g. "0-7,16-23"); workers are pinned to those
+// cores so f2chat can be co-located with other services.
+//
+// NUMA: a pinned worker belongs to the node of its core. Stealing tries
+// workers on the thief's own node before crossing sockets, ScheduleOnNode
+// places a task next to node-local data (see NodeReplicated), and
+// cross_node_steals() counts the tasks that moved across nodes anyway.
+// On multi-node machines the default pool pins its workers unless it was
+// configured explicitly.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_EXECUTOR_H_
+#define F2CHAT_LIB_RUNTIME_EXECUTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "lib/runtime/numa.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+
+namespace f2chat {
+
+// Pool configuration.
+struct ExecutorOptions {
+  // Worker threads (0 = one per core in `cores`, or per hardware thread
+  // if `cores` is empty).
+  int num_workers = 0;
+
+  // Cores the workers may run on (empty = any).
+  std::vector<int> cores;
+
+  // Pin worker i to cores[i mod |cores|] (or to core i mod NumCores() if
+  // `cores` is empty). Best effort (see PinThreadToCore). Pinned workers
+  // are assigned to their core's NUMA node; unpinned workers to none.
+  bool pin_workers = false;
+
+  // Core-to-node layout (nullptr = NumaTopology::System()).
+  const NumaTopology* topology = nullptr;
+};
+
+// Work-stealing thread pool.
+//
+// Thread Safety: Schedule and RunOneTask are thread-safe. The destructor
+// finishes all scheduled tasks before joining the workers.
+class Executor {
+ public:
+  explicit Executor(const ExecutorOptions& options = {});
+  ~Executor();
+
+  // Process-wide shared pool, created on first use (never destroyed).
+  static Executor& Default();
+
+  // Configures Default() before its first use.
+  //
+  // Returns:
+  //   OK, or FailedPrecondition if Default() already exists
+  static absl::Status ConfigureDefault(const ExecutorOptions& options);
+
+  // Default() unless `executor` is non-null.
+  static Executor& OrDefault(Executor* executor) {
+    return executor != nullptr ? *executor : Default();
+  }
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  // Schedules a task (on the calling worker's own deque if called from a
+  // task of this executor).
+  void Schedule(std::function<void()> task);
+
+  // Schedules a task on a worker of NUMA node `node` (round-robin over the
+  // node's workers); falls back to Schedule if no worker is on that node.
+  void ScheduleOnNode(int node, std::function<void()> task);
+
+  // Node of the calling thread: its worker's node inside this process's
+  // executors, else NumaTopology::System().CurrentNode().
+  static int CurrentNode();
+
+  // Runs one pending task on the calling thread, if any.
+  //
+  // Returns:
+  //   true if a task ran
+  bool RunOneTask();
+
+  int num_workers() const { return static_cast<int>(workers_.size()); }
+
+  // Workers whose core pinning succeeded.
+  int pinned_workers() const { return pinned_workers_; }
+
+  // Tasks taken from another worker's deque so far (load-balance
+  // diagnostics).
+  int64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+  // Steals whose victim worker sat on a different NUMA node than the
+  // thief (cross-socket traffic).
+  int64_t cross_node_steals() const {
+    return cross_node_steals_.load(std::memory_order_relaxed);
+  }
+
+  const NumaTopology& topology() const { return topology_; }
+
+  // NUMA node of worker i (-1 if unpinned).
+  int worker_node(int i) const { return workers_[i]->node; }
+
+ private:
+  struct Worker {
+    absl::Mutex mu;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mu);
+    std::thread thread;
+    int node = -1;
+  };
+
+  void WorkerLoop(int index);
+
+  // Pushes onto worker `index`'s deque and wakes a sleeper, if any.
+  void Push(int index, std::function<void()> task);
+
+  // Pops from `index`'s own deque, else steals from the others (same-node
+  // workers first).
+  bool TryTake(int index, std::function<void()>& task);
+
+  // Removes the front or back task of `worker` (lock held) and counts it
+  // out of pending_.
+  std::function<void()> Pop(Worker& worker, bool front)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(worker.mu);
+
+  NumaTopology topology_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::vector<int>> steal_order_;  // Per worker: victims
+  std::vector<std::vector<int>> node_workers_;
+  std::atomic<uint64_t> next_worker_{0};  // Round-robin for outside callers
+  std::atomic<int64_t> steals_{0};
+  std::atomic<int64_t> cross_node_steals_{0};
+  int pinned_workers_ = 0;
+
+  // Sleep/wake for idle workers (an eventcount): pushes and takes touch
+  // only these atomics and the one deque they use. A worker about to sleep
+  // registers in sleepers_ and re-checks pending_; a push bumps wake_epoch_
+  // only when someone sleeps, and a sleeper waits (futex) for the epoch it
+  // read before registering to change.
+  std::atomic<int64_t> pending_{0};  // Queued tasks (changed under deque locks)
+  std::atomic<int> sleepers_{0};
+  std::atomic<uint32_t> wake_epoch_{0};
+  std::atomic<bool> stopping_{false};
+};
+
+// Set of tasks that can be waited on together.
+//
+// Thread Safety: Run and Wait are thread-safe.
+class TaskGroup {
+ public:
+  // Args:
+  //   executor: Pool to run on (nullptr = run each task inline in Run)
+  explicit TaskGroup(Executor* executor);
+
+  // Waits for outstanding tasks.
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  void Run(std::function<void()> task);
+
+  // Runs a task on a worker of NUMA node `node` (see
+  // Executor::ScheduleOnNode).
+  void RunOnNode(int node, std::function<void()> task);
+
+  // Blocks until every task passed to Run has finished, helping to run
+  // pending executor tasks meanwhile.
+  void Wait();
+
+ private:
+  // Shared with running tasks, which may still release the mutex after
+  // Wait() has returned and the group is gone.
+  struct State {
+    absl::Mutex mu;
+    int64_t outstanding ABSL_GUARDED_BY(mu) = 0;
+    bool Done() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      return outstanding == 0;
+    }
+  };
+
+  Executor* executor_;
+  std::shared_ptr<State> state_;
+};
+
+// Runs body(chunk_begin, chunk_end) over [begin, end) in chunks of at most
+// `grain` indices, in parallel on `executor` (nullptr = inline), and waits.
+//
+// Performance: ceil((end - begin) / grain) tasks
+void ParallelFor(Executor* executor, size_t begin, size_t end, size_t grain,
+                 const std::function<void(size_t, size_t)>& body);
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_EXECUTOR_H_
@@ -0,0 +1,80 @@
+// lib/runtime/node_replicated.h
+//
+// Per-NUMA-node copies of read-mostly data.
+//
+// Routing weights are read by every request but written only when a new
+// version is published. NodeReplicated<T> keeps one copy per node of an
+// executor's topology; each copy is constructed by a task running on that
+// node's workers, so under Linux first-touch placement its heap storage
+// lands in that node's memory. Readers use Local() and never cross
+// sockets for the replicated data.
+//
+// Only RoutingTable::node_operators uses it today. Evaluation and rotation
+// keys, and EncryptedRouting's encoded operators, are single copies.
+//
+// On a single-node machine there is exactly one copy and no extra memory.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_NODE_REPLICATED_H_
+#define F2CHAT_LIB_RUNTIME_NODE_REPLICATED_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "lib/runtime/executor.h"
+
+namespace f2chat {
+
+// Immutable per-node replicas of a T.
+//
+// Thread Safety: Immutable after Build; copies share the replicas.
+template <typename T>
+class NodeReplicated {
+ public:
+  // Empty (num_replicas() == 0).
+  NodeReplicated() = default;
+
+  // Builds one replica per node of `executor`'s topology by calling
+  // `make` on a worker of each node. Placement is best effort: a node
+  // without workers, or a task the waiting caller helps run, builds its
+  // replica wherever it runs.
+  //
+  // Performance: one `make` call per node, run in parallel
+  static NodeReplicated Build(Executor& executor,
+                              const std::function<T()>& make) {
+    NodeReplicated replicated;
+    const int num_nodes = executor.topology().num_nodes();
+    replicated.replicas_.resize(num_nodes);
+    TaskGroup tasks(&executor);
+    for (int node = 0; node < num_nodes; ++node) {
+      tasks.RunOnNode(node, [&replicated, &make, node] {
+        replicated.replicas_[node] = std::make_shared<const T>(make());
+      });
+    }
+    tasks.Wait();
+    return replicated;
+  }
+
+  int num_replicas() const { return static_cast<int>(replicas_.size()); }
+
+  // Replica of node `node` (node 0's for out-of-range nodes).
+  const T& ForNode(int node) const {
+    if (node < 0 || node >= num_replicas()) node = 0;
+    return *replicas_[node];
+  }
+
+  // Replica of the calling thread's node (Executor::CurrentNode()).
+  const T& Local() const {
+    return num_replicas() == 1 ? *replicas_[0]
+                               : ForNode(Executor::CurrentNode());
+  }
+
+ private:
+  std::vector<std::shared_ptr<const T>> replicas_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_NODE_REPLICATED_H_
@@ -0,0 +1,103 @@
+// lib/runtime/numa.cc
+#include "lib/runtime/numa.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include "lib/runtime/cpu_affinity.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace f2chat {
+
+const NumaTopology& NumaTopology::System() {
+  static const NumaTopology* system = [] {
+    auto topology = FromSysfs();
+    return topology.ok() ? new NumaTopology(*std::move(topology))
+                         : new NumaTopology(SingleNode(NumCores()));
+  }();
+  return *system;
+}
+
+absl::StatusOr<NumaTopology> NumaTopology::FromSysfs(const std::string& root) {
+  std::error_code error;
+  std::vector<std::pair<int, std::filesystem::path>> nodes;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(root, error)) {
+    const std::string name = entry.path().filename().string();
+    int id = 0;
+    if (absl::StartsWith(name, "node") &&
+        absl::SimpleAtoi(absl::string_view(name).substr(4), &id)) {
+      nodes.emplace_back(id, entry.path());
+    }
+  }
+  if (nodes.empty()) {
+    return absl::NotFoundError(absl::StrCat("No NUMA nodes under ", root));
+  }
+  std::sort(nodes.begin(), nodes.end());
+
+  std::vector<std::vector<int>> node_cores;
+  for (const auto& [id, path] : nodes) {
+    std::ifstream file(path / "cpulist");
+    std::stringstream contents;
+    contents << file.rdbuf();
+    auto cores = ParseCoreList(absl::StripAsciiWhitespace(contents.str()));
+    if (!cores.ok()) {
+      return cores.status();
+    }
+    if (!cores->empty()) {  // Memory-only nodes run no threads
+      node_cores.push_back(*std::move(cores));
+    }
+  }
+  if (node_cores.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No NUMA node lists cores under ", root));
+  }
+  return NumaTopology(std::move(node_cores));
+}
+
+NumaTopology NumaTopology::SingleNode(int num_cores) {
+  std::vector<int> cores(std::max(1, num_cores));
+  for (size_t i = 0; i < cores.size(); ++i) {
+    cores[i] = static_cast<int>(i);
+  }
+  return NumaTopology({std::move(cores)});
+}
+
+NumaTopology NumaTopology::FromNodes(std::vector<std::vector<int>> node_cores) {
+  if (node_cores.empty()) {
+    return SingleNode(NumCores());
+  }
+  return NumaTopology(std::move(node_cores));
+}
+
+int NumaTopology::NodeOfCore(int core) const {
+  for (int node = 0; node < num_nodes(); ++node) {
+    const auto& cores = node_cores_[node];
+    if (std::find(cores.begin(), cores.end(), core) != cores.end()) {
+      return node;
+    }
+  }
+  return 0;
+}
+
+int NumaTopology::CurrentNode() const {
+  if (num_nodes() == 1) {
+    return 0;
+  }
+#ifdef __linux__
+  return NodeOfCore(sched_getcpu());
+#else
+  return 0;
+#endif
+}
+
+}  // namespace f2chat
@@ -0,0 +1,70 @@
+// lib/runtime/numa.h
+//
+// NUMA topology: which cores belong to which memory node.
+//
+// On a multi-socket machine, memory is attached to one socket (node) and
+// reading it from another costs a cross-socket hop. Linux places a page
+// on the node of the thread that first touches it, so f2chat keeps data
+// next to its users by allocating from threads pinned to the right node
+// (see NodeReplicated and BatchArena) rather than through libnuma.
+//
+// The topology is read from /sys/devices/system/node; machines without
+// that directory (non-Linux, some containers) are one node with every
+// core.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_NUMA_H_
+#define F2CHAT_LIB_RUNTIME_NUMA_H_
+
+#include <string>
+#include <vector>
+#include "absl/status/statusor.h"
+
+namespace f2chat {
+
+// Cores per NUMA node.
+//
+// Thread Safety: Immutable after construction.
+class NumaTopology {
+ public:
+  // Topology of this machine (sysfs, else one node), read once.
+  static const NumaTopology& System();
+
+  // Reads node<N>/cpulist files under `root`.
+  //
+  // Returns:
+  //   Topology with nodes renumbered densely in ascending N order
+  //   (memory-only nodes without cores are skipped)
+  //   NotFound if `root` holds no node with cores
+  //   InvalidArgument for a malformed cpulist
+  static absl::StatusOr<NumaTopology> FromSysfs(
+      const std::string& root = "/sys/devices/system/node");
+
+  // One node holding cores [0, num_cores).
+  static NumaTopology SingleNode(int num_cores);
+
+  // Explicit layout (node i = node_cores[i]); used by tests and
+  // benchmarks to model multi-socket machines.
+  static NumaTopology FromNodes(std::vector<std::vector<int>> node_cores);
+
+  int num_nodes() const { return static_cast<int>(node_cores_.size()); }
+  const std::vector<int>& cores(int node) const { return node_cores_[node]; }
+
+  // Node owning `core` (0 for cores the topology does not list).
+  int NodeOfCore(int core) const;
+
+  // Node of the core the calling thread is running on (0 if unknown).
+  int CurrentNode() const;
+
+ private:
+  explicit NumaTopology(std::vector<std::vector<int>> node_cores)
+      : node_cores_(std::move(node_cores)) {}
+
+  std::vector<std::vector<int>> node_cores_;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_NUMA_H_
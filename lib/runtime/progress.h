@@ -0,0 +1,68 @@
+// lib/runtime/progress.h
+//
+// Partial-progress reporting for long operations.
+//
+// Operations that accept a CancellationToken also accept a
+// ProgressCallback and report how much of their work is done, in units
+// they document (blocks factored, messages routed). A caller can then
+// tell a slow operation from a stuck one, and can see how much work a
+// cancellation threw away.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_PROGRESS_H_
+#define F2CHAT_LIB_RUNTIME_PROGRESS_H_
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace f2chat {
+
+// Snapshot passed to a ProgressCallback.
+struct Progress {
+  absl::string_view operation;  // e.g. "LearnRouting"
+  int64_t completed = 0;        // Units done so far
+  int64_t total = 0;            // Units planned
+};
+
+using ProgressCallback = std::function<void(const Progress&)>;
+
+// Thread-safe counter that reports to a callback on every advance.
+//
+// Thread Safety: Advance may be called from any thread; callback calls
+// are serialized and see non-decreasing `completed`.
+class ProgressReporter {
+ public:
+  // Args:
+  //   callback: Receiver (nullptr = no reporting; Advance is then a no-op)
+  //   operation: Name reported with each snapshot (must outlive this)
+  //   total: Units planned
+  ProgressReporter(ProgressCallback callback, absl::string_view operation,
+                   int64_t total)
+      : callback_(std::move(callback)), operation_(operation), total_(total) {}
+
+  ProgressReporter(const ProgressReporter&) = delete;
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+  void Advance(int64_t units = 1) {
+    if (callback_ == nullptr) return;
+    absl::MutexLock lock(&mu_);
+    completed_ += units;
+    callback_(Progress{operation_, completed_, total_});
+  }
+
+ private:
+  ProgressCallback callback_;
+  absl::string_view operation_;
+  int64_t total_;
+  absl::Mutex mu_;
+  int64_t completed_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_PROGRESS_H_
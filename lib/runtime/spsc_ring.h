@@ -0,0 +1,92 @@
+// lib/runtime/spsc_ring.h
+//
+// Lock-free single-producer / single-consumer ring buffer.
+//
+// Bounded FIFO between exactly two threads: one calls TryPush, the other
+// TryPop. The head (consumer) and tail (producer) indices live on separate
+// cache lines, and each side keeps a cached copy of the other's index so
+// the shared line is only re-read when the ring looks full / empty.
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_SPSC_RING_H_
+#define F2CHAT_LIB_RUNTIME_SPSC_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace f2chat {
+
+// Bounded SPSC queue (capacity rounded up to a power of two).
+//
+// Thread Safety: One producer thread and one consumer thread at a time.
+template <typename T>
+class SpscRing {
+ public:
+  explicit SpscRing(size_t capacity)
+      : mask_(RoundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1),
+        slots_(std::make_unique<T[]>(mask_ + 1)) {}
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  // Producer: enqueues `value` unless the ring is full.
+  //
+  // Returns:
+  //   true if enqueued (value moved from), false if full (value untouched)
+  bool TryPush(T&& value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = std::move(value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer: dequeues into `value` unless the ring is empty.
+  bool TryPop(T& value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        return false;
+      }
+    }
+    value = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) power <<= 1;
+    return power;
+  }
+
+  const size_t mask_;
+  std::unique_ptr<T[]> slots_;
+
+  // Consumer side.
+  alignas(kCacheLine) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0;
+
+  // Producer side.
+  alignas(kCacheLine) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+};
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_SPSC_RING_H_
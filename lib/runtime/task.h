@@ -0,0 +1,156 @@
+// lib/runtime/task.h
+//
+// C++20 coroutine tasks on the executor.
+//
+// Task<T> is a lazily started coroutine producing a T. Awaiting a task
+// (co_await) starts it and resumes the awaiting coroutine when it
+// finishes, without blocking a thread in between; a suspended coroutine
+// costs only its frame, so one thread can keep thousands of operations in
+// flight. Coroutines move between threads by awaiting ResumeOn(executor)
+// and are started from ordinary code with Spawn (fire and forget, on an
+// executor) or SyncWait (block the calling thread until done).
+//
+// The tree builds with -fno-exceptions: an escaping exception aborts, and
+// errors travel in T (absl::Status / absl::StatusOr).
+//
+// Author: bon-cdp (shakilflynn@gmail.com)
+// Date: 2025-11-11
+
+#ifndef F2CHAT_LIB_RUNTIME_TASK_H_
+#define F2CHAT_LIB_RUNTIME_TASK_H_
+
+#include <coroutine>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <utility>
+#include "lib/runtime/executor.h"
+#include "absl/synchronization/notification.h"
+
+namespace f2chat {
+
+// Lazily started coroutine returning T (T must not be void).
+//
+// Thread Safety: A task is awaited at most once, by one coroutine.
+template <typename T>
+class [[nodiscard]] Task {
+ public:
+  struct promise_type {
+    std::optional<T> value;
+    std::coroutine_handle<> continuation;
+
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Transfers control straight to the awaiting coroutine (symmetric
+    // transfer; a tail call in optimized builds).
+    struct FinalAwaiter {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<promise_type> handle) noexcept {
+        auto continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+      }
+      void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    template <typename U>
+    void return_value(U&& value_in) {
+      value.emplace(std::forward<U>(value_in));
+    }
+    void unhandled_exception() { std::abort(); }
+  };
+
+  Task(Task&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  ~Task() {
+    if (handle_) handle_.destroy();
+  }
+
+  // Awaiting starts the task; the result is moved out.
+  bool await_ready() const noexcept { return false; }
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<> awaiting) noexcept {
+    handle_.promise().continuation = awaiting;
+    return handle_;
+  }
+  T await_resume() { return std::move(*handle_.promise().value); }
+
+ private:
+  explicit Task(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+// Awaitable that suspends the coroutine and resumes it as a task on
+// `executor` (a hop onto a pool thread).
+inline auto ResumeOn(Executor& executor) {
+  struct Awaiter {
+    Executor& executor;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) {
+      executor.Schedule([handle] { handle.resume(); });
+    }
+    void await_resume() const noexcept {}
+  };
+  return Awaiter{executor};
+}
+
+namespace internal {
+// Eagerly started, self-destroying coroutine (roots of Spawn/SyncWait).
+struct DetachedTask {
+  struct promise_type {
+    DetachedTask get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::abort(); }
+  };
+};
+
+template <typename T>
+DetachedTask RunDetached(Executor* executor, Task<T> task,
+                         std::function<void(T)> done) {
+  if (executor != nullptr) {
+    co_await ResumeOn(*executor);
+  }
+  done(co_await std::move(task));
+}
+}  // namespace internal
+
+// Starts `task` on `executor` and calls done(result) on whichever thread
+// finishes it. Returns immediately.
+template <typename T>
+void Spawn(Executor& executor, Task<T> task, std::function<void(T)> done) {
+  internal::RunDetached(&executor, std::move(task), std::move(done));
+}
+
+// Runs `task` starting on the calling thread and blocks until it
+// finishes (its continuations may run on executor threads).
+template <typename T>
+T SyncWait(Task<T> task) {
+  std::optional<T> result;
+  absl::Notification finished;
+  internal::RunDetached<T>(nullptr, std::move(task),
+                           [&result, &finished](T value) {
+                             result.emplace(std::move(value));
+                             finished.Notify();
+                           });
+  finished.WaitForNotification();
+  return std::move(*result);
+}
+
+}  // namespace f2chat
+
+#endif  // F2CHAT_LIB_RUNTIME_TASK_H_
@@ -0,0 +1,40 @@
+// test/crypto/batch_arena_test.cc
+#include "lib/crypto/batch_arena.h"
+#include <gtest/gtest.h>
+
+namespace f2chat {
+namespace {
+
+TEST(BatchArenaTest, ReusesReleasedBuffersPerNode) {
+  BatchArena arena(2);
+  PolynomialBatch batch = arena.Acquire(1, 8);
+  ASSERT_EQ(batch.size(), 8u);
+  const int64_t* buffer = batch.row(0);
+  arena.Release(1, std::move(batch));
+
+  // Other node: fresh buffer.
+  PolynomialBatch other = arena.Acquire(0, 4);
+  EXPECT_EQ(arena.reused(), 0);
+
+  // Same node, smaller size: same storage.
+  PolynomialBatch again = arena.Acquire(1, 4);
+  EXPECT_EQ(again.size(), 4u);
+  EXPECT_EQ(again.row(0), buffer);
+  EXPECT_EQ(arena.reused(), 1);
+
+  // Node ids wrap modulo the node count.
+  arena.Release(3, std::move(again));
+  EXPECT_EQ(arena.Acquire(1, 2).row(0), buffer);
+}
+
+TEST(BatchArenaTest, BoundsFreeList) {
+  BatchArena arena(1, /*max_free_per_node=*/1);
+  arena.Release(0, PolynomialBatch(2));
+  arena.Release(0, PolynomialBatch(2));  // Dropped
+  arena.Acquire(0, 1);
+  arena.Acquire(0, 1);
+  EXPECT_EQ(arena.reused(), 1);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,159 @@
+// test/crypto/character_transform_test.cc
+//
+// Tests for the homomorphic character transform: twiddle setup, the
+// plaintext reference, encrypted projections at 8, 16 and 64 characters
+// on the native backend, and cancellation between giant-step groups.
+
+#include "lib/crypto/character_transform.h"
+#include "lib/crypto/native_bgv_backend.h"
+#include "lib/runtime/cancellation.h"
+#include "lib/runtime/progress.h"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace f2chat {
+namespace {
+
+constexpr int64_t kP = RingParams::kModulus;
+
+// k⁻¹ Σₘ ω^(−jm) · c[(s + m) mod d], straight from the definition.
+std::vector<int64_t> DirectProjection(const std::vector<int64_t>& c, int k,
+                                      int64_t omega, int j) {
+  auto pow = [](int64_t base, int64_t exponent) {
+    int64_t result = 1;
+    for (int64_t i = 0; i < exponent; ++i) result = result * base % kP;
+    return result;
+  };
+  const int d = static_cast<int>(c.size());
+  const int64_t k_inverse = pow(k, kP - 2);
+  std::vector<int64_t> y(d);
+  for (int s = 0; s < d; ++s) {
+    int64_t sum = 0;
+    for (int m = 0; m < k; ++m) {
+      sum = (sum + pow(omega, (k - int64_t{j} * m % k) % k) * c[(s + m) % d]) %
+            kP;
+    }
+    y[s] = sum * k_inverse % kP;
+  }
+  return y;
+}
+
+std::vector<int64_t> RandomMessage(int d, std::mt19937_64& rng) {
+  std::vector<int64_t> message(d);
+  for (auto& c : message) c = rng() % kP;
+  return message;
+}
+
+TEST(CharacterTransformTest, ValidatesCharacterCount) {
+  for (int k : {0, 3, 12}) {
+    EXPECT_EQ(CharacterTransform::Create(k).status().code(),
+              absl::StatusCode::kInvalidArgument)
+        << k;
+  }
+  // 2^17 does not divide 65536.
+  EXPECT_FALSE(CharacterTransform::Create(1 << 17).ok());
+
+  for (int k : {1, 8, 16, 64}) {
+    auto transform = CharacterTransform::Create(k);
+    ASSERT_TRUE(transform.ok()) << transform.status();
+    EXPECT_EQ(transform->baby_steps() * transform->giant_steps(), k);
+    EXPECT_GE(transform->baby_steps(), transform->giant_steps());
+    int64_t power = 1;
+    for (int m = 1; m <= k; ++m) {
+      power = power * transform->root() % kP;
+      EXPECT_EQ(power == 1, m == k) << "k = " << k << ", m = " << m;
+    }
+  }
+}
+
+TEST(CharacterTransformTest, PlaintextProjectionsPartitionTheMessage) {
+  std::mt19937_64 rng(1);
+  const std::vector<int64_t> c = RandomMessage(64, rng);
+  for (int k : {8, 16, 64}) {
+    CharacterTransform transform = CharacterTransform::Create(k).value();
+    std::vector<int64_t> sum(c.size(), 0);
+    for (int j = 0; j < k; ++j) {
+      std::vector<int64_t> y = transform.ProjectPlaintext(c, j);
+      EXPECT_EQ(y, DirectProjection(c, k, transform.root(), j))
+          << "k = " << k << ", j = " << j;
+      for (size_t s = 0; s < c.size(); ++s) sum[s] = (sum[s] + y[s]) % kP;
+    }
+    EXPECT_EQ(sum, c) << "k = " << k;
+  }
+}
+
+TEST(CharacterTransformTest, EncryptedProjectionsMatchPlaintext) {
+  constexpr int d = 64;
+  auto backend =
+      NativeBgvBackend::Create(NativeBgvParams::Security128(d).value())
+          .value();
+  std::mt19937_64 rng(2);
+  const std::vector<int64_t> c = RandomMessage(d, rng);
+
+  for (int k : {8, 16, 64}) {
+    CharacterTransform transform = CharacterTransform::Create(k).value();
+    // Exactly the transform's rotations: nothing is composed.
+    auto keys = backend->GenerateKeyPair(transform.Rotations(d)).value();
+    Ciphertext ct = backend->Encrypt(c, keys.public_key).value();
+    auto decrypt = [&](const Ciphertext& y) {
+      return backend->Decrypt(y, keys.private_key).value();
+    };
+
+    auto all = transform.ProjectAll(*backend, ct);
+    ASSERT_TRUE(all.ok()) << all.status();
+    ASSERT_EQ(all->size(), static_cast<size_t>(k));
+    for (int j = 0; j < k; ++j) {
+      EXPECT_EQ(decrypt((*all)[j]), transform.ProjectPlaintext(c, j))
+          << "k = " << k << ", j = " << j;
+    }
+
+    for (int j : {0, k - 1}) {
+      auto single = transform.Project(*backend, ct, j);
+      ASSERT_TRUE(single.ok()) << single.status();
+      EXPECT_EQ(decrypt(*single), transform.ProjectPlaintext(c, j));
+    }
+    EXPECT_EQ(transform.Project(*backend, ct, k).status().code(),
+              absl::StatusCode::kInvalidArgument);
+  }
+}
+
+TEST(CharacterTransformTest, ProjectAllHonorsCancellationAndReportsProgress) {
+  constexpr int d = 64;
+  auto backend =
+      NativeBgvBackend::Create(NativeBgvParams::Security128(d).value())
+          .value();
+  CharacterTransform transform = CharacterTransform::Create(16).value();
+  auto keys = backend->GenerateKeyPair(transform.Rotations(d)).value();
+  std::mt19937_64 rng(3);
+  Ciphertext ct = backend->Encrypt(RandomMessage(d, rng), keys.public_key)
+                      .value();
+  const int64_t groups = 1 + transform.giant_steps();
+
+  std::vector<Progress> reports;
+  ASSERT_TRUE(transform
+                  .ProjectAll(*backend, ct, {},
+                              [&reports](const Progress& progress) {
+                                reports.push_back(progress);
+                              })
+                  .ok());
+  ASSERT_EQ(reports.size(), static_cast<size_t>(groups));
+  EXPECT_EQ(reports.back().completed, groups);
+  EXPECT_EQ(reports.back().total, groups);
+
+  // Cancelled after the giant steps: no group runs.
+  CancellationToken token = CancellationToken::Create();
+  int64_t completed = 0;
+  auto cancelled = transform.ProjectAll(
+      *backend, ct, token, [&](const Progress& progress) {
+        completed = progress.completed;
+        token.Cancel();
+      });
+  EXPECT_EQ(cancelled.status().code(), absl::StatusCode::kCancelled);
+  EXPECT_EQ(completed, 1);
+  EXPECT_EQ(transform.Project(*backend, ct, 0, token).status().code(),
+            absl::StatusCode::kCancelled);
+}
+
+}  // namespace
+}  // namespace f2chat
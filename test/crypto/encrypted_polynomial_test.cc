@@ -2,9 +2,8 @@
 //
 // Tests for FHE-encrypted polynomial operations.
 //
-// Note: These tests currently expect UnimplementedError since OpenFHE
-// integration is pending. Once OpenFHE is fully integrated, these tests
-// will verify homomorphic operations work correctly.
+// Runs against the default backend (the in-tree native BGV backend), so
+// every homomorphic result is checked against the plaintext Polynomial op.
 
 #include "lib/crypto/encrypted_polynomial.h"
 #include "lib/crypto/polynomial.h"
@@ -14,91 +13,230 @@
 namespace f2chat {
 namespace {
 
-// NOTE: All tests currently expect UnimplementedError
-// Once OpenFHE integration is complete, these will be actual functional tests
+class EncryptedPolynomialTest : public ::testing::Test {
+ protected:
+  // Key generation is the slow part; share one context and key pair.
+  static void SetUpTestSuite() {
+    auto fhe_context_or = FHEContext::Create();
+    ASSERT_TRUE(fhe_context_or.ok()) << fhe_context_or.status();
+    fhe_ctx_ = new FHEContext(*std::move(fhe_context_or));
+    auto keys_or = fhe_ctx_->GenerateKeyPair();
+    ASSERT_TRUE(keys_or.ok()) << keys_or.status();
+    keys_ = new FHEKeyPair(*std::move(keys_or));
+  }
+
+  static void TearDownTestSuite() {
+    delete keys_;
+    delete fhe_ctx_;
+  }
+
+  EncryptedPolynomial Encrypt(const Polynomial& p) {
+    auto enc = EncryptedPolynomial::Encrypt(p, keys_->public_key, *fhe_ctx_);
+    EXPECT_TRUE(enc.ok()) << enc.status();
+    return *std::move(enc);
+  }
+
+  Polynomial Decrypt(const EncryptedPolynomial& enc) {
+    auto dec = enc.Decrypt(keys_->private_key, *fhe_ctx_);
+    EXPECT_TRUE(dec.ok()) << dec.status();
+    return *std::move(dec);
+  }
+
+  static FHEContext* fhe_ctx_;
+  static FHEKeyPair* keys_;
+};
+
+FHEContext* EncryptedPolynomialTest::fhe_ctx_ = nullptr;
+FHEKeyPair* EncryptedPolynomialTest::keys_ = nullptr;
+
+TEST_F(EncryptedPolynomialTest, FHEContextCreation) {
+  EXPECT_EQ(fhe_ctx_->backend().name(), kDefaultFheBackend);
+  EXPECT_EQ(fhe_ctx_->modulus(), RingParams::kModulus);
+  // The RLWE ring is sized for 128-bit security, not for the message.
+  EXPECT_GE(fhe_ctx_->ring_dimension(), 2 * RingParams::kDegree);
+}
 
-TEST(EncryptedPolynomialTest, FHEContextCreationPending) {
-  // This will fail with UnimplementedError until OpenFHE is integrated
-  auto fhe_context_or = FHEContext::Create();
+TEST_F(EncryptedPolynomialTest, EncryptionDecryptionRoundtrip) {
+  Polynomial original({1, 2, 3, 4, 5});
+  EncryptedPolynomial encrypted = Encrypt(original);
+  EXPECT_EQ(Decrypt(encrypted), original);
+}
 
-  // Expected: UnimplementedError (OpenFHE integration pending)
-  EXPECT_FALSE(fhe_context_or.ok());
-  EXPECT_EQ(fhe_context_or.status().code(), absl::StatusCode::kUnimplemented);
+TEST_F(EncryptedPolynomialTest, HomomorphicAddition) {
+  Polynomial a({1, 2, 3});
+  Polynomial b({4, 5, RingParams::kModulus - 1});
+  auto enc_sum = Encrypt(a).Add(Encrypt(b), *fhe_ctx_);
+  ASSERT_TRUE(enc_sum.ok()) << enc_sum.status();
+  EXPECT_EQ(Decrypt(*enc_sum), a.Add(b));
 }
 
-TEST(EncryptedPolynomialTest, EncryptionDecryptionRoundtrip_Pending) {
-  // TODO: Once OpenFHE is integrated, this test will verify:
-  // 1. Create FHE context
-  // 2. Generate key pair
-  // 3. Encrypt polynomial
-  // 4. Decrypt ciphertext
-  // 5. Verify: decrypted == original
-
-  // For now, just document the expected test structure:
-  // auto fhe_ctx = FHEContext::Create().value();
-  // auto keys = fhe_ctx.GenerateKeyPair().value();
-  // Polynomial original({1, 2, 3, 4, 5});
-  // auto encrypted = EncryptedPolynomial::Encrypt(original, keys.public_key, fhe_ctx).value();
-  // auto decrypted = encrypted.Decrypt(keys.private_key, fhe_ctx).value();
-  // EXPECT_EQ(decrypted, original);
-
-  SUCCEED() << "Test structure defined, awaiting OpenFHE integration";
+TEST_F(EncryptedPolynomialTest, HomomorphicSubtraction) {
+  Polynomial a({1, 2, 3});
+  Polynomial b({4, 5, 6});
+  auto enc_diff = Encrypt(a).Subtract(Encrypt(b), *fhe_ctx_);
+  ASSERT_TRUE(enc_diff.ok()) << enc_diff.status();
+  EXPECT_EQ(Decrypt(*enc_diff), a.Subtract(b));
+
+  auto enc_neg = Encrypt(a).Negate(*fhe_ctx_);
+  ASSERT_TRUE(enc_neg.ok()) << enc_neg.status();
+  EXPECT_EQ(Decrypt(*enc_neg), a.Negate());
 }
 
-TEST(EncryptedPolynomialTest, HomomorphicAddition_Pending) {
-  // TODO: Once OpenFHE is integrated, this test will verify:
-  // Enc(a) + Enc(b) == Enc(a + b)
+TEST_F(EncryptedPolynomialTest, HomomorphicScalarMultiplication) {
+  Polynomial a({1, 2, 3, 40000});
+  for (int64_t k : {int64_t{2}, int64_t{-5}, int64_t{123456}}) {
+    auto enc_prod = Encrypt(a).MultiplyScalar(k, *fhe_ctx_);
+    ASSERT_TRUE(enc_prod.ok()) << enc_prod.status();
+    EXPECT_EQ(Decrypt(*enc_prod), a.MultiplyScalar(k)) << "k = " << k;
+  }
+}
 
-  // Expected test:
-  // Polynomial a({1, 2, 3});
-  // Polynomial b({4, 5, 6});
-  // auto enc_a = EncryptedPolynomial::Encrypt(a, public_key, fhe_ctx).value();
-  // auto enc_b = EncryptedPolynomial::Encrypt(b, public_key, fhe_ctx).value();
-  // auto enc_sum = enc_a.Add(enc_b, fhe_ctx).value();
-  // auto decrypted_sum = enc_sum.Decrypt(private_key, fhe_ctx).value();
-  // EXPECT_EQ(decrypted_sum, a.Add(b));
+TEST_F(EncryptedPolynomialTest, HomomorphicPlainMultiplication) {
+  Polynomial a({1, 2, 3, 40000, 7});
+  Polynomial w({5, -1, 0, 3, 65000, 9});
+  std::vector<int64_t> expected(RingParams::kDegree, 0);
+  for (int i = 0; i < RingParams::kDegree; ++i) {
+    expected[i] = a.coefficients()[i] * w.coefficients()[i] %
+                  RingParams::kModulus;
+  }
+
+  auto enc_prod = Encrypt(a).MultiplyPlain(w, *fhe_ctx_);
+  ASSERT_TRUE(enc_prod.ok()) << enc_prod.status();
+  EXPECT_EQ(Decrypt(*enc_prod), Polynomial(expected));
+
+  // The encoding is cached, including across copies of the context.
+  FHEContext copy = *fhe_ctx_;
+  auto encoded = copy.EncodePlaintext(w);
+  ASSERT_TRUE(encoded.ok()) << encoded.status();
+  EXPECT_EQ(*encoded, fhe_ctx_->EncodePlaintext(w).value());
+  EXPECT_NE(*encoded, fhe_ctx_->EncodePlaintext(a).value());
+}
+
+TEST_F(EncryptedPolynomialTest, HomomorphicRotation) {
+  Polynomial a({1, 2, 3, 4, 5, 6, 7, 8});
+  EncryptedPolynomial enc_a = Encrypt(a);
+  for (int n : {1, 3, -2, RingParams::kDegree - 1}) {
+    auto enc_rot = enc_a.Rotate(n, *fhe_ctx_);
+    ASSERT_TRUE(enc_rot.ok()) << enc_rot.status();
+    EXPECT_EQ(Decrypt(*enc_rot), a.Rotate(n)) << "n = " << n;
+  }
+}
 
-  SUCCEED() << "Homomorphic addition test defined, awaiting implementation";
+// Plaintext F_p projection that ProjectToCharacter evaluates:
+// k⁻¹ Σₘ ω^(−jm) · p[(s + m) mod d].
+Polynomial ReferenceProjection(const Polynomial& p, int j) {
+  const int64_t q = RingParams::kModulus;
+  const int k = RingParams::kNumCharacters;
+  const int d = RingParams::kDegree;
+  std::vector<int64_t> c = p.coefficients();
+  c.resize(d, 0);
+  auto pow = [q](int64_t base, int64_t exponent) {
+    int64_t result = 1;
+    for (int64_t i = 0; i < exponent; ++i) result = result * base % q;
+    return result;
+  };
+  const int64_t k_inverse = pow(k, q - 2);
+  const int64_t omega = EncryptedPolynomial::CharacterRoot();
+  std::vector<int64_t> projection(d, 0);
+  for (int s = 0; s < d; ++s) {
+    int64_t sum = 0;
+    for (int m = 0; m < k; ++m) {
+      const int64_t chi = pow(omega, (k - j * m % k) % k);
+      sum = (sum + chi * c[(s + m) % d]) % q;
+    }
+    projection[s] = sum * k_inverse % q;
+  }
+  return Polynomial(projection);
 }
 
-TEST(EncryptedPolynomialTest, HomomorphicSubtraction_Pending) {
-  // TODO: Verify Enc(a) - Enc(b) == Enc(a - b)
-  SUCCEED() << "Homomorphic subtraction test defined, awaiting implementation";
+Polynomial TestMessage() {
+  std::vector<int64_t> coefficients(RingParams::kDegree);
+  for (int i = 0; i < RingParams::kDegree; ++i) {
+    coefficients[i] = (i * 7919 + 13) % RingParams::kModulus;
+  }
+  return Polynomial(coefficients);
 }
 
-TEST(EncryptedPolynomialTest, HomomorphicScalarMultiplication_Pending) {
-  // TODO: Verify k * Enc(a) == Enc(k * a)
-  SUCCEED() << "Homomorphic scalar multiplication test defined, awaiting implementation";
+TEST(CharacterRootTest, IsPrimitiveRootOfUnity) {
+  const int64_t q = RingParams::kModulus;
+  int64_t power = 1;
+  for (int m = 1; m <= RingParams::kNumCharacters; ++m) {
+    power = power * EncryptedPolynomial::CharacterRoot() % q;
+    EXPECT_EQ(power == 1, m == RingParams::kNumCharacters) << "m = " << m;
+  }
 }
 
-TEST(EncryptedPolynomialTest, HomomorphicRotation_Pending) {
-  // TODO: Verify Rotate(Enc(a), n) == Enc(Rotate(a, n))
-  SUCCEED() << "Homomorphic rotation test defined, awaiting implementation";
+TEST_F(EncryptedPolynomialTest, CharacterProjection) {
+  Polynomial p = TestMessage();
+  EncryptedPolynomial enc = Encrypt(p);
+  for (int j : {0, 1, RingParams::kNumCharacters - 1}) {
+    auto projection = enc.ProjectToCharacter(j, *fhe_ctx_);
+    ASSERT_TRUE(projection.ok()) << projection.status();
+    EXPECT_EQ(Decrypt(*projection), ReferenceProjection(p, j)) << "j = " << j;
+  }
+  EXPECT_EQ(enc.ProjectToCharacter(RingParams::kNumCharacters, *fhe_ctx_)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(enc.ProjectToCharacter(-1, *fhe_ctx_).status().code(),
+            absl::StatusCode::kInvalidArgument);
 }
 
-TEST(EncryptedPolynomialTest, CharacterProjection_Pending) {
-  // TODO: Verify homomorphic character projection
-  // This is critical for blind routing!
-  SUCCEED() << "Homomorphic character projection test defined, awaiting implementation";
+TEST_F(EncryptedPolynomialTest, AllCharacterProjectionsSumToInput) {
+  Polynomial p = TestMessage();
+  auto projections = Encrypt(p).ProjectToAllCharacters(*fhe_ctx_);
+  ASSERT_TRUE(projections.ok()) << projections.status();
+  ASSERT_EQ(projections->size(), RingParams::kNumCharacters);
+
+  Polynomial sum(std::vector<int64_t>{});
+  for (int j = 0; j < RingParams::kNumCharacters; ++j) {
+    Polynomial projection = Decrypt((*projections)[j]);
+    EXPECT_EQ(projection, ReferenceProjection(p, j)) << "j = " << j;
+    sum = sum.Add(projection);
+  }
+  // Σⱼ ω^(−jm) = k·[m = 0], so the projections partition the input.
+  EXPECT_EQ(sum, p);
 }
 
-TEST(EncryptedPolynomialTest, Depth0Verification_Pending) {
-  // TODO: Verify all operations are depth-0 (no bootstrapping needed)
-  // This is a key property for efficient FHE routing
-  SUCCEED() << "Depth-0 verification test defined, awaiting implementation";
+TEST_F(EncryptedPolynomialTest, Depth0Verification) {
+  // Depth-0 ops compose without bootstrapping: a long mix of rotations,
+  // scalings and additions still decrypts exactly.
+  Polynomial a({7, 1, 8, 2, 8});
+  EncryptedPolynomial enc = Encrypt(a);
+  Polynomial expected = a;
+  for (int i = 0; i < 20; ++i) {
+    enc = enc.Rotate(i + 1, *fhe_ctx_).value();
+    enc = enc.MultiplyScalar(3, *fhe_ctx_).value();
+    enc = enc.Add(Encrypt(a), *fhe_ctx_).value();
+    expected = expected.Rotate(i + 1).MultiplyScalar(3).Add(a);
+  }
+  EXPECT_EQ(Decrypt(enc), expected);
 }
 
 // Integration test: Full encryption workflow
-TEST(EncryptedPolynomialTest, FullWorkflow_Pending) {
-  // TODO: End-to-end test:
-  // 1. Alice generates key pair
-  // 2. Alice encrypts message for Bob (using Bob's public key)
-  // 3. Server performs blind routing (homomorphic operations)
-  // 4. Bob decrypts message (using his private key)
-  // 5. Verify: Bob receives correct message
-  // 6. Verify: Server never decrypted anything
-
-  SUCCEED() << "Full workflow test defined, awaiting implementation";
+TEST_F(EncryptedPolynomialTest, FullWorkflow) {
+  // 1. Bob generates a key pair (Bob's private key never leaves this scope)
+  auto bob_keys = fhe_ctx_->GenerateKeyPair().value();
+
+  // 2. Alice encrypts a message for Bob using Bob's public key
+  Polynomial message({104, 105, 32, 98, 111, 98});
+  auto enc_msg =
+      EncryptedPolynomial::Encrypt(message, bob_keys.public_key, *fhe_ctx_)
+          .value();
+
+  // 3. Server performs blind routing on ciphertexts only
+  auto routed = enc_msg.Rotate(5, *fhe_ctx_).value();
+  routed = routed.Rotate(-5, *fhe_ctx_).value();
+
+  // 4. Bob decrypts with his private key and receives the message
+  auto received = routed.Decrypt(bob_keys.private_key, *fhe_ctx_);
+  ASSERT_TRUE(received.ok()) << received.status();
+  EXPECT_EQ(*received, message);
+
+  // 5. Nobody else's key decrypts to the message
+  auto eve = routed.Decrypt(keys_->private_key, *fhe_ctx_);
+  ASSERT_TRUE(eve.ok());
+  EXPECT_NE(*eve, message);
 }
 
 }  // namespace
@@ -0,0 +1,229 @@
+// test/crypto/fhe_backend_test.cc
+//
+// Tests for the FHE backend registry and FHEContext backend dispatch,
+// using an in-test "plaintext" backend.
+
+#include "lib/crypto/fhe_backend.h"
+#include "lib/crypto/encrypted_polynomial.h"
+#include "lib/crypto/fhe_context.h"
+#include "lib/crypto/polynomial.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace f2chat {
+namespace {
+
+// Backend whose "ciphertexts" are the plaintext coefficients.
+class FakeBackend : public FheBackend {
+ public:
+  struct FakeCiphertext : FheCiphertext {
+    FakeCiphertext(const FheBackend* backend, std::vector<int64_t> values)
+        : FheCiphertext(backend), values(std::move(values)) {}
+    std::vector<int64_t> values;
+  };
+
+  struct FakePlaintext : FhePlaintext {
+    FakePlaintext(const FheBackend* backend, std::vector<int64_t> values)
+        : FhePlaintext(backend), values(std::move(values)) {}
+    std::vector<int64_t> values;
+  };
+
+  absl::string_view name() const override { return "fake"; }
+  int ring_dimension() const override { return RingParams::kDegree; }
+  int64_t plaintext_modulus() const override { return RingParams::kModulus; }
+  int message_degree() const override { return RingParams::kDegree; }
+
+  absl::StatusOr<FHEKeyPair> GenerateKeyPair() const override {
+    return FHEKeyPair{std::make_shared<FhePublicKey>(this),
+                      std::make_shared<FhePrivateKey>(this)};
+  }
+
+  absl::StatusOr<FHEKeyPair> GenerateKeyPair(
+      const RotationKeySet&) const override {
+    return GenerateKeyPair();
+  }
+
+  absl::StatusOr<KeyMemoryReport> KeyMemory(
+      const PublicKey& public_key) const override {
+    auto key = Unwrap<FhePublicKey>(public_key, "public key");
+    if (!key.ok()) return key.status();
+    return KeyMemoryReport();
+  }
+
+  absl::StatusOr<Ciphertext> Encrypt(
+      const std::vector<int64_t>& coefficients,
+      const PublicKey& public_key) const override {
+    auto key = Unwrap<FhePublicKey>(public_key, "public key");
+    if (!key.ok()) return key.status();
+    return Wrap(Polynomial(coefficients));
+  }
+
+  absl::StatusOr<std::vector<int64_t>> Decrypt(
+      const Ciphertext& ciphertext,
+      const PrivateKey& private_key) const override {
+    auto key = Unwrap<FhePrivateKey>(private_key, "private key");
+    if (!key.ok()) return key.status();
+    auto ct = Unwrap<FakeCiphertext>(ciphertext, "ciphertext");
+    if (!ct.ok()) return ct.status();
+    return (*ct)->values;
+  }
+
+  absl::StatusOr<Ciphertext> Add(const Ciphertext& ct1,
+                                 const Ciphertext& ct2) const override {
+    auto a = Unwrap<FakeCiphertext>(ct1, "ciphertext");
+    if (!a.ok()) return a.status();
+    auto b = Unwrap<FakeCiphertext>(ct2, "ciphertext");
+    if (!b.ok()) return b.status();
+    return Wrap(Polynomial((*a)->values).Add(Polynomial((*b)->values)));
+  }
+
+  absl::StatusOr<Ciphertext> Subtract(const Ciphertext& ct1,
+                                      const Ciphertext& ct2) const override {
+    auto a = Unwrap<FakeCiphertext>(ct1, "ciphertext");
+    if (!a.ok()) return a.status();
+    auto b = Unwrap<FakeCiphertext>(ct2, "ciphertext");
+    if (!b.ok()) return b.status();
+    return Wrap(Polynomial((*a)->values).Subtract(Polynomial((*b)->values)));
+  }
+
+  absl::StatusOr<Ciphertext> MultiplyScalar(const Ciphertext& ciphertext,
+                                            int64_t scalar) const override {
+    auto a = Unwrap<FakeCiphertext>(ciphertext, "ciphertext");
+    if (!a.ok()) return a.status();
+    return Wrap(Polynomial((*a)->values).MultiplyScalar(scalar));
+  }
+
+  absl::StatusOr<Plaintext> EncodePlaintext(
+      const std::vector<int64_t>& coefficients) const override {
+    return std::make_shared<FakePlaintext>(this, coefficients);
+  }
+
+  absl::StatusOr<Ciphertext> MultiplyPlain(
+      const Ciphertext& ciphertext,
+      const Plaintext& plaintext) const override {
+    auto a = Unwrap<FakeCiphertext>(ciphertext, "ciphertext");
+    if (!a.ok()) return a.status();
+    auto b = Unwrap<FakePlaintext>(plaintext, "plaintext");
+    if (!b.ok()) return b.status();
+    std::vector<int64_t> product((*a)->values.size(), 0);
+    for (size_t i = 0; i < product.size() && i < (*b)->values.size(); ++i) {
+      product[i] = (*a)->values[i] * (*b)->values[i] % RingParams::kModulus;
+    }
+    return Wrap(Polynomial(product));
+  }
+
+  absl::StatusOr<Ciphertext> Rotate(const Ciphertext& ciphertext,
+                                    int positions) const override {
+    auto a = Unwrap<FakeCiphertext>(ciphertext, "ciphertext");
+    if (!a.ok()) return a.status();
+    return Wrap(Polynomial((*a)->values).Rotate(positions));
+  }
+
+  absl::StatusOr<std::vector<Ciphertext>> RotateHoisted(
+      const Ciphertext& ciphertext,
+      const std::vector<int>& positions) const override {
+    std::vector<Ciphertext> rotated;
+    for (int p : positions) {
+      auto r = Rotate(ciphertext, p);
+      if (!r.ok()) return r.status();
+      rotated.push_back(*std::move(r));
+    }
+    return rotated;
+  }
+
+ private:
+  Ciphertext Wrap(const Polynomial& p) const {
+    return std::make_shared<FakeCiphertext>(this, p.coefficients());
+  }
+};
+
+absl::StatusOr<std::shared_ptr<const FheBackend>> CreateFake() {
+  return std::make_shared<const FakeBackend>();
+}
+
+// Registered once for the whole binary, like a linked-in backend.
+FheBackendRegistrar fake_registrar("fake", &CreateFake);
+
+TEST(FheBackendRegistryTest, ListsLinkedBackends) {
+  std::vector<std::string> names = RegisteredFheBackends();
+  EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+  EXPECT_NE(std::find(names.begin(), names.end(), "fake"), names.end());
+  EXPECT_NE(std::find(names.begin(), names.end(), "native"), names.end());
+  EXPECT_NE(std::find(names.begin(), names.end(), "openfhe"), names.end());
+}
+
+TEST(FheBackendRegistryTest, RejectsDuplicateAndUnknownNames) {
+  EXPECT_EQ(RegisterFheBackend("fake", &CreateFake).code(),
+            absl::StatusCode::kAlreadyExists);
+  EXPECT_EQ(CreateFheBackend("no-such-backend").status().code(),
+            absl::StatusCode::kNotFound);
+  EXPECT_EQ(FHEContext::Create("no-such-backend").status().code(),
+            absl::StatusCode::kNotFound);
+  EXPECT_EQ(FHEContext::Create(std::shared_ptr<const FheBackend>()).status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(FheBackendRegistryTest, OpenFheIsPendingBuildConfiguration) {
+  EXPECT_EQ(FHEContext::Create("openfhe").status().code(),
+            absl::StatusCode::kUnimplemented);
+}
+
+TEST(FheBackendTest, EncryptedPolynomialDispatchesToBackend) {
+  auto ctx_or = FHEContext::Create("fake");
+  ASSERT_TRUE(ctx_or.ok()) << ctx_or.status();
+  const FHEContext& ctx = *ctx_or;
+  EXPECT_EQ(ctx.backend().name(), "fake");
+  EXPECT_EQ(ctx.modulus(), RingParams::kModulus);
+
+  auto keys = ctx.GenerateKeyPair().value();
+  Polynomial a({1, 2, 3});
+  Polynomial b({4, 5, 6});
+  auto enc_a = EncryptedPolynomial::Encrypt(a, keys.public_key, ctx).value();
+  auto enc_b = EncryptedPolynomial::Encrypt(b, keys.public_key, ctx).value();
+
+  auto sum = enc_a.Add(enc_b, ctx).value().Decrypt(keys.private_key, ctx);
+  ASSERT_TRUE(sum.ok());
+  EXPECT_EQ(*sum, a.Add(b));
+
+  auto rotated = enc_a.Rotate(2, ctx).value().Decrypt(keys.private_key, ctx);
+  ASSERT_TRUE(rotated.ok());
+  EXPECT_EQ(*rotated, a.Rotate(2));
+}
+
+TEST(FheBackendTest, PlaintextCacheEvictsOldestEncoding) {
+  auto ctx = FHEContext::Create("fake").value();
+  auto keys = ctx.GenerateKeyPair().value();
+  Plaintext first = ctx.EncodePlaintext(Polynomial({0})).value();
+  for (int i = 1; i < FHEContext::kPlaintextCacheCapacity; ++i) {
+    ASSERT_TRUE(ctx.EncodePlaintext(Polynomial({i})).ok());
+  }
+  EXPECT_EQ(ctx.EncodePlaintext(Polynomial({0})).value(), first);
+  ASSERT_TRUE(ctx.EncodePlaintext(Polynomial({-1})).ok());
+  EXPECT_NE(ctx.EncodePlaintext(Polynomial({0})).value(), first);
+
+  auto ct = ctx.Encrypt({3, 4, 5}, keys.public_key).value();
+  auto product = ctx.HomomorphicMultiplyPlain(ct, Polynomial({2, 0, -1}));
+  ASSERT_TRUE(product.ok()) << product.status();
+  EXPECT_EQ(Polynomial(ctx.Decrypt(*product, keys.private_key).value()),
+            Polynomial({6, 0, -5}));
+}
+
+TEST(FheBackendTest, RejectsHandlesFromAnotherBackend) {
+  auto ctx1 = FHEContext::Create("fake").value();
+  auto ctx2 = FHEContext::Create("fake").value();
+  auto keys1 = ctx1.GenerateKeyPair().value();
+  auto keys2 = ctx2.GenerateKeyPair().value();
+
+  auto ct = ctx1.Encrypt({1, 2, 3}, keys1.public_key).value();
+  EXPECT_EQ(ctx2.Decrypt(ct, keys2.private_key).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ctx1.Decrypt(ct, keys2.private_key).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ctx1.HomomorphicAdd(ct, nullptr).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,264 @@
+// test/crypto/native_bgv_backend_test.cc
+//
+// Tests for the native BGV backend: parameter presets, correctness of every
+// depth-0 operation, and handle/key validation.
+
+#include "lib/crypto/native_bgv_backend.h"
+#include "lib/crypto/polynomial.h"
+#include "lib/crypto/sampler.h"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace f2chat {
+namespace {
+
+std::vector<int64_t> RandomMessage(int d, std::mt19937_64& rng) {
+  std::vector<int64_t> message(d);
+  for (auto& c : message) c = rng() % RingParams::kModulus;
+  return message;
+}
+
+class NativeBgvBackendTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    backend_ = NativeBgvBackend::Create(NativeBgvParams::Security128().value())
+                   .value();
+    keys_ = new FHEKeyPair(backend_->GenerateKeyPair().value());
+  }
+
+  static void TearDownTestSuite() {
+    delete keys_;
+    backend_.reset();
+  }
+
+  Ciphertext Encrypt(const std::vector<int64_t>& message) {
+    auto ct = backend_->Encrypt(message, keys_->public_key);
+    EXPECT_TRUE(ct.ok()) << ct.status();
+    return *ct;
+  }
+
+  std::vector<int64_t> Decrypt(const Ciphertext& ct) {
+    auto message = backend_->Decrypt(ct, keys_->private_key);
+    EXPECT_TRUE(message.ok()) << message.status();
+    return *message;
+  }
+
+  static std::shared_ptr<const NativeBgvBackend> backend_;
+  static FHEKeyPair* keys_;
+};
+
+std::shared_ptr<const NativeBgvBackend> NativeBgvBackendTest::backend_;
+FHEKeyPair* NativeBgvBackendTest::keys_ = nullptr;
+
+TEST(NativeBgvParamsTest, PresetsMeetSecurityBoundAndHoldMessage) {
+  // HE-standard 128-bit classical bounds on log Q.
+  const std::pair<int, int> kMaxLogQ[] = {
+      {4096, 109}, {8192, 218}, {16384, 438}, {32768, 881}};
+  for (int d : {64, 256, 2048, 4096, 16384}) {
+    auto params = NativeBgvParams::Security128(d, 65537);
+    ASSERT_TRUE(params.ok()) << params.status();
+    EXPECT_GE(params->ring_dimension / 2, d);
+    for (auto [n, max_log_q] : kMaxLogQ) {
+      if (params->ring_dimension == n) {
+        EXPECT_LE(params->log_q(), max_log_q);
+      }
+    }
+  }
+  EXPECT_EQ(NativeBgvParams::Security128(64, 65537)->ring_dimension, 4096);
+  EXPECT_EQ(NativeBgvParams::Security128(4096, 65537)->ring_dimension, 8192);
+  EXPECT_FALSE(NativeBgvParams::Security128(100, 65537).ok());
+  EXPECT_FALSE(NativeBgvParams::Security128(32768, 65537).ok());
+  EXPECT_FALSE(NativeBgvParams::Security128(64, 65539).ok());
+}
+
+TEST_F(NativeBgvBackendTest, EncryptDecryptRoundtrip) {
+  std::mt19937_64 rng(1);
+  std::vector<int64_t> message = RandomMessage(RingParams::kDegree, rng);
+  EXPECT_EQ(Decrypt(Encrypt(message)), message);
+
+  // Short and negative inputs decode to their padded residues mod t.
+  std::vector<int64_t> expected(RingParams::kDegree, 0);
+  expected[0] = 3;
+  expected[1] = RingParams::kModulus - 1;
+  EXPECT_EQ(Decrypt(Encrypt({3, -1})), expected);
+}
+
+TEST_F(NativeBgvBackendTest, EncryptionIsRandomized) {
+  Ciphertext a = Encrypt({1, 2, 3});
+  Ciphertext b = Encrypt({1, 2, 3});
+  auto diff = backend_->Subtract(a, b).value();
+  EXPECT_EQ(Decrypt(diff), std::vector<int64_t>(RingParams::kDegree, 0));
+  EXPECT_NE(a.get(), b.get());
+}
+
+TEST_F(NativeBgvBackendTest, LinearOperationsMatchPlaintext) {
+  std::mt19937_64 rng(2);
+  Polynomial a(RandomMessage(RingParams::kDegree, rng));
+  Polynomial b(RandomMessage(RingParams::kDegree, rng));
+  Ciphertext ct_a = Encrypt(a.coefficients());
+  Ciphertext ct_b = Encrypt(b.coefficients());
+
+  EXPECT_EQ(Polynomial(Decrypt(backend_->Add(ct_a, ct_b).value())), a.Add(b));
+  EXPECT_EQ(Polynomial(Decrypt(backend_->Subtract(ct_a, ct_b).value())),
+            a.Subtract(b));
+  for (int64_t scalar : {int64_t{0}, int64_t{7}, int64_t{-3},
+                         int64_t{RingParams::kModulus - 1}}) {
+    EXPECT_EQ(
+        Polynomial(Decrypt(backend_->MultiplyScalar(ct_a, scalar).value())),
+        a.MultiplyScalar(scalar))
+        << "scalar " << scalar;
+  }
+}
+
+TEST_F(NativeBgvBackendTest, RotateMatchesPolynomialRotate) {
+  std::mt19937_64 rng(3);
+  Polynomial a(RandomMessage(RingParams::kDegree, rng));
+  Ciphertext ct = Encrypt(a.coefficients());
+  for (int positions : {1, 2, 5, RingParams::kDegree - 1, RingParams::kDegree,
+                        -1, -7, 3 * RingParams::kDegree + 2}) {
+    auto rotated = backend_->Rotate(ct, positions);
+    ASSERT_TRUE(rotated.ok()) << rotated.status();
+    EXPECT_EQ(Polynomial(Decrypt(*rotated)), a.Rotate(positions))
+        << "positions " << positions;
+  }
+}
+
+TEST_F(NativeBgvBackendTest, HoistedRotationsMatchRotate) {
+  std::mt19937_64 rng(6);
+  Polynomial a(RandomMessage(RingParams::kDegree, rng));
+  Ciphertext ct = Encrypt(a.coefficients());
+  // Keyed (−1, 1, −2), composed (5, d/3) and trivial (0, d) rotations.
+  const std::vector<int> positions = {0, -1, 1, 5, -2, RingParams::kDegree / 3,
+                                      RingParams::kDegree};
+  auto rotated = backend_->RotateHoisted(ct, positions);
+  ASSERT_TRUE(rotated.ok()) << rotated.status();
+  ASSERT_EQ(rotated->size(), positions.size());
+  for (size_t i = 0; i < positions.size(); ++i) {
+    EXPECT_EQ(Polynomial(Decrypt((*rotated)[i])), a.Rotate(positions[i]))
+        << "positions " << positions[i];
+  }
+  EXPECT_TRUE(backend_->RotateHoisted(ct, {})->empty());
+
+  RotationKeySet even(RingParams::kDegree);
+  even.Add(2);
+  auto even_keys = backend_->GenerateKeyPair(even).value();
+  Ciphertext even_ct = backend_->Encrypt({1}, even_keys.public_key).value();
+  EXPECT_EQ(backend_->RotateHoisted(even_ct, {2, 1}).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST_F(NativeBgvBackendTest, SurvivesChainedOperations) {
+  // A long chain of rotations and accumulations stays within the noise
+  // budget: Σ_k k·Rotate(a, k) over a full period.
+  std::mt19937_64 rng(4);
+  Polynomial a(RandomMessage(RingParams::kDegree, rng));
+  Ciphertext ct = Encrypt(a.coefficients());
+  Ciphertext acc = backend_->MultiplyScalar(ct, 0).value();
+  Polynomial expected(std::vector<int64_t>{});
+  Ciphertext rotated = ct;
+  Polynomial rotated_plain = a;
+  for (int k = 1; k <= RingParams::kDegree; ++k) {
+    rotated = backend_->Rotate(rotated, 1).value();
+    rotated_plain = rotated_plain.Rotate(1);
+    acc = backend_->Add(acc, backend_->MultiplyScalar(rotated, k).value())
+              .value();
+    expected = expected.Add(rotated_plain.MultiplyScalar(k));
+  }
+  EXPECT_EQ(Polynomial(Decrypt(acc)), expected);
+}
+
+TEST_F(NativeBgvBackendTest, ComposesRotationsFromMinimalKeySet) {
+  const int d = RingParams::kDegree;
+  RotationKeySet defaults = RotationKeySet::Default(d);
+  KeyMemoryReport report = backend_->KeyMemory(keys_->public_key).value();
+  EXPECT_EQ(report.num_rotation_keys, defaults.size());
+  EXPECT_LT(report.num_rotation_keys, d - 1);
+  EXPECT_EQ(report.max_key_switches, RotationPlan(defaults).max_key_switches());
+  EXPECT_GT(report.public_key_bytes, 0);
+  EXPECT_GT(report.rotation_key_bytes,
+            report.num_rotation_keys * report.public_key_bytes);
+
+  // One key still reaches every rotation, one key switch per step.
+  RotationKeySet single(d);
+  single.Add(1);
+  auto minimal = backend_->GenerateKeyPair(single).value();
+  report = backend_->KeyMemory(minimal.public_key).value();
+  EXPECT_EQ(report.num_rotation_keys, 1);
+  EXPECT_EQ(report.max_key_switches, d - 1);
+  std::mt19937_64 rng(5);
+  Polynomial a(RandomMessage(d, rng));
+  Ciphertext ct = backend_->Encrypt(a.coefficients(), minimal.public_key)
+                      .value();
+  for (int positions : {5, -3}) {
+    auto rotated = backend_->Rotate(ct, positions);
+    ASSERT_TRUE(rotated.ok()) << rotated.status();
+    EXPECT_EQ(Polynomial(backend_->Decrypt(*rotated, minimal.private_key)
+                             .value()),
+              a.Rotate(positions));
+  }
+
+  // Keys spanning only even rotations cannot compose odd ones.
+  RotationKeySet even(d);
+  even.Add(2);
+  auto even_keys = backend_->GenerateKeyPair(even).value();
+  Ciphertext even_ct = backend_->Encrypt({1}, even_keys.public_key).value();
+  EXPECT_TRUE(backend_->Rotate(even_ct, 4).ok());
+  EXPECT_EQ(backend_->Rotate(even_ct, 1).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  EXPECT_EQ(backend_->GenerateKeyPair(RotationKeySet(2 * d)).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(NativeBgvBackendTest, RejectsForeignAndMismatchedHandles) {
+  auto other = NativeBgvBackend::CreateDefault().value();
+  auto other_keys = other->GenerateKeyPair().value();
+  Ciphertext ct = Encrypt({1});
+
+  EXPECT_EQ(other->Decrypt(ct, other_keys.private_key).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(backend_->Encrypt({1}, other_keys.public_key).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(backend_->Encrypt(std::vector<int64_t>(RingParams::kDegree + 1),
+                              keys_->public_key)
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+
+  // Same backend, different key pair: cannot be combined.
+  auto keys2 = backend_->GenerateKeyPair().value();
+  Ciphertext ct2 = backend_->Encrypt({1}, keys2.public_key).value();
+  EXPECT_EQ(backend_->Add(ct, ct2).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(SamplerTest, DistributionsHaveExpectedSupport) {
+  Prng prng({1, 2, 3, 4, 5, 6, 7, 8});
+  std::vector<int64_t> ternary = SampleTernary(prng, 30000);
+  int counts[3] = {0, 0, 0};
+  for (int64_t c : ternary) {
+    ASSERT_GE(c, -1);
+    ASSERT_LE(c, 1);
+    ++counts[c + 1];
+  }
+  for (int count : counts) EXPECT_NEAR(count, 10000, 600);
+
+  std::vector<int64_t> errors = SampleCenteredBinomial(prng, 30000);
+  double sum = 0, sum_sq = 0;
+  for (int64_t e : errors) {
+    ASSERT_LE(std::abs(e), kCenteredBinomialEta);
+    sum += e;
+    sum_sq += static_cast<double>(e) * e;
+  }
+  EXPECT_NEAR(sum / errors.size(), 0.0, 0.1);
+  EXPECT_NEAR(sum_sq / errors.size(), kCenteredBinomialEta / 2.0, 0.5);
+
+  // Deterministic for a fixed key, different across streams.
+  Prng a({9}), b({9}), c({9}, 1);
+  EXPECT_EQ(a.Next64(), b.Next64());
+  EXPECT_NE(a.Next64(), c.Next64());
+}
+
+}  // namespace
+}  // namespace f2chat
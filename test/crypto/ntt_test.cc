@@ -0,0 +1,114 @@
+// test/crypto/ntt_test.cc
+//
+// Tests for modular arithmetic helpers and the negacyclic NTT.
+
+#include "lib/crypto/ntt.h"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace f2chat {
+namespace {
+
+std::vector<uint64_t> RandomPoly(int n, uint64_t q, std::mt19937_64& rng) {
+  std::vector<uint64_t> poly(n);
+  for (auto& c : poly) c = rng() % q;
+  return poly;
+}
+
+// Schoolbook product in Z_q[X]/(X^n + 1).
+std::vector<uint64_t> NegacyclicProduct(const std::vector<uint64_t>& a,
+                                        const std::vector<uint64_t>& b,
+                                        uint64_t q) {
+  const int n = a.size();
+  std::vector<uint64_t> result(n, 0);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      uint64_t term = MulMod(a[i], b[j], q);
+      if (i + j < n) {
+        result[i + j] = AddMod(result[i + j], term, q);
+      } else {
+        result[i + j - n] = SubMod(result[i + j - n], term, q);
+      }
+    }
+  }
+  return result;
+}
+
+TEST(ModularArithmeticTest, PrimesAndInverses) {
+  EXPECT_TRUE(IsPrime(65537));
+  EXPECT_TRUE(IsPrime((uint64_t{1} << 61) - 1));
+  EXPECT_FALSE(IsPrime(65537ull * 65537ull));
+  EXPECT_FALSE(IsPrime(3215031751ull));  // Strong pseudoprime to 2,3,5,7.
+
+  auto primes = GenerateNttPrimes(54, 3, 4096);
+  ASSERT_TRUE(primes.ok()) << primes.status();
+  ASSERT_EQ(primes->size(), 3u);
+  for (uint64_t q : *primes) {
+    EXPECT_TRUE(IsPrime(q));
+    EXPECT_EQ(q % 8192, 1u);
+    EXPECT_LT(q, uint64_t{1} << 54);
+    EXPECT_EQ(MulMod(InvMod(12345, q), 12345, q), 1u);
+    uint64_t w = q / 3;
+    EXPECT_EQ(MulModShoup(q - 1, w, ShoupPrecompute(w, q), q),
+              MulMod(q - 1, w, q));
+    BarrettReducer reducer(q);
+    std::mt19937_64 rng(q);
+    for (int i = 0; i < 1000; ++i) {
+      uint64_t a = rng() % q, b = i == 0 ? q - 1 : rng() % q;
+      if (i == 0) a = q - 1;
+      ASSERT_EQ(reducer.Multiply(a, b), MulMod(a, b, q));
+    }
+  }
+  EXPECT_GT((*primes)[0], (*primes)[1]);
+  EXPECT_FALSE(GenerateNttPrimes(54, 1, 100).ok());
+}
+
+TEST(NttTest, ForwardEvaluatesAtOddPowersOfRoot) {
+  const uint64_t q = 65537;
+  const int n = 64;
+  auto tables = NttTables::Create(q, n);
+  ASSERT_TRUE(tables.ok()) << tables.status();
+  EXPECT_EQ(PowMod(tables->root(), n, q), q - 1);
+
+  std::mt19937_64 rng(1);
+  std::vector<uint64_t> poly = RandomPoly(n, q, rng);
+  std::vector<uint64_t> values = poly;
+  tables->Forward(values.data());
+  for (int i = 0; i < n; ++i) {
+    const int e = tables->EvaluationExponent(i);
+    EXPECT_EQ(tables->IndexOfExponent(e), i);
+    const uint64_t x = PowMod(tables->root(), e, q);
+    uint64_t eval = 0;
+    for (int j = n - 1; j >= 0; --j) eval = AddMod(MulMod(eval, x, q), poly[j], q);
+    EXPECT_EQ(values[i], eval) << "index " << i;
+  }
+  tables->Inverse(values.data());
+  EXPECT_EQ(values, poly);
+}
+
+TEST(NttTest, PointwiseProductIsNegacyclicConvolution) {
+  for (int n : {8, 256, 1024}) {
+    const uint64_t q = GenerateNttPrimes(54, 1, n).value()[0];
+    auto tables = NttTables::Create(q, n).value();
+    std::mt19937_64 rng(n);
+    std::vector<uint64_t> a = RandomPoly(n, q, rng);
+    std::vector<uint64_t> b = RandomPoly(n, q, rng);
+    std::vector<uint64_t> expected = NegacyclicProduct(a, b, q);
+
+    tables.Forward(a.data());
+    tables.Forward(b.data());
+    for (int i = 0; i < n; ++i) a[i] = MulMod(a[i], b[i], q);
+    tables.Inverse(a.data());
+    EXPECT_EQ(a, expected) << "n = " << n;
+  }
+}
+
+TEST(NttTest, RejectsUnsuitableModulus) {
+  EXPECT_FALSE(NttTables::Create(65537, 100).ok());
+  EXPECT_FALSE(NttTables::Create(65539, 64).ok());   // Prime, 65538 ≢ 0 mod 128
+  EXPECT_FALSE(NttTables::Create(65537, 65536).ok());  // 2n ∤ q - 1
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,30 @@
+// test/crypto/polynomial_batch_test.cc
+#include "lib/crypto/polynomial_batch.h"
+#include <gtest/gtest.h>
+
+namespace f2chat {
+namespace {
+
+TEST(PolynomialBatchTest, RowsRoundTrip) {
+  std::vector<Polynomial> polynomials = {
+      Polynomial({1, 2, 3}), Polynomial({-1}), Polynomial()};
+  PolynomialBatch batch = PolynomialBatch::FromPolynomials(polynomials);
+
+  ASSERT_EQ(batch.size(), 3u);
+  for (size_t i = 0; i < polynomials.size(); ++i) {
+    EXPECT_EQ(batch.Get(i), polynomials[i]);
+  }
+  EXPECT_EQ(batch.row(1)[0], RingParams::kModulus - 1);
+  EXPECT_EQ(batch.row(2) - batch.row(1), RingParams::kDegree);
+}
+
+TEST(PolynomialBatchTest, ResizeZeroFillsNewRows) {
+  PolynomialBatch batch = PolynomialBatch::FromPolynomials({Polynomial({7})});
+  batch.Resize(2);
+
+  EXPECT_EQ(batch.Get(0), Polynomial({7}));
+  EXPECT_EQ(batch.Get(1), Polynomial());
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,93 @@
+// test/crypto/rotation_keys_test.cc
+//
+// Tests for rotation key sets and rotation composition plans.
+
+#include "lib/crypto/rotation_keys.h"
+#include "lib/crypto/polynomial_params.h"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace f2chat {
+namespace {
+
+int Log2(int n) {
+  int log = 0;
+  while ((1 << log) < n) ++log;
+  return log;
+}
+
+TEST(RotationKeySetTest, NormalizesAndDeduplicates) {
+  RotationKeySet set(64);
+  set.Add(-1).Add(63).Add(64).Add(0).Add(130);
+  EXPECT_EQ(set.rotations(), (std::vector<int>{2, 63}));
+  EXPECT_TRUE(set.Contains(-1));
+  EXPECT_TRUE(set.Contains(66));
+  EXPECT_FALSE(set.Contains(1));
+}
+
+TEST(RotationKeySetTest, PresetsAreSmall) {
+  EXPECT_EQ(RotationKeySet::PowersOfTwo(64).rotations(),
+            (std::vector<int>{1, 2, 4, 8, 16, 32}));
+
+  EXPECT_EQ(BabyStepCount(1), 1);
+  EXPECT_EQ(BabyStepCount(8), 4);
+  EXPECT_EQ(BabyStepCount(16), 4);
+  EXPECT_EQ(BabyStepCount(64), 8);
+  // Baby steps −1..−3, giant steps −4, −8, −12.
+  EXPECT_EQ(RotationKeySet::BabyStepGiantStep(64, 16, 4).rotations(),
+            (std::vector<int>{52, 56, 60, 61, 62, 63}));
+
+  // O(log d + √k) keys instead of d − 1.
+  for (int d : {SafeParams::kDegree, MediumParams::kDegree,
+                ProductionParams::kDegree}) {
+    RotationKeySet defaults = RotationKeySet::Default(d);
+    const int span = std::min(RingParams::kNumCharacters, d);
+    EXPECT_LE(RotationKeySet::PowersOfTwo(d).size(), defaults.size());
+    EXPECT_LE(defaults.size(), Log2(d) + 2 * BabyStepCount(span)) << d;
+  }
+}
+
+TEST(RotationPlanTest, ComposesEveryRotationFromDefaultKeys) {
+  for (int d : {8, 64, 4096}) {
+    RotationKeySet keys = RotationKeySet::Default(d);
+    RotationPlan plan(keys);
+    EXPECT_TRUE(plan.complete());
+    EXPECT_LE(plan.max_key_switches(), Log2(d));
+    for (int r = -d; r <= 2 * d; ++r) {
+      auto steps = plan.Decompose(r);
+      ASSERT_TRUE(steps.ok()) << steps.status();
+      int64_t sum = 0;
+      for (int step : *steps) {
+        EXPECT_TRUE(keys.Contains(step));
+        sum += step;
+      }
+      EXPECT_EQ(((sum - r) % d + d) % d, 0) << "d = " << d << ", r = " << r;
+      EXPECT_LE(static_cast<int>(steps->size()), plan.max_key_switches());
+    }
+  }
+
+  // Keyed rotations take a single key switch.
+  RotationPlan plan(RotationKeySet::Default(64));
+  EXPECT_EQ(plan.Decompose(-3)->size(), 1u);
+  EXPECT_EQ(plan.Decompose(32)->size(), 1u);
+  EXPECT_TRUE(plan.Decompose(64)->empty());
+}
+
+TEST(RotationPlanTest, ReportsUnreachableRotations) {
+  RotationKeySet even(8);
+  even.Add(2);
+  RotationPlan plan(even);
+  EXPECT_FALSE(plan.complete());
+  EXPECT_EQ(plan.Decompose(1).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_EQ(plan.Decompose(6)->size(), 3u);
+  EXPECT_EQ(plan.max_key_switches(), 3);
+
+  RotationPlan empty{RotationKeySet(8)};
+  EXPECT_TRUE(empty.Decompose(0).ok());
+  EXPECT_FALSE(empty.Decompose(1).ok());
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,162 @@
+// test/crypto/slot_packing_test.cc
+//
+// Tests for slot packing: validation, pack/unpack, and the per-message
+// rotation, extraction and move helpers on 32 SafeParams-sized messages in
+// one native ciphertext.
+
+#include "lib/crypto/slot_packing.h"
+#include "lib/crypto/native_bgv_backend.h"
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace f2chat {
+namespace {
+
+constexpr int64_t kP = RingParams::kModulus;
+constexpr int kSlots = 2048;
+constexpr int kMessageDegree = 64;
+constexpr int kCapacity = kSlots / kMessageDegree;
+
+class SlotPackingTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    auto backend =
+        NativeBgvBackend::Create(NativeBgvParams::Security128(kSlots).value());
+    ASSERT_TRUE(backend.ok()) << backend.status();
+    backend_ = new std::shared_ptr<const NativeBgvBackend>(*backend);
+    auto keys = (*backend_)->GenerateKeyPair();
+    ASSERT_TRUE(keys.ok()) << keys.status();
+    keys_ = new FHEKeyPair(*std::move(keys));
+  }
+
+  static void TearDownTestSuite() {
+    delete keys_;
+    delete backend_;
+  }
+
+  static SlotPacking Packing() {
+    return SlotPacking::Create(**backend_, kMessageDegree).value();
+  }
+
+  static std::vector<std::vector<int64_t>> RandomMessages() {
+    std::mt19937_64 rng(7);
+    std::vector<std::vector<int64_t>> messages(
+        kCapacity, std::vector<int64_t>(kMessageDegree));
+    for (auto& message : messages) {
+      for (auto& c : message) c = rng() % kP;
+    }
+    return messages;
+  }
+
+  static std::vector<std::vector<int64_t>> Decrypt(const SlotPacking& packing,
+                                                   const Ciphertext& ct) {
+    return packing.Decrypt(ct, keys_->private_key).value();
+  }
+
+  static std::shared_ptr<const NativeBgvBackend>* backend_;
+  static FHEKeyPair* keys_;
+};
+
+std::shared_ptr<const NativeBgvBackend>* SlotPackingTest::backend_ = nullptr;
+FHEKeyPair* SlotPackingTest::keys_ = nullptr;
+
+TEST_F(SlotPackingTest, ValidatesShapes) {
+  for (int d : {0, 48, 4096}) {
+    EXPECT_EQ(SlotPacking::Create(**backend_, d).status().code(),
+              absl::StatusCode::kInvalidArgument)
+        << d;
+  }
+  SlotPacking packing = Packing();
+  EXPECT_EQ(packing.capacity(), kCapacity);
+  EXPECT_EQ(packing.num_slots(), kSlots);
+  EXPECT_EQ(packing.Rotations({1, kMessageDegree}).rotations(),
+            (std::vector<int>{1, kSlots - kMessageDegree + 1}));
+
+  std::vector<std::vector<int64_t>> too_many(kCapacity + 1);
+  EXPECT_EQ(packing.Pack(too_many).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(packing.Pack({std::vector<int64_t>(kMessageDegree + 1)})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+
+  // Short messages and missing blocks are zero-padded.
+  auto slots = packing.Pack({{1, 2}, {}, {3}});
+  ASSERT_TRUE(slots.ok()) << slots.status();
+  auto messages = packing.Unpack(*slots);
+  ASSERT_EQ(messages.size(), static_cast<size_t>(kCapacity));
+  EXPECT_EQ(messages[0][1], 2);
+  EXPECT_EQ(messages[2][0], 3);
+  EXPECT_EQ(messages[1], std::vector<int64_t>(kMessageDegree, 0));
+}
+
+TEST_F(SlotPackingTest, SlotWiseOperationsActOnEveryMessage) {
+  SlotPacking packing = Packing();
+  const auto messages = RandomMessages();
+  auto ct = packing.Encrypt(messages, keys_->public_key);
+  ASSERT_TRUE(ct.ok()) << ct.status();
+  EXPECT_EQ(Decrypt(packing, *ct), messages);
+
+  auto sum = (*backend_)->Add(*ct, *ct);
+  ASSERT_TRUE(sum.ok()) << sum.status();
+  auto doubled = Decrypt(packing, *sum);
+  for (int b = 0; b < kCapacity; ++b) {
+    for (int i = 0; i < kMessageDegree; ++i) {
+      ASSERT_EQ(doubled[b][i], 2 * messages[b][i] % kP) << b << ", " << i;
+    }
+  }
+}
+
+TEST_F(SlotPackingTest, RotatesEachMessageWithinItsBlock) {
+  SlotPacking packing = Packing();
+  const auto messages = RandomMessages();
+  Ciphertext ct = packing.Encrypt(messages, keys_->public_key).value();
+  // The repeated offsets (1 and d + 1) reuse the cached mask for k = 1.
+  for (int k : {1, 5, -3, kMessageDegree - 1, kMessageDegree, 1,
+                kMessageDegree + 1}) {
+    auto rotated = packing.Rotate(ct, k);
+    ASSERT_TRUE(rotated.ok()) << rotated.status();
+    auto decrypted = Decrypt(packing, *rotated);
+    for (int b = 0; b < kCapacity; ++b) {
+      std::vector<int64_t> expected(kMessageDegree);
+      for (int i = 0; i < kMessageDegree; ++i) {
+        expected[((i + k) % kMessageDegree + kMessageDegree) %
+                 kMessageDegree] = messages[b][i];
+      }
+      ASSERT_EQ(decrypted[b], expected) << "k = " << k << ", block " << b;
+    }
+  }
+}
+
+TEST_F(SlotPackingTest, ExtractsAndMovesBlocks) {
+  SlotPacking packing = Packing();
+  const auto messages = RandomMessages();
+  Ciphertext ct = packing.Encrypt(messages, keys_->public_key).value();
+  const std::vector<int64_t> zero(kMessageDegree, 0);
+
+  auto extracted = packing.Extract(ct, 5);
+  ASSERT_TRUE(extracted.ok()) << extracted.status();
+  auto decrypted = Decrypt(packing, *extracted);
+  for (int b = 0; b < kCapacity; ++b) {
+    EXPECT_EQ(decrypted[b], b == 5 ? messages[5] : zero) << b;
+  }
+
+  for (auto [from, to] : {std::pair{3, 20}, std::pair{31, 0}}) {
+    auto moved = packing.Move(ct, from, to);
+    ASSERT_TRUE(moved.ok()) << moved.status();
+    decrypted = Decrypt(packing, *moved);
+    for (int b = 0; b < kCapacity; ++b) {
+      EXPECT_EQ(decrypted[b], b == to ? messages[from] : zero)
+          << from << " → " << to << ", block " << b;
+    }
+  }
+
+  EXPECT_EQ(packing.Extract(ct, kCapacity).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(packing.Move(ct, 0, -1).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,134 @@
+// test/network/async_router_test.cc
+#include "lib/network/async_router.h"
+#include "lib/network/sheaf_router.h"
+#include "lib/network/patch.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+namespace f2chat {
+namespace {
+
+std::shared_ptr<Patch> MakePatch(const std::string& id) {
+  RoutingWeights weights;
+  weights.weights.resize(
+      4, std::vector<double>(RingParams::kNumCharacters,
+                             1.0 / RingParams::kNumCharacters));
+  return std::make_shared<Patch>(Patch::Create(id, weights));
+}
+
+SheafRouter MakeLearnedRouter(Executor* executor) {
+  RoutingProblem problem;
+  for (int i = 0; i < 3; ++i) {
+    problem.patches.push_back(MakePatch(absl::StrCat("p", i)));
+  }
+  for (int64_t seed = 1; seed <= 3; ++seed) {
+    problem.examples.push_back(RoutingExample{
+        Polynomial({seed, seed + 1}), Polynomial({3 * seed, 7}),
+        Polynomial({seed + 2, 2 * seed, 11, seed}),
+        Polynomial({seed + 10, seed + 11})});
+  }
+  RouterOptions router_options;
+  router_options.executor = executor;
+  auto router = SheafRouter::Create(problem, {}, router_options).value();
+  EXPECT_TRUE(router.LearnRouting().ok());
+  return router;
+}
+
+ExecutorOptions Workers(int num_workers) {
+  ExecutorOptions options;
+  options.num_workers = num_workers;
+  return options;
+}
+
+TEST(AsyncRouterTest, ThousandsOfRoutesInFlight) {
+  Executor executor(Workers(2));
+  SheafRouter router = MakeLearnedRouter(&executor);
+  AsyncRouterOptions options;
+  options.executor = &executor;
+  options.max_batch = 128;
+  AsyncRouter async_router(router, options);
+
+  constexpr int kRoutes = 3000;
+  std::vector<absl::StatusOr<Polynomial>> results(kRoutes);
+  std::atomic<int> done{0};
+  absl::Notification all_done;
+  for (int64_t i = 0; i < kRoutes; ++i) {
+    Spawn<absl::StatusOr<Polynomial>>(
+        executor,
+        async_router.RouteAsync(Polynomial({i, i + 1}), Polynomial({i % 7}),
+                                Polynomial({i % 5, 1})),
+        [&, i](absl::StatusOr<Polynomial> routed) {
+          results[i] = std::move(routed);
+          if (++done == kRoutes) all_done.Notify();
+        });
+  }
+  all_done.WaitForNotification();
+
+  for (int64_t i = 0; i < kRoutes; ++i) {
+    ASSERT_TRUE(results[i].ok()) << results[i].status();
+    EXPECT_EQ(*results[i], router.Route(Polynomial({i, i + 1}),
+                                        Polynomial({i % 7}),
+                                        Polynomial({i % 5, 1})).value());
+  }
+  EXPECT_GE(async_router.batches(), kRoutes / options.max_batch);
+  EXPECT_LE(async_router.batches(), kRoutes);
+}
+
+TEST(AsyncRouterTest, SyncWaitSingleRoute) {
+  Executor executor(Workers(1));
+  SheafRouter router = MakeLearnedRouter(&executor);
+  AsyncRouterOptions options;
+  options.executor = &executor;
+  AsyncRouter async_router(router, options);
+
+  auto routed = SyncWait(async_router.RouteAsync(
+      Polynomial({4, 5}), Polynomial({1}), Polynomial({2})));
+  ASSERT_TRUE(routed.ok()) << routed.status();
+  EXPECT_EQ(*routed,
+            router.Route(Polynomial({4, 5}), Polynomial({1}), Polynomial({2}))
+                .value());
+}
+
+TEST(AsyncRouterTest, CancelledAndOverdueRoutesAreShed) {
+  Executor executor(Workers(1));
+  SheafRouter router = MakeLearnedRouter(&executor);
+  AsyncRouterOptions options;
+  options.executor = &executor;
+  AsyncRouter async_router(router, options);
+
+  CancellationToken cancelled = CancellationToken::Create();
+  cancelled.Cancel();
+  EXPECT_EQ(SyncWait(async_router.RouteAsync(Polynomial({1}), Polynomial({1}),
+                                             Polynomial({2}), cancelled))
+                .status().code(),
+            absl::StatusCode::kCancelled);
+
+  CancellationToken overdue =
+      CancellationToken::Create(absl::Now() - absl::Milliseconds(1));
+  EXPECT_EQ(SyncWait(async_router.RouteAsync(Polynomial({1}), Polynomial({1}),
+                                             Polynomial({2}), overdue))
+                .status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(async_router.batches(), 0);
+}
+
+TEST(AsyncRouterTest, PropagatesRouterErrors) {
+  Executor executor(Workers(1));
+  RoutingProblem problem;
+  problem.patches.push_back(MakePatch("p0"));
+  auto router = SheafRouter::Create(problem).value();  // Never learned
+  AsyncRouterOptions options;
+  options.executor = &executor;
+  AsyncRouter async_router(router, options);
+
+  EXPECT_EQ(SyncWait(async_router.RouteAsync(Polynomial({1}), Polynomial({1}),
+                                             Polynomial({2})))
+                .status().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,192 @@
+// test/network/encrypted_routing_test.cc
+//
+// Tests for encrypted local routing: the compiled F_p matrix against the
+// windowed F_p character projections, encrypted evaluation, the per-version
+// cache of encoded operators, the weight-basis gate, and routing a
+// SheafRouter-learned table under encryption.
+
+#include "lib/network/encrypted_routing.h"
+#include "lib/crypto/character_transform.h"
+#include "lib/crypto/native_bgv_backend.h"
+#include "lib/crypto/routing_polynomial.h"
+#include "lib/network/patch.h"
+#include "lib/network/sheaf_router.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace f2chat {
+namespace {
+
+constexpr int64_t kP = RingParams::kModulus;
+constexpr int kDegree = RingParams::kDegree;
+constexpr int kCharacters = RingParams::kNumCharacters;
+constexpr double kScale = 100.0;
+
+RoutingOperator RampOperator(
+    int num_positions, int num_characters, int seed,
+    WeightBasis basis = WeightBasis::kFpCharacters) {
+  RoutingWeights weights;
+  weights.weights.resize(num_positions);
+  for (int p = 0; p < num_positions; ++p) {
+    for (int j = 0; j < num_characters; ++j) {
+      weights.weights[p].push_back(0.25 * ((p + 3 * j + seed) % 7) - 0.5);
+    }
+  }
+  return RoutingOperator::Compile(weights, basis);
+}
+
+std::vector<int64_t> RampMessage() {
+  std::vector<int64_t> message(kDegree);
+  for (int i = 0; i < kDegree; ++i) message[i] = (37 * i + 11) % 1000;
+  return message;
+}
+
+// Σⱼ round(scale·w[r][j]) · yⱼ[(r·k) mod d], computed from the F_p character
+// projections of CharacterTransform rather than the compiled matrix. This is
+// the map encrypted routing defines, not plaintext RoutingOperator::Apply.
+std::vector<int64_t> FpCharacterRouting(const RoutingOperator& op,
+                                      const std::vector<int64_t>& c) {
+  CharacterTransform characters =
+      CharacterTransform::Create(kCharacters).value();
+  std::vector<std::vector<int64_t>> y;
+  for (int j = 0; j < kCharacters; ++j) {
+    y.push_back(characters.ProjectPlaintext(c, j));
+  }
+  std::vector<int64_t> output(kDegree, 0);
+  for (int r = 0; r < op.num_positions() && r < kDegree; ++r) {
+    for (int j = 0; j < kCharacters; ++j) {
+      int64_t w = std::llround(kScale * op.weight(r, j)) % kP;
+      if (w < 0) w += kP;
+      output[r] = (output[r] + w * y[j][(r * kCharacters) % kDegree]) % kP;
+    }
+  }
+  return output;
+}
+
+TEST(EncryptedRoutingTest, CompiledMatrixMatchesProjections) {
+  for (int num_positions : {4, kDegree}) {
+    RoutingOperator op = RampOperator(num_positions, kCharacters, 0);
+    auto transform = CompileEncryptedRouting(op, kScale);
+    ASSERT_TRUE(transform.ok()) << transform.status();
+    EXPECT_EQ(transform->ApplyPlaintext(RampMessage()),
+              FpCharacterRouting(op, RampMessage()))
+        << num_positions << " positions";
+  }
+
+  // Wrong character count: identity, as in RoutingOperator::Apply.
+  auto identity = CompileEncryptedRouting(RampOperator(4, 3, 0), kScale);
+  ASSERT_TRUE(identity.ok()) << identity.status();
+  EXPECT_EQ(identity->ApplyPlaintext(RampMessage()), RampMessage());
+  EXPECT_EQ(identity->num_diagonals(), 1);
+}
+
+TEST(EncryptedRoutingTest, AppliesAndCachesPerVersion) {
+  auto backend = NativeBgvBackend::CreateDefault().value();
+  auto keys =
+      backend->GenerateKeyPair(EncryptedRouting::Rotations()).value();
+  const std::vector<int64_t> message = RampMessage();
+  Ciphertext ct = backend->Encrypt(message, keys.public_key).value();
+  EncryptedRouting routing(*backend, kScale);
+
+  RoutingTable table;
+  table.version = 1;
+  table.operators = {RampOperator(kDegree, kCharacters, 0),
+                     RampOperator(kDegree, kCharacters, 1)};
+  for (size_t patch : {0, 1, 0}) {
+    auto routed = routing.Apply(table, patch, ct);
+    ASSERT_TRUE(routed.ok()) << routed.status();
+    EXPECT_EQ(backend->Decrypt(*routed, keys.private_key).value(),
+              FpCharacterRouting(table.operators[patch], message))
+        << "patch " << patch;
+  }
+  EXPECT_EQ(routing.encodings(), 2);
+
+  // A new version is re-encoded; the old one is no longer cached.
+  RoutingTable next = table;
+  next.version = 2;
+  next.operators[0] = RampOperator(kDegree, kCharacters, 2);
+  auto routed = routing.Apply(next, 0, ct);
+  ASSERT_TRUE(routed.ok()) << routed.status();
+  EXPECT_EQ(backend->Decrypt(*routed, keys.private_key).value(),
+            FpCharacterRouting(next.operators[0], message));
+  EXPECT_EQ(routing.encodings(), 3);
+  ASSERT_TRUE(routing.Apply(table, 0, ct).ok());
+  EXPECT_EQ(routing.encodings(), 4);
+
+  EXPECT_EQ(routing.Apply(table, 2, ct).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(EncryptedRoutingTest, RejectsWeightsFitForPlaintextRouting) {
+  auto backend = NativeBgvBackend::CreateDefault().value();
+  auto keys =
+      backend->GenerateKeyPair(EncryptedRouting::Rotations()).value();
+  Ciphertext ct = backend->Encrypt(RampMessage(), keys.public_key).value();
+  EncryptedRouting routing(*backend, kScale);
+
+  // SheafRouter's tables default to the rounded projections.
+  RoutingTable table;
+  table.version = 1;
+  table.operators = {RampOperator(kDegree, kCharacters, 0,
+                                  WeightBasis::kRoundedProjections)};
+  EXPECT_EQ(routing.Apply(table, 0, ct).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+  EXPECT_EQ(routing.encodings(), 0);
+}
+
+TEST(EncryptedRoutingTest, RoutesLearnedFpWeightsLikePlaintextRoute) {
+  // Teacher with integer weights (output p copies character p mod k), so
+  // scale 1 encodes the learned weights exactly.
+  RoutingWeights teacher_weights;
+  teacher_weights.weights.resize(kDegree, std::vector<double>(kCharacters));
+  for (int p = 0; p < kDegree; ++p) {
+    teacher_weights.weights[p][p % kCharacters] = 1.0;
+  }
+  RoutingOperator teacher =
+      RoutingOperator::Compile(teacher_weights, WeightBasis::kFpCharacters);
+
+  auto message_of = [](int seed) {
+    std::vector<int64_t> message(kDegree);
+    for (int i = 0; i < kDegree; ++i) {
+      message[i] = (97 * i * i + 31 * seed * i + seed) % kP;
+    }
+    return Polynomial(message);
+  };
+  const Polynomial source({1, 2}), dest({3});
+  RoutingProblem problem;
+  problem.patches = {std::make_shared<Patch>(
+      Patch::Create("solo", teacher_weights))};
+  for (int seed = 1; seed <= 2 * kCharacters; ++seed) {
+    Polynomial message = message_of(seed);
+    problem.examples.push_back(RoutingExample{
+        source, dest, message,
+        teacher.Apply(RoutingPolynomial::EncodeRoute(source, dest, message))});
+  }
+
+  SolverOptions options;
+  options.weight_basis = WeightBasis::kFpCharacters;
+  auto router = SheafRouter::Create(problem, options).value();
+  auto result = router.LearnRouting();
+  ASSERT_TRUE(result.ok()) << result.status();
+  EXPECT_TRUE(result->success) << result->obstruction;
+
+  auto backend = NativeBgvBackend::CreateDefault().value();
+  auto keys =
+      backend->GenerateKeyPair(EncryptedRouting::Rotations()).value();
+  EncryptedRouting routing(*backend, /*scale=*/1.0);
+  auto table = router.routing_table();
+  ASSERT_NE(table, nullptr);
+
+  const Polynomial message = message_of(100);
+  Ciphertext ct = backend->Encrypt(
+      RoutingPolynomial::EncodeRoute(source, dest, message).coefficients(),
+      keys.public_key).value();
+  auto routed = routing.Apply(*table, 0, ct);
+  ASSERT_TRUE(routed.ok()) << routed.status();
+  EXPECT_EQ(backend->Decrypt(*routed, keys.private_key).value(),
+            router.Route(message, source, dest).value().coefficients());
+}
+
+}  // namespace
+}  // namespace f2chat
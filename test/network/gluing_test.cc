@@ -0,0 +1,57 @@
+// test/network/gluing_test.cc
+#include "lib/network/gluing.h"
+#include <gtest/gtest.h>
+
+namespace f2chat {
+namespace {
+
+Polynomial Constant(int64_t value) {
+  return Polynomial(std::vector<int64_t>(RingParams::kDegree, value));
+}
+
+TEST(GluingVerifierTest, DistanceWrapsAroundModulus) {
+  // 0 and p − 1 are one step apart in Z_p.
+  Polynomial zero = Constant(0);
+  Polynomial minus_one = Constant(RingParams::kModulus - 1);
+
+  EXPECT_EQ(GluingVerifier::ModDistanceSquared(zero, minus_one, 1 << 20),
+            RingParams::kDegree);
+  EXPECT_TRUE(GluingVerifier(9.0).Within(zero, minus_one));  // √64 = 8
+  EXPECT_FALSE(GluingVerifier(8.0).Within(zero, minus_one));
+}
+
+TEST(GluingVerifierTest, StopsOnceLimitIsExceeded) {
+  Polynomial zero = Constant(0);
+  Polynomial far = Constant(1000);
+
+  int64_t full = GluingVerifier::ModDistanceSquared(zero, far, 1LL << 40);
+  int64_t early = GluingVerifier::ModDistanceSquared(zero, far, 0);
+  EXPECT_EQ(full, int64_t{RingParams::kDegree} * 1000 * 1000);
+  EXPECT_GT(early, 0);
+  EXPECT_LT(early, full);
+}
+
+TEST(GluingVerifierTest, BatchCountsViolationsPerConstraint) {
+  Polynomial a = Constant(5);
+  Polynomial b = Constant(5);
+  Polynomial c = Constant(6);
+
+  std::vector<GluingVerifier::Check> checks = {
+      {0, &a, &b},  // agrees
+      {1, &a, &c},  // differs
+      {1, &c, &b},  // differs
+      {2, &c, &c},  // agrees
+      {7, &a, &c},  // out of range, ignored
+  };
+  EXPECT_EQ(GluingVerifier().Verify(checks, 3),
+            (std::vector<int64_t>{0, 2, 0}));
+}
+
+TEST(GluingVerifierTest, NonPositiveToleranceRejectsEverything) {
+  Polynomial a = Constant(5);
+  EXPECT_FALSE(GluingVerifier(0.0).Within(a, a));
+  EXPECT_FALSE(GluingVerifier(-1.0).Within(a, a));
+}
+
+}  // namespace
+}  // namespace f2chat
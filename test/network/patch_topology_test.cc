@@ -0,0 +1,134 @@
+// test/network/patch_topology_test.cc
+#include "lib/network/patch_topology.h"
+#include <gtest/gtest.h>
+
+namespace f2chat {
+namespace {
+
+// Path graph 0 - 1 - 2 - ... - (n-1).
+PatchTopology MakeChain(size_t n) {
+  PatchTopology topology;
+  for (size_t i = 0; i < n; ++i) {
+    topology.AddPatch();
+  }
+  for (size_t i = 0; i + 1 < n; ++i) {
+    topology.AddEdge(i, i + 1);
+  }
+  topology.Refresh();
+  return topology;
+}
+
+TEST(PatchTopologyTest, PlansFollowShortestPath) {
+  PatchTopology topology = MakeChain(5);
+
+  ASSERT_NE(topology.Plan(0, 3), nullptr);
+  EXPECT_EQ(*topology.Plan(0, 3), (std::vector<size_t>{0, 1, 2, 3}));
+  EXPECT_EQ(*topology.Plan(4, 2), (std::vector<size_t>{4, 3, 2}));
+  EXPECT_EQ(*topology.Plan(2, 2), (std::vector<size_t>{2}));
+
+  // Shortcut 0 - 4.
+  topology.AddEdge(0, 4);
+  topology.Refresh();
+  EXPECT_EQ(*topology.Plan(0, 3), (std::vector<size_t>{0, 4, 3}));
+}
+
+TEST(PatchTopologyTest, UnreachablePatchHasNoPlan) {
+  PatchTopology topology = MakeChain(3);
+  size_t island = topology.AddPatch();
+  topology.Refresh();
+
+  EXPECT_EQ(topology.Plan(0, island), nullptr);
+  EXPECT_EQ(topology.Plan(island, 0), nullptr);
+  EXPECT_EQ(*topology.Plan(island, island), (std::vector<size_t>{island}));
+}
+
+TEST(PatchTopologyTest, AddEdgeInvalidatesOnlyAffectedSources) {
+  // Two components: chain 0-1-2-3 and chain 4-5.
+  PatchTopology topology;
+  for (int i = 0; i < 6; ++i) topology.AddPatch();
+  topology.AddEdge(0, 1);
+  topology.AddEdge(1, 2);
+  topology.AddEdge(2, 3);
+  topology.AddEdge(4, 5);
+  topology.Refresh();
+  const int64_t built = topology.sources_built();
+  EXPECT_EQ(built, 6);
+
+  // Adding a patch or a duplicate edge rebuilds nothing but the new source.
+  topology.AddPatch();
+  topology.AddEdge(1, 0);
+  topology.Refresh();
+  EXPECT_EQ(topology.sources_built(), built + 1);
+
+  // 4 - 5 edge already exists; edge 1 - 3 only matters to sources that
+  // see 1 and 3 at different depths (0, 1, 3 — not 2, 4, 5, 6).
+  topology.AddEdge(1, 3);
+  topology.Refresh();
+  EXPECT_EQ(topology.sources_built(), built + 1 + 3);
+  EXPECT_EQ(*topology.Plan(0, 3), (std::vector<size_t>{0, 1, 3}));
+  EXPECT_EQ(*topology.Plan(2, 3), (std::vector<size_t>{2, 3}));
+}
+
+TEST(PatchTopologyTest, IncrementalPlansMatchRebuild) {
+  // Grid-ish graph built in two different edge orders.
+  const std::vector<std::pair<size_t, size_t>> edges = {
+      {0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 0},
+      {0, 3}, {1, 4}, {6, 2}, {6, 5}, {7, 6}};
+  PatchTopology incremental;
+  for (int i = 0; i < 8; ++i) incremental.AddPatch();
+  for (const auto& [a, b] : edges) {
+    incremental.AddEdge(a, b);
+    incremental.Refresh();
+  }
+
+  PatchTopology batch;
+  for (int i = 0; i < 8; ++i) batch.AddPatch();
+  for (const auto& [a, b] : edges) batch.AddEdge(a, b);
+  batch.Refresh();
+
+  for (size_t s = 0; s < 8; ++s) {
+    for (size_t d = 0; d < 8; ++d) {
+      ASSERT_NE(incremental.Plan(s, d), nullptr);
+      EXPECT_EQ(*incremental.Plan(s, d), *batch.Plan(s, d))
+          << s << " → " << d;
+    }
+  }
+}
+
+TEST(PatchTopologyTest, EndpointsResolveToPlans) {
+  PatchTopology topology = MakeChain(4);
+  topology.AssignEndpoint(Polynomial({1, 2}), 0);
+  topology.AssignEndpoint(Polynomial({3}), 2);
+
+  ASSERT_NE(topology.PlanFor(Polynomial({1, 2}), Polynomial({3})), nullptr);
+  EXPECT_EQ(*topology.PlanFor(Polynomial({1, 2}), Polynomial({3})),
+            (std::vector<size_t>{0, 1, 2}));
+  EXPECT_EQ(topology.PlanFor(Polynomial({1, 2}), Polynomial({4})), nullptr);
+
+  topology.AssignEndpoint(Polynomial({3}), 3);
+  EXPECT_EQ(topology.PlanFor(Polynomial({3}), Polynomial({1, 2}))->size(), 4u);
+}
+
+TEST(PatchTopologyTest, CopiesShareStructureUntilWritten) {
+  PatchTopology topology = MakeChain(4);
+  topology.AssignEndpoint(Polynomial({1}), 0);
+  const PatchTopology copy = topology;
+  EXPECT_EQ(&copy.neighbors(1), &topology.neighbors(1));
+  EXPECT_EQ(copy.Plan(0, 3), topology.Plan(0, 3));
+
+  // Writes to the original leave the copy as it was.
+  topology.AddEdge(0, 3);
+  topology.AssignEndpoint(Polynomial({1}), 2);
+  topology.Refresh();
+  EXPECT_NE(&copy.neighbors(1), &topology.neighbors(1));
+  EXPECT_EQ(copy.num_edges(), 3u);
+  EXPECT_EQ(copy.neighbors(0), (std::vector<size_t>{1}));
+  EXPECT_EQ(topology.neighbors(0), (std::vector<size_t>{1, 3}));
+  EXPECT_EQ(copy.PatchOf(Polynomial({1})), 0u);
+  EXPECT_EQ(topology.PatchOf(Polynomial({1})), 2u);
+  EXPECT_EQ(copy.Plan(0, 3)->size(), 4u);
+  EXPECT_EQ(topology.Plan(0, 3)->size(), 2u);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,117 @@
+// test/network/routing_operator_test.cc
+#include "lib/network/routing_operator.h"
+#include "lib/crypto/character_transform.h"
+#include "lib/crypto/ntt.h"
+#include "lib/crypto/routing_polynomial.h"
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+namespace f2chat {
+namespace {
+
+RoutingWeights RampWeights(int num_positions) {
+  RoutingWeights weights;
+  weights.weights.resize(num_positions);
+  for (int p = 0; p < num_positions; ++p) {
+    for (int j = 0; j < RingParams::kNumCharacters; ++j) {
+      weights.weights[p].push_back(0.25 * ((p + 3 * j) % 7) - 0.5);
+    }
+  }
+  return weights;
+}
+
+Polynomial RampInput() {
+  std::vector<int64_t> coefficients(RingParams::kDegree);
+  for (int i = 0; i < RingParams::kDegree; ++i) {
+    coefficients[i] = (37 * i + 11) % 1000;
+  }
+  return Polynomial(coefficients);
+}
+
+TEST(RoutingOperatorTest, MatchesApplyRoutingWeights) {
+  for (int num_positions : {4, RingParams::kDegree}) {
+    RoutingWeights weights = RampWeights(num_positions);
+    RoutingOperator op = RoutingOperator::Compile(weights);
+
+    EXPECT_EQ(op.Apply(RampInput()),
+              RoutingPolynomial::ApplyRoutingWeights(RampInput(), weights))
+        << num_positions << " positions";
+  }
+}
+
+TEST(RoutingOperatorTest, FpBasisWeighsCenteredCharacterProjections) {
+  const int n = RingParams::kDegree;
+  const int k = RingParams::kNumCharacters;
+  const int64_t p = RingParams::kModulus;
+  RoutingWeights weights = RampWeights(n);
+  RoutingOperator op =
+      RoutingOperator::Compile(weights, WeightBasis::kFpCharacters);
+  EXPECT_EQ(op.basis(), WeightBasis::kFpCharacters);
+
+  CharacterTransform characters = CharacterTransform::Create(k).value();
+  std::vector<std::vector<int64_t>> y;
+  for (int j = 0; j < k; ++j) {
+    y.push_back(characters.ProjectPlaintext(RampInput().coefficients(), j));
+  }
+  std::vector<int64_t> expected(n);
+  for (int r = 0; r < n; ++r) {
+    double sum = 0.0;
+    for (int j = 0; j < k; ++j) {
+      sum += weights.weights[r][j] *
+             static_cast<double>(LiftCentered(y[j][(r * k) % n], p));
+    }
+    expected[r] = static_cast<int64_t>(std::round(sum));
+  }
+  EXPECT_EQ(op.Apply(RampInput()), Polynomial(expected));
+}
+
+TEST(RoutingOperatorTest, MismatchedCharactersLeaveInputUnchanged) {
+  RoutingWeights weights;
+  weights.weights.assign(4, std::vector<double>(3, 1.0));
+
+  EXPECT_EQ(RoutingOperator::Compile(weights).Apply(RampInput()), RampInput());
+}
+
+TEST(RoutingOperatorTest, ViewBorrowsTable) {
+  RoutingWeights weights = RampWeights(RingParams::kDegree);
+  RoutingOperator owned = RoutingOperator::Compile(weights);
+  RoutingOperator view = RoutingOperator::View(
+      owned.table(), owned.num_positions(), owned.num_characters(), nullptr);
+
+  EXPECT_EQ(view.table(), owned.table());
+  EXPECT_EQ(view.Apply(RampInput()), owned.Apply(RampInput()));
+  EXPECT_EQ(view.ToWeights().weights, weights.weights);
+}
+
+TEST(RoutingOperatorTest, ApplyBatchMatchesApply) {
+  std::vector<Polynomial> inputs;
+  for (int64_t i = 0; i < 5; ++i) {
+    std::vector<int64_t> coefficients(RingParams::kDegree);
+    for (int j = 0; j < RingParams::kDegree; ++j) {
+      coefficients[j] = (i * 977 + j * 131) % RingParams::kModulus;
+    }
+    inputs.emplace_back(coefficients);
+  }
+  PolynomialBatch batch = PolynomialBatch::FromPolynomials(inputs);
+
+  for (WeightBasis basis :
+       {WeightBasis::kRoundedProjections, WeightBasis::kFpCharacters}) {
+    for (int num_positions : {4, RingParams::kDegree}) {
+      RoutingOperator op =
+          RoutingOperator::Compile(RampWeights(num_positions), basis);
+      PolynomialBatch output;
+      op.ApplyBatch(batch, &output);
+
+      ASSERT_EQ(output.size(), inputs.size());
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        EXPECT_EQ(output.Get(i), op.Apply(inputs[i]))
+            << num_positions << " positions, row " << i << ", basis "
+            << static_cast<int>(basis);
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace f2chat
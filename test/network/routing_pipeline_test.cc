@@ -0,0 +1,148 @@
+// test/network/routing_pipeline_test.cc
+#include "lib/network/routing_pipeline.h"
+#include "lib/network/sheaf_router.h"
+#include "lib/network/gluing.h"
+#include "lib/network/patch.h"
+#include "absl/strings/str_cat.h"
+#include <gtest/gtest.h>
+
+namespace f2chat {
+namespace {
+
+std::shared_ptr<Patch> MakePatch(const std::string& id) {
+  RoutingWeights weights;
+  weights.weights.resize(
+      4, std::vector<double>(RingParams::kNumCharacters,
+                             1.0 / RingParams::kNumCharacters));
+  return std::make_shared<Patch>(Patch::Create(id, weights));
+}
+
+// Chain of patches p0 - p1 - ... with a few shared examples.
+SheafRouter MakeLearnedRouter(int num_patches) {
+  RoutingProblem problem;
+  for (int i = 0; i < num_patches; ++i) {
+    problem.patches.push_back(MakePatch(absl::StrCat("p", i)));
+  }
+  for (int64_t seed = 1; seed <= 3; ++seed) {
+    problem.examples.push_back(RoutingExample{
+        Polynomial({seed, seed + 1}), Polynomial({3 * seed, 7}),
+        Polynomial({seed + 2, 2 * seed, 11, seed}),
+        Polynomial({seed + 10, seed + 11})});
+  }
+  auto router = SheafRouter::Create(problem).value();
+  EXPECT_TRUE(router.LearnRouting().ok());
+  return router;
+}
+
+std::vector<RouteRequest> MakeRequests(int count) {
+  std::vector<RouteRequest> requests;
+  for (int64_t i = 0; i < count; ++i) {
+    requests.push_back({Polynomial({i, i + 1, 2 * i}), Polynomial({i % 7}),
+                        Polynomial({i % 5, 1})});
+  }
+  return requests;
+}
+
+TEST(RoutingPipelineTest, MatchesRouteInOrder) {
+  SheafRouter router = MakeLearnedRouter(5);
+  auto requests = MakeRequests(103);  // Not a multiple of the batch size
+
+  for (int stages : {1, 2, 5, 7}) {
+    PipelineOptions options;
+    options.num_stages = stages;
+    options.batch_size = 8;
+    options.ring_capacity = 2;
+    auto pipeline = RoutingPipeline::Create(router, options).value();
+    EXPECT_EQ(pipeline->num_stages(), stages);
+
+    auto routed = pipeline->RouteStream(requests);
+    ASSERT_TRUE(routed.ok()) << routed.status();
+    ASSERT_EQ(routed->size(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      EXPECT_EQ((*routed)[i],
+                router.Route(requests[i].message, requests[i].source_id,
+                             requests[i].dest_id).value())
+          << stages << " stages, message " << i;
+    }
+  }
+}
+
+TEST(RoutingPipelineTest, FollowsPerMessagePlans) {
+  // Chain p0 - p1 - p2 - p3, with p3 not glued: endpoints on p0..p2 get
+  // plans (forwards, backwards, single patch), p3 traverses everything.
+  RoutingProblem problem;
+  std::vector<Polynomial> endpoints;
+  for (int i = 0; i < 4; ++i) {
+    const std::string id = absl::StrCat("p", i);
+    problem.patches.push_back(MakePatch(id));
+    endpoints.push_back(Polynomial({100 + i, i}));
+    problem.endpoints.push_back({endpoints.back(), id});
+  }
+  for (int i = 0; i + 1 < 3; ++i) {
+    problem.gluings.push_back(GluingConstraintBuilder::CreateContinuity(
+        absl::StrCat("p", i), absl::StrCat("p", i + 1),
+        Polynomial({i + 1, 5, 3})));
+  }
+  for (int64_t seed = 1; seed <= 3; ++seed) {
+    problem.examples.push_back(RoutingExample{
+        Polynomial({seed}), Polynomial({3 * seed, 7}),
+        Polynomial({seed + 2, 2 * seed, 11}), Polynomial({seed + 10})});
+  }
+  auto router = SheafRouter::Create(problem).value();
+  ASSERT_TRUE(router.LearnRouting().ok());
+  ASSERT_EQ(router.RoutePlan(endpoints[2], endpoints[0]).value(),
+            (std::vector<size_t>{2, 1, 0}));
+
+  std::vector<RouteRequest> requests;
+  for (int64_t i = 0; i < 48; ++i) {
+    requests.push_back({Polynomial({i, 2 * i + 1}), endpoints[i % 4],
+                        endpoints[(i / 4) % 4]});
+  }
+  for (int stages : {1, 2, 4}) {
+    PipelineOptions options;
+    options.num_stages = stages;
+    options.batch_size = 5;
+    auto pipeline = RoutingPipeline::Create(router, options).value();
+    auto routed = pipeline->RouteStream(requests);
+    ASSERT_TRUE(routed.ok()) << routed.status();
+    for (size_t i = 0; i < requests.size(); ++i) {
+      EXPECT_EQ((*routed)[i],
+                router.Route(requests[i].message, requests[i].source_id,
+                             requests[i].dest_id).value())
+          << stages << " stages, message " << i;
+    }
+  }
+}
+
+TEST(RoutingPipelineTest, DefaultStagesFollowPatchCount) {
+  SheafRouter router = MakeLearnedRouter(2);
+  auto pipeline = RoutingPipeline::Create(router).value();
+  EXPECT_GE(pipeline->num_stages(), 1);
+  EXPECT_LE(pipeline->num_stages(), 2);
+
+  // Reusable across streams, including an empty one.
+  EXPECT_TRUE(pipeline->RouteStream({}).value().empty());
+  EXPECT_EQ(pipeline->RouteStream(MakeRequests(3)).value().size(), 3u);
+}
+
+TEST(RoutingPipelineTest, RequiresLearnedWeights) {
+  RoutingProblem problem;
+  problem.patches = {MakePatch("solo")};
+  auto router = SheafRouter::Create(problem).value();
+
+  EXPECT_EQ(RoutingPipeline::Create(router).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  PipelineOptions options;
+  options.num_stages = 1;
+  auto pipeline = RoutingPipeline::Create(router, options).value();
+  EXPECT_EQ(pipeline->RouteStream(MakeRequests(1)).status().code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  options.batch_size = 0;
+  EXPECT_EQ(RoutingPipeline::Create(router, options).status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace f2chat
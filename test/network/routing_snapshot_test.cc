@@ -0,0 +1,146 @@
+// test/network/routing_snapshot_test.cc
+#include "lib/network/routing_snapshot.h"
+#include "lib/network/sheaf_router.h"
+#include "lib/network/gluing.h"
+#include "lib/network/patch.h"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace f2chat {
+namespace {
+
+RoutingProblem MakeProblem() {
+  RoutingWeights weights;
+  weights.weights.assign(
+      4, std::vector<double>(RingParams::kNumCharacters,
+                             1.0 / RingParams::kNumCharacters));
+
+  RoutingProblem problem;
+  problem.patches = {
+      std::make_shared<Patch>(Patch::Create("us-east", weights)),
+      std::make_shared<Patch>(Patch::Create("eu-west", weights))};
+  for (int64_t seed = 1; seed <= 3; ++seed) {
+    problem.examples.push_back(RoutingExample{
+        Polynomial({seed}), Polynomial({3 * seed, 7}),
+        Polynomial({seed + 2, 2 * seed, 11}), Polynomial({seed + 10})});
+  }
+  return problem;
+}
+
+std::string SnapshotPath(const std::string& name) {
+  const char* dir = std::getenv("TEST_TMPDIR");
+  return std::string(dir != nullptr ? dir : "/tmp") + "/" + name;
+}
+
+TEST(RoutingSnapshotTest, RestoredRouterRoutesWithoutLearning) {
+  const std::string path = SnapshotPath("restore.f2snap");
+  auto trained = SheafRouter::Create(MakeProblem()).value();
+  auto result = trained.LearnRouting().value();
+  ASSERT_TRUE(trained.SaveSnapshot(path).ok());
+
+  auto restored = SheafRouter::Create(MakeProblem()).value();
+  EXPECT_EQ(restored.Route(Polynomial({5}), Polynomial({1}), Polynomial({2}))
+                .status().code(),
+            absl::StatusCode::kFailedPrecondition);
+  ASSERT_TRUE(restored.LoadSnapshot(path).ok());
+
+  Polynomial message({42, 7, 1});
+  auto expected = trained.Route(message, Polynomial({1}), Polynomial({2}));
+  auto actual = restored.Route(message, Polynomial({1}), Polynomial({2}));
+  ASSERT_EQ(expected.ok(), actual.ok());
+  if (expected.ok()) {
+    EXPECT_EQ(actual.value(), expected.value());
+  }
+
+  auto snapshot = RoutingSnapshot::Open(path).value();
+  EXPECT_EQ(snapshot.metadata().fingerprint, trained.fingerprint());
+  EXPECT_DOUBLE_EQ(snapshot.metadata().obstruction, result.obstruction);
+  ASSERT_EQ(snapshot.operators().size(), 2);
+  EXPECT_EQ(snapshot.operators()[1].ToWeights().weights,
+            result.patch_weights[1].weights);
+  std::remove(path.c_str());
+}
+
+TEST(RoutingSnapshotTest, KeepsWeightBasis) {
+  const std::string path = SnapshotPath("fp.f2snap");
+  SolverOptions options;
+  options.weight_basis = WeightBasis::kFpCharacters;
+  auto trained = SheafRouter::Create(MakeProblem(), options).value();
+  ASSERT_TRUE(trained.LearnRouting().ok());
+  ASSERT_TRUE(trained.SaveSnapshot(path).ok());
+
+  auto snapshot = RoutingSnapshot::Open(path).value();
+  EXPECT_EQ(snapshot.metadata().weight_basis, WeightBasis::kFpCharacters);
+  for (const RoutingOperator& op : snapshot.operators()) {
+    EXPECT_EQ(op.basis(), WeightBasis::kFpCharacters);
+  }
+
+  // The basis is part of the problem: rounded-projection routers refuse it.
+  EXPECT_EQ(SheafRouter::Create(MakeProblem()).value().LoadSnapshot(path)
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+
+  auto restored = SheafRouter::Create(MakeProblem(), options).value();
+  ASSERT_TRUE(restored.LoadSnapshot(path).ok());
+  Polynomial message({42, 7, 1});
+  auto expected = trained.Route(message, Polynomial({1}), Polynomial({2}));
+  auto actual = restored.Route(message, Polynomial({1}), Polynomial({2}));
+  ASSERT_EQ(expected.ok(), actual.ok());
+  if (expected.ok()) {
+    EXPECT_EQ(actual.value(), expected.value());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(RoutingSnapshotTest, RejectsSnapshotOfDifferentProblem) {
+  const std::string path = SnapshotPath("other.f2snap");
+  auto trained = SheafRouter::Create(MakeProblem()).value();
+  ASSERT_TRUE(trained.LearnRouting().ok());
+  ASSERT_TRUE(trained.SaveSnapshot(path).ok());
+
+  RoutingProblem other = MakeProblem();
+  other.examples.pop_back();
+  auto router = SheafRouter::Create(other).value();
+
+  EXPECT_NE(router.fingerprint(), trained.fingerprint());
+  EXPECT_EQ(router.LoadSnapshot(path).code(),
+            absl::StatusCode::kFailedPrecondition);
+  std::remove(path.c_str());
+}
+
+TEST(RoutingSnapshotTest, DetectsCorruption) {
+  const std::string path = SnapshotPath("corrupt.f2snap");
+  auto trained = SheafRouter::Create(MakeProblem()).value();
+  ASSERT_TRUE(trained.LearnRouting().ok());
+  ASSERT_TRUE(trained.SaveSnapshot(path).ok());
+
+  // Flip one byte of the last weight table.
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(-3, std::ios::end);
+    char byte = 0;
+    file.read(&byte, 1);
+    byte ^= 0x40;
+    file.seekp(-3, std::ios::end);
+    file.write(&byte, 1);
+  }
+
+  EXPECT_EQ(RoutingSnapshot::Open(path).status().code(),
+            absl::StatusCode::kDataLoss);
+  EXPECT_EQ(RoutingSnapshot::Open(SnapshotPath("missing.f2snap"))
+                .status().code(),
+            absl::StatusCode::kNotFound);
+  std::remove(path.c_str());
+}
+
+TEST(RoutingSnapshotTest, SaveRequiresLearnedWeights) {
+  auto router = SheafRouter::Create(MakeProblem()).value();
+  EXPECT_EQ(router.SaveSnapshot(SnapshotPath("never.f2snap")).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+}  // namespace
+}  // namespace f2chat
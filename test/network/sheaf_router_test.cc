@@ -0,0 +1,509 @@
+// test/network/sheaf_router_test.cc
+#include "lib/network/sheaf_router.h"
+#include "lib/network/sheaf_system.h"
+#include "lib/network/gluing.h"
+#include "lib/network/patch.h"
+#include "lib/network/routing_operator.h"
+#include "lib/runtime/cancellation.h"
+#include "lib/runtime/executor.h"
+#include "lib/runtime/progress.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+namespace f2chat {
+namespace {
+
+ExecutorOptions Workers(int num_workers) {
+  ExecutorOptions options;
+  options.num_workers = num_workers;
+  return options;
+}
+
+RoutingWeights UniformWeights(int num_positions) {
+  RoutingWeights weights;
+  weights.weights.resize(
+      num_positions,
+      std::vector<double>(RingParams::kNumCharacters,
+                          1.0 / RingParams::kNumCharacters));
+  return weights;
+}
+
+std::shared_ptr<Patch> MakePatch(const std::string& id) {
+  return std::make_shared<Patch>(Patch::Create(id, UniformWeights(4)));
+}
+
+RoutingExample MakeExample(int64_t seed) {
+  Polynomial source({seed, seed + 1});
+  Polynomial dest({3 * seed, 7, seed % 5});
+  Polynomial message({seed + 2, 2 * seed, 11, seed});
+  Polynomial expected({seed + 10, seed + 11});
+  return RoutingExample{source, dest, message, expected};
+}
+
+// Example with pseudo-random message and target (full-rank design rows).
+RoutingExample MakeRandomExample(uint64_t seed) {
+  uint64_t state = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  auto next = [&state]() {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<int64_t>((state >> 33) % 100);
+  };
+  std::vector<int64_t> message(RingParams::kDegree), expected(4);
+  for (auto& c : message) c = next();
+  for (auto& c : expected) c = next();
+  return RoutingExample{Polynomial({1}), Polynomial({0}),
+                        Polynomial(message), Polynomial(expected)};
+}
+
+RoutingProblem MakeProblem() {
+  RoutingProblem problem;
+  problem.patches = {MakePatch("us-east"), MakePatch("eu-west"),
+                     MakePatch("ap-south")};
+  for (int64_t seed = 1; seed <= 3; ++seed) {
+    problem.examples.push_back(MakeExample(seed));
+  }
+  problem.local_examples["eu-west"] = {MakeExample(9)};
+  problem.gluings.push_back(GluingConstraintBuilder::CreateContinuity(
+      "us-east", "eu-west", Polynomial({5, 1, 4, 1, 5, 9, 2, 6})));
+  return problem;
+}
+
+void ExpectSameWeights(const RoutingResult& a, const RoutingResult& b) {
+  ASSERT_EQ(a.patch_weights.size(), b.patch_weights.size());
+  for (size_t i = 0; i < a.patch_weights.size(); ++i) {
+    const auto& wa = a.patch_weights[i].weights;
+    const auto& wb = b.patch_weights[i].weights;
+    ASSERT_EQ(wa.size(), wb.size());
+    for (size_t p = 0; p < wa.size(); ++p) {
+      for (size_t j = 0; j < wa[p].size(); ++j) {
+        EXPECT_NEAR(wa[p][j], wb[p][j], 1e-6) << "patch " << i;
+      }
+    }
+  }
+}
+
+TEST(SheafRouterTest, CreateRejectsUnknownGluingPatch) {
+  RoutingProblem problem = MakeProblem();
+  problem.gluings.push_back(GluingConstraintBuilder::CreateContinuity(
+      "us-east", "mars", Polynomial({1})));
+
+  auto router_or = SheafRouter::Create(problem);
+
+  EXPECT_FALSE(router_or.ok());
+  EXPECT_EQ(router_or.status().code(), absl::StatusCode::kInvalidArgument);
+}
+
+TEST(SheafRouterTest, LearnRoutingFitsEveryPositionOfWindow) {
+  // Positions that are multiples of n/k read the first projection window,
+  // which is where the example input lives.
+  const int stride = RingParams::kDegree / RingParams::kNumCharacters;
+  std::vector<int64_t> expected(RingParams::kDegree, 0);
+  for (int p = 0; p < RingParams::kDegree; p += stride) {
+    expected[p] = 100 + p;
+  }
+
+  RoutingExample example = MakeExample(4);
+  example.expected_output = Polynomial(expected);
+
+  RoutingProblem problem;
+  problem.patches = {MakePatch("solo")};
+  problem.examples.push_back(example);
+
+  auto router = SheafRouter::Create(problem).value();
+  auto result = router.LearnRouting().value();
+
+  // One example, k unknowns per position: exactly learnable.
+  EXPECT_TRUE(result.success) << result.obstruction;
+  EXPECT_LT(result.obstruction, 1e-6);
+  EXPECT_EQ(result.patch_weights[0].num_positions(), RingParams::kDegree);
+}
+
+TEST(SheafRouterTest, UpdatePatchMatchesFullSolve) {
+  auto router = SheafRouter::Create(MakeProblem()).value();
+  ASSERT_TRUE(router.LearnRouting().ok());
+
+  // Edit one patch's local data incrementally.
+  auto updated = router.UpdatePatch(MakePatch("ap-south"), {MakeExample(6)});
+  ASSERT_TRUE(updated.ok()) << updated.status();
+
+  // Same final problem, solved from scratch.
+  RoutingProblem fresh = MakeProblem();
+  fresh.local_examples["ap-south"] = {MakeExample(6)};
+  auto reference = SheafRouter::Create(fresh).value().LearnRouting().value();
+
+  ExpectSameWeights(updated.value(), reference);
+  EXPECT_NEAR(updated->obstruction, reference.obstruction,
+              1e-6 * (1.0 + reference.obstruction));
+}
+
+TEST(SheafRouterTest, AddGluingMatchesFullSolve) {
+  auto router = SheafRouter::Create(MakeProblem()).value();
+  ASSERT_TRUE(router.LearnRouting().ok());
+
+  auto gluing = GluingConstraintBuilder::CreateContinuity(
+      "eu-west", "ap-south", Polynomial({2, 7, 1, 8, 2, 8, 1, 8}));
+  auto updated = router.AddGluing(gluing);
+  ASSERT_TRUE(updated.ok()) << updated.status();
+
+  RoutingProblem fresh = MakeProblem();
+  fresh.gluings.push_back(gluing);
+  auto reference = SheafRouter::Create(fresh).value().LearnRouting().value();
+
+  ExpectSameWeights(updated.value(), reference);
+}
+
+TEST(SheafRouterTest, MixedPrecisionMatchesDoubleSolve) {
+  SolverOptions options;
+  options.precision = SolverOptions::Precision::kMixed;
+  auto mixed = SheafRouter::Create(MakeProblem(), options).value()
+      .LearnRouting().value();
+  auto reference = SheafRouter::Create(MakeProblem()).value()
+      .LearnRouting().value();
+
+  EXPECT_NE(mixed.solve_path, SolvePath::kDouble);
+  EXPECT_EQ(reference.solve_path, SolvePath::kDouble);
+  ExpectSameWeights(mixed, reference);
+  EXPECT_NEAR(mixed.obstruction, reference.obstruction,
+              1e-6 * (1.0 + reference.obstruction));
+}
+
+TEST(SheafRouterTest, SketchedSolvesReportTrueObstruction) {
+  // Many more examples than unknowns per block (k features).
+  RoutingProblem problem = MakeProblem();
+  problem.examples.clear();
+  for (uint64_t seed = 0; seed < 400; ++seed) {
+    problem.examples.push_back(MakeRandomExample(seed));
+  }
+  auto exact = SheafRouter::Create(problem).value().LearnRouting().value();
+
+  SolverOptions options;
+  options.sketch = SolverOptions::Sketch::kPrecondition;
+  auto preconditioned = SheafRouter::Create(problem, options).value()
+      .LearnRouting().value();
+  ExpectSameWeights(preconditioned, exact);
+  EXPECT_NEAR(preconditioned.obstruction, exact.obstruction,
+              1e-6 * exact.obstruction);
+
+  // Sketch-and-solve is approximate; its true residual cannot beat the
+  // least-squares optimum.
+  options.sketch = SolverOptions::Sketch::kSolve;
+  auto sketched = SheafRouter::Create(problem, options).value()
+      .LearnRouting().value();
+  EXPECT_GE(sketched.obstruction, exact.obstruction * (1.0 - 1e-9));
+  EXPECT_LT(sketched.obstruction, 4.0 * exact.obstruction);
+}
+
+TEST(SheafRouterTest, PreconditionedBlocksAreNotPrecisionFallbacks) {
+  // Every block is sketch-preconditioned, so none uses (or abandons) a
+  // float factorization.
+  RoutingProblem problem = MakeProblem();
+  problem.examples.clear();
+  for (uint64_t seed = 0; seed < 400; ++seed) {
+    problem.examples.push_back(MakeRandomExample(seed));
+  }
+  SolverOptions options;
+  options.precision = SolverOptions::Precision::kMixed;
+  options.sketch = SolverOptions::Sketch::kPrecondition;
+  auto result = SheafRouter::Create(problem, options).value()
+      .LearnRouting().value();
+  EXPECT_EQ(result.solve_path, SolvePath::kMixed);
+}
+
+TEST(SheafRouterTest, RoutesDuringRetrainingWithoutBlocking) {
+  RoutingProblem problem = MakeProblem();
+  problem.gluings.clear();
+  auto router = SheafRouter::Create(problem).value();
+  ASSERT_TRUE(router.LearnRouting().ok());
+  const uint64_t first_version = router.routing_version();
+  EXPECT_GT(first_version, 0);
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> failures{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&router, &stop, &failures, t]() {
+      uint64_t last_version = 0;
+      while (!stop.load()) {
+        uint64_t version = router.routing_version();
+        auto routed = router.Route(Polynomial({t, 1, 2}), Polynomial({1}),
+                                   Polynomial({2}));
+        if (!routed.ok() || version < last_version) ++failures;
+        last_version = version;
+      }
+    });
+  }
+
+  // Retrain repeatedly while traffic flows.
+  for (int64_t round = 0; round < 10; ++round) {
+    ASSERT_TRUE(
+        router.UpdatePatch(MakePatch("ap-south"), {MakeExample(round)}).ok());
+  }
+  stop = true;
+  for (auto& reader : readers) reader.join();
+
+  EXPECT_EQ(failures.load(), 0);
+  EXPECT_EQ(router.routing_version(), first_version + 10);
+}
+
+TEST(SheafRouterTest, GluingsVerifiedOnceAndAuditedBySampling) {
+  // Identical patches without data keep identical weights: every gluing
+  // agrees.
+  RoutingProblem problem;
+  problem.patches = {MakePatch("us-east"), MakePatch("eu-west")};
+  problem.gluings.push_back(GluingConstraintBuilder::CreateContinuity(
+      "us-east", "eu-west", Polynomial({5, 1, 4, 1, 5, 9, 2, 6})));
+
+  RouterOptions router_options;
+  router_options.audit_rate = 0.25;
+  auto router = SheafRouter::Create(problem, {}, router_options).value();
+  auto result = router.LearnRouting().value();
+  EXPECT_TRUE(result.violated_gluings.empty());
+
+  for (int i = 0; i < 8; ++i) {
+    auto routed = router.Route(Polynomial({i, 3}), Polynomial({1}),
+                               Polynomial({2}));
+    EXPECT_TRUE(routed.ok()) << routed.status();
+  }
+  EXPECT_EQ(router.audits_run(), 2);
+  EXPECT_EQ(router.audit_failures(), 0);
+}
+
+TEST(SheafRouterTest, ViolatedGluingBlocksRouting) {
+  // Conflicting local data: the soft gluing rows cannot make both patches
+  // route the boundary identically.
+  RoutingProblem problem;
+  problem.patches = {MakePatch("us-east"), MakePatch("eu-west")};
+  for (uint64_t seed = 0; seed < 6; ++seed) {
+    RoutingExample example = MakeRandomExample(seed);
+    problem.local_examples["us-east"].push_back(example);
+    example.expected_output = example.expected_output.MultiplyScalar(5);
+    problem.local_examples["eu-west"].push_back(example);
+  }
+  Polynomial boundary({90, 80, 70, 60, 50, 40, 30, 20});
+  problem.gluings.push_back(GluingConstraintBuilder::CreateContinuity(
+      "us-east", "eu-west", boundary));
+
+  auto router = SheafRouter::Create(problem).value();
+  auto result = router.LearnRouting().value();
+
+  ASSERT_EQ(result.violated_gluings, std::vector<size_t>{0});
+  auto routed = router.Route(Polynomial({1}), Polynomial({1}), Polynomial({2}));
+  EXPECT_EQ(routed.status().code(), absl::StatusCode::kInternal);
+}
+
+TEST(SheafRouterTest, CreateRejectsInvalidAuditRate) {
+  RouterOptions router_options;
+  router_options.audit_rate = 1.5;
+  EXPECT_EQ(SheafRouter::Create(MakeProblem(), {}, router_options)
+                .status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(SheafRouterTest, RoutesOnlyThroughPlannedPatches) {
+  const Polynomial alice({1, 2}), bob({3, 4}), carol({5, 6});
+  RoutingProblem problem = MakeProblem();
+  problem.endpoints = {{alice, "us-east"}, {bob, "eu-west"}};
+
+  auto router = SheafRouter::Create(problem).value();
+  ASSERT_TRUE(router.AssignEndpoint(carol, "ap-south").ok());
+  EXPECT_EQ(router.AssignEndpoint(carol, "mars").code(),
+            absl::StatusCode::kInvalidArgument);
+  auto result = router.LearnRouting().value();
+  ASSERT_TRUE(result.violated_gluings.empty());
+
+  // us-east and eu-west are glued: only those two patches apply.
+  EXPECT_EQ(router.RoutePlan(alice, bob).value(),
+            (std::vector<size_t>{0, 1}));
+  Polynomial message({7, 8, 9});
+  Polynomial expected = RoutingOperator::Compile(result.patch_weights[1]).Apply(
+      RoutingOperator::Compile(result.patch_weights[0]).Apply(
+          RoutingPolynomial::EncodeRoute(alice, bob, message)));
+  EXPECT_EQ(router.Route(message, alice, bob).value(), expected);
+
+  // ap-south is not glued to anything yet: full traversal.
+  EXPECT_EQ(router.RoutePlan(bob, carol).value(),
+            (std::vector<size_t>{0, 1, 2}));
+
+  ASSERT_TRUE(router.AddGluing(GluingConstraintBuilder::CreateContinuity(
+      "eu-west", "ap-south", Polynomial({2, 7, 1, 8}))).ok());
+  EXPECT_EQ(router.RoutePlan(bob, carol).value(),
+            (std::vector<size_t>{1, 2}));
+  EXPECT_EQ(router.RoutePlan(carol, alice).value(),
+            (std::vector<size_t>{2, 1, 0}));
+
+  // Moving an endpoint replaces its patch.
+  ASSERT_TRUE(router.AssignEndpoint(carol, "us-east").ok());
+  EXPECT_EQ(router.RoutePlan(carol, bob).value(),
+            (std::vector<size_t>{0, 1}));
+}
+
+TEST(SheafRouterTest, RouteBatchMatchesRoute) {
+  const Polynomial alice({1, 2}), bob({3, 4});
+  RoutingProblem problem = MakeProblem();
+  problem.endpoints = {{alice, "us-east"}, {bob, "eu-west"}};
+
+  // Planned (alice ↔ bob) and unplanned (unmapped) routes interleaved.
+  std::vector<Polynomial> messages, sources, dests;
+  for (int64_t i = 0; i < 150; ++i) {
+    messages.push_back(Polynomial({i, 3 * i + 1, 17, i % 9}));
+    sources.push_back(i % 3 == 0 ? alice : Polynomial({i % 4}));
+    dests.push_back(i % 3 == 0 ? bob : Polynomial({5, i % 6}));
+  }
+
+  Executor executor(Workers(4));
+
+  // Modeled dual-socket pool: tables carry one operator copy per node.
+  NumaTopology two_nodes = NumaTopology::FromNodes({{0, 1}, {2, 3}});
+  ExecutorOptions numa_options;
+  numa_options.cores = {0, 1, 2, 3};
+  numa_options.pin_workers = true;
+  numa_options.topology = &two_nodes;
+  Executor numa_executor(numa_options);
+
+  for (Executor* pool :
+       {static_cast<Executor*>(nullptr), &executor, &numa_executor}) {
+    RouterOptions router_options;
+    router_options.executor = pool;
+    router_options.batch_shard_size = 16;
+    auto router = SheafRouter::Create(problem, {}, router_options).value();
+    ASSERT_TRUE(router.LearnRouting().ok());
+    if (pool == &numa_executor) {
+      const auto& replicas = router.routing_table()->node_operators;
+      EXPECT_EQ(replicas.num_replicas(), 2);
+      // Each node owns its weight tables.
+      for (size_t i = 0; i < replicas.ForNode(0).size(); ++i) {
+        EXPECT_NE(replicas.ForNode(0)[i].table(),
+                  replicas.ForNode(1)[i].table());
+      }
+    }
+
+    auto routed = router.RouteBatch(messages, sources, dests);
+    ASSERT_TRUE(routed.ok()) << routed.status();
+    ASSERT_EQ(routed->size(), messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+      EXPECT_EQ((*routed)[i],
+                router.Route(messages[i], sources[i], dests[i]).value())
+          << "message " << i;
+    }
+  }
+}
+
+TEST(SheafRouterTest, RouteBatchRejectsMismatchedSpans) {
+  auto router = SheafRouter::Create(MakeProblem()).value();
+  ASSERT_TRUE(router.LearnRouting().ok());
+  std::vector<Polynomial> two(2), one(1);
+
+  EXPECT_EQ(router.RouteBatch(two, two, one).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_TRUE(router.RouteBatch({}, {}, {}).value().empty());
+}
+
+TEST(SheafRouterTest, LearnRoutingHonorsCancellationAndReportsProgress) {
+  auto router = SheafRouter::Create(MakeProblem()).value();
+  CancellationToken cancelled = CancellationToken::Create();
+  cancelled.Cancel();
+  EXPECT_EQ(router.LearnRouting(cancelled).status().code(),
+            absl::StatusCode::kCancelled);
+  EXPECT_EQ(router.routing_table(), nullptr);
+
+  std::vector<Progress> reports;
+  auto learned = router.LearnRouting(
+      CancellationToken::WithTimeout(absl::Hours(1)),
+      [&reports](const Progress& progress) { reports.push_back(progress); });
+  ASSERT_TRUE(learned.ok()) << learned.status();
+  ASSERT_FALSE(reports.empty());
+  for (size_t i = 1; i < reports.size(); ++i) {
+    EXPECT_EQ(reports[i].completed, reports[i - 1].completed + 1);
+  }
+  EXPECT_EQ(reports.back().completed, reports.back().total);
+  EXPECT_EQ(reports.back().operation, "Solve");
+}
+
+TEST(SheafRouterTest, RouteBatchShedsOverdueWork) {
+  auto router = SheafRouter::Create(MakeProblem()).value();
+  ASSERT_TRUE(router.LearnRouting().ok());
+  std::vector<Polynomial> messages(100, Polynomial({1, 2})),
+      sources(100, Polynomial({3})), dests(100, Polynomial({4}));
+
+  CancellationToken overdue =
+      CancellationToken::Create(absl::Now() - absl::Seconds(1));
+  EXPECT_EQ(router.RouteBatch(messages, sources, dests, overdue)
+                .status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+
+  int64_t routed = 0;
+  ASSERT_TRUE(router.RouteBatch(messages, sources, dests, {},
+                                [&routed](const Progress& progress) {
+                                  EXPECT_EQ(progress.total, 100);
+                                  routed = progress.completed;
+                                }).ok());
+  EXPECT_EQ(routed, 100);
+}
+
+TEST(SheafSystemTest, CancelledSolveKeepsFinishedBlocks) {
+  SheafSystem system;
+  system.SetSharedExamples({MakeExample(1), MakeExample(2)});
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(system.SetPatch(i, *MakePatch("p"), {}).ok());
+  }
+  const int64_t classes = static_cast<int64_t>(system.num_classes());
+
+  // Cancel after the first finished unit of work.
+  CancellationToken token = CancellationToken::Create();
+  EXPECT_EQ(system.Solve(token, [&token](const Progress&) { token.Cancel(); })
+                .status().code(),
+            absl::StatusCode::kCancelled);
+  EXPECT_GE(system.factorizations(), 1);
+  EXPECT_LT(system.factorizations(), 4 * classes);
+
+  // The retry factors only the blocks the cancelled solve did not reach.
+  ASSERT_TRUE(system.Solve().ok());
+  EXPECT_EQ(system.factorizations(), 4 * classes);
+}
+
+TEST(SheafSystemTest, SolveIsIndependentOfWorkerCount) {
+  Executor serial(Workers(1));
+  Executor parallel(Workers(4));
+  std::vector<SheafSolution> solutions;
+  for (Executor* executor : {&serial, &parallel}) {
+    SolverOptions options;
+    options.executor = executor;
+    SheafSystem system(options);
+    system.SetSharedExamples({MakeExample(1), MakeExample(2)});
+    for (size_t i = 0; i < 3; ++i) {
+      ASSERT_TRUE(system.SetPatch(i, *MakePatch("p"), {MakeExample(i + 5)})
+                      .ok());
+    }
+    ASSERT_TRUE(system.AddGluing(0, 1, Polynomial({1, 2, 3})).ok());
+    solutions.push_back(system.Solve().value());
+  }
+
+  EXPECT_EQ(solutions[0].obstruction, solutions[1].obstruction);
+  for (size_t m = 0; m < 3; ++m) {
+    EXPECT_EQ(solutions[0].patch_weights[m], solutions[1].patch_weights[m]);
+  }
+}
+
+TEST(SheafSystemTest, UpdateRefactorsOnlyTouchedBlock) {
+  SheafSystem system;
+  system.SetSharedExamples({MakeExample(1), MakeExample(2)});
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(system.SetPatch(i, *MakePatch("p"), {}).ok());
+  }
+  ASSERT_TRUE(system.AddGluing(0, 1, Polynomial({1, 2, 3})).ok());
+  ASSERT_TRUE(system.Solve().ok());
+  const int64_t classes = static_cast<int64_t>(system.num_classes());
+  EXPECT_EQ(system.factorizations(), 4 * classes);
+
+  ASSERT_TRUE(system.SetPatch(2, *MakePatch("p"), {MakeExample(3)}).ok());
+  ASSERT_TRUE(system.Solve().ok());
+  EXPECT_EQ(system.factorizations(), 5 * classes);
+
+  ASSERT_TRUE(system.AddGluing(2, 3, Polynomial({4, 5, 6})).ok());
+  ASSERT_TRUE(system.Solve().ok());
+  EXPECT_EQ(system.factorizations(), 5 * classes);
+}
+
+}  // namespace
+}  // namespace f2chat
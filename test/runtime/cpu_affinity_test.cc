@@ -0,0 +1,31 @@
+// test/runtime/cpu_affinity_test.cc
+#include "lib/runtime/cpu_affinity.h"
+#include <gtest/gtest.h>
+
+namespace f2chat {
+namespace {
+
+TEST(CpuAffinityTest, ParsesCoreLists) {
+  EXPECT_EQ(ParseCoreList("0-3,8,10-11").value(),
+            (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseCoreList(" 2 , 1,2 ").value(), (std::vector<int>{2, 1}));
+  EXPECT_TRUE(ParseCoreList("").value().empty());
+}
+
+TEST(CpuAffinityTest, RejectsMalformedCoreLists) {
+  for (const char* spec : {"3-1", "a", "1-2-3", "-1", "0,x-2"}) {
+    EXPECT_EQ(ParseCoreList(spec).status().code(),
+              absl::StatusCode::kInvalidArgument) << spec;
+  }
+}
+
+TEST(CpuAffinityTest, PinsToAvailableCore) {
+  EXPECT_GE(NumCores(), 1);
+  std::thread thread([] {});
+  PinThreadToCore(thread, 0);  // Best effort; must not crash
+  EXPECT_FALSE(PinThreadToCore(thread, -1));
+  thread.join();
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,111 @@
+// test/runtime/executor_test.cc
+#include "lib/runtime/executor.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+namespace f2chat {
+namespace {
+
+ExecutorOptions Workers(int num_workers) {
+  ExecutorOptions options;
+  options.num_workers = num_workers;
+  return options;
+}
+
+TEST(ExecutorTest, DefaultIsConfiguredBeforeFirstUse) {
+  ASSERT_TRUE(Executor::ConfigureDefault(
+      Workers(2)).ok());
+  Executor& shared = Executor::Default();
+
+  EXPECT_EQ(shared.num_workers(), 2);
+  EXPECT_EQ(&Executor::Default(), &shared);
+  EXPECT_EQ(&Executor::OrDefault(nullptr), &shared);
+  EXPECT_EQ(Executor::ConfigureDefault({}).code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST(ExecutorTest, TaskGroupRunsEveryTask) {
+  Executor executor(Workers(4));
+  EXPECT_EQ(executor.num_workers(), 4);
+
+  std::vector<int> hits(1000, 0);
+  TaskGroup group(&executor);
+  for (size_t i = 0; i < hits.size(); ++i) {
+    group.Run([&hits, i] { hits[i] += 1; });
+  }
+  group.Wait();
+
+  for (int hit : hits) EXPECT_EQ(hit, 1);
+}
+
+TEST(ExecutorTest, NestedGroupsDoNotDeadlock) {
+  // One worker: the outer task must help run its own children.
+  Executor executor(Workers(1));
+  std::atomic<int> leaves{0};
+
+  TaskGroup outer(&executor);
+  for (int i = 0; i < 4; ++i) {
+    outer.Run([&executor, &leaves] {
+      TaskGroup inner(&executor);
+      for (int j = 0; j < 8; ++j) {
+        inner.Run([&leaves] { leaves.fetch_add(1); });
+      }
+      inner.Wait();
+    });
+  }
+  outer.Wait();
+
+  EXPECT_EQ(leaves.load(), 32);
+}
+
+TEST(ExecutorTest, InlineGroupWithoutExecutor) {
+  int runs = 0;
+  TaskGroup group(nullptr);
+  group.Run([&runs] { ++runs; });
+  EXPECT_EQ(runs, 1);  // Ran synchronously
+  group.Wait();
+}
+
+TEST(ExecutorTest, DestructorFinishesScheduledTasks) {
+  std::atomic<int> runs{0};
+  {
+    Executor executor(Workers(2));
+    for (int i = 0; i < 100; ++i) {
+      executor.Schedule([&runs] { runs.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(runs.load(), 100);
+}
+
+TEST(ExecutorTest, ParallelForCoversRangeOnce) {
+  Executor executor(Workers(3));
+  std::vector<std::atomic<int>> hits(1001);
+
+  ParallelFor(&executor, 1, hits.size(), 64, [&hits](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) hits[i].fetch_add(1);
+  });
+
+  EXPECT_EQ(hits[0].load(), 0);
+  for (size_t i = 1; i < hits.size(); ++i) {
+    EXPECT_EQ(hits[i].load(), 1) << i;
+  }
+}
+
+TEST(ExecutorTest, CoreSetSizesPool) {
+  ExecutorOptions options;
+  options.cores = {0, 0, 0};  // Core 0 always exists
+  options.pin_workers = true;
+  Executor executor(options);
+
+  EXPECT_EQ(executor.num_workers(), 3);
+  EXPECT_LE(executor.pinned_workers(), 3);
+
+  std::atomic<int> runs{0};
+  ParallelFor(&executor, 0, 10, 1, [&runs](size_t, size_t) { ++runs; });
+  EXPECT_EQ(runs.load(), 10);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,82 @@
+// test/runtime/node_replicated_test.cc
+#include "lib/runtime/node_replicated.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+namespace f2chat {
+namespace {
+
+// Two nodes of two cores each; on smaller machines pinning fails but the
+// workers keep their nominal node, which is what scheduling uses.
+ExecutorOptions TwoNodes(const NumaTopology* topology) {
+  ExecutorOptions options;
+  options.cores = {0, 1, 2, 3};
+  options.pin_workers = true;
+  options.topology = topology;
+  return options;
+}
+
+TEST(NodeReplicatedTest, ExecutorSchedulesOnRequestedNode) {
+  NumaTopology topology = NumaTopology::FromNodes({{0, 1}, {2, 3}});
+  Executor executor(TwoNodes(&topology));
+  ASSERT_EQ(executor.worker_node(0), 0);
+  ASSERT_EQ(executor.worker_node(3), 1);
+
+  const auto main_thread = std::this_thread::get_id();
+  std::atomic<int> misplaced{0};
+  TaskGroup tasks(&executor);
+  for (int i = 0; i < 64; ++i) {
+    const int node = i % 2;
+    tasks.RunOnNode(node, [node, main_thread, &misplaced] {
+      // The waiting test thread may help; only count worker placements.
+      if (Executor::CurrentNode() != node &&
+          std::this_thread::get_id() != main_thread) {
+        ++misplaced;
+      }
+    });
+  }
+  tasks.Wait();
+  EXPECT_LE(misplaced.load(), executor.cross_node_steals());
+}
+
+TEST(NodeReplicatedTest, BuildsOneReplicaPerNode) {
+  NumaTopology topology = NumaTopology::FromNodes({{0, 1}, {2, 3}});
+  Executor executor(TwoNodes(&topology));
+
+  auto replicated = NodeReplicated<std::vector<int>>::Build(
+      executor, [] { return std::vector<int>{1, 2, 3}; });
+
+  ASSERT_EQ(replicated.num_replicas(), 2);
+  EXPECT_EQ(replicated.ForNode(0), (std::vector<int>{1, 2, 3}));
+  EXPECT_EQ(replicated.ForNode(1), replicated.ForNode(0));
+  EXPECT_NE(replicated.ForNode(0).data(), replicated.ForNode(1).data());
+  EXPECT_EQ(&replicated.ForNode(7), &replicated.ForNode(0));
+
+  // Tasks running on node 1 read node 1's copy.
+  const int* seen = nullptr;
+  TaskGroup tasks(&executor);
+  tasks.RunOnNode(1, [&] {
+    if (Executor::CurrentNode() == 1) seen = replicated.Local().data();
+  });
+  tasks.Wait();
+  if (seen != nullptr) {
+    EXPECT_EQ(seen, replicated.ForNode(1).data());
+  }
+}
+
+TEST(NodeReplicatedTest, SingleNodeHasOneReplica) {
+  NumaTopology topology = NumaTopology::SingleNode(2);
+  ExecutorOptions options;
+  options.num_workers = 2;
+  options.topology = &topology;
+  Executor executor(options);
+
+  auto replicated =
+      NodeReplicated<int>::Build(executor, [] { return 42; });
+  EXPECT_EQ(replicated.num_replicas(), 1);
+  EXPECT_EQ(replicated.Local(), 42);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,60 @@
+// test/runtime/numa_test.cc
+#include "lib/runtime/numa.h"
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace f2chat {
+namespace {
+
+// Writes a fake /sys/devices/system/node tree.
+std::string FakeSysfs(const std::vector<std::pair<std::string, std::string>>&
+                          nodes) {
+  auto root = std::filesystem::path(testing::TempDir()) /
+      testing::UnitTest::GetInstance()->current_test_info()->name();
+  std::filesystem::remove_all(root);
+  for (const auto& [name, cpulist] : nodes) {
+    std::filesystem::create_directories(root / name);
+    std::ofstream(root / name / "cpulist") << cpulist << "\n";
+  }
+  std::filesystem::create_directories(root / "power");  // Not a node
+  return root.string();
+}
+
+TEST(NumaTopologyTest, ReadsSysfsNodes) {
+  auto topology = NumaTopology::FromSysfs(FakeSysfs(
+      {{"node1", "4-7,12"}, {"node0", "0-3"}, {"node2", ""}}));
+  ASSERT_TRUE(topology.ok()) << topology.status();
+
+  // Sorted by node id; the memory-only node2 is skipped.
+  ASSERT_EQ(topology->num_nodes(), 2);
+  EXPECT_EQ(topology->cores(0), (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(topology->cores(1), (std::vector<int>{4, 5, 6, 7, 12}));
+  EXPECT_EQ(topology->NodeOfCore(2), 0);
+  EXPECT_EQ(topology->NodeOfCore(12), 1);
+  EXPECT_EQ(topology->NodeOfCore(99), 0);
+}
+
+TEST(NumaTopologyTest, MissingOrMalformedSysfs) {
+  EXPECT_EQ(NumaTopology::FromSysfs("/nonexistent/numa").status().code(),
+            absl::StatusCode::kNotFound);
+  EXPECT_EQ(NumaTopology::FromSysfs(FakeSysfs({{"node0", "3-1"}}))
+                .status().code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST(NumaTopologyTest, SystemHasAtLeastOneNode) {
+  const NumaTopology& system = NumaTopology::System();
+  ASSERT_GE(system.num_nodes(), 1);
+  EXPECT_FALSE(system.cores(0).empty());
+  EXPECT_GE(system.CurrentNode(), 0);
+  EXPECT_LT(system.CurrentNode(), system.num_nodes());
+
+  NumaTopology single = NumaTopology::SingleNode(4);
+  EXPECT_EQ(single.num_nodes(), 1);
+  EXPECT_EQ(single.CurrentNode(), 0);
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,63 @@
+// test/runtime/spsc_ring_test.cc
+#include "lib/runtime/spsc_ring.h"
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+namespace f2chat {
+namespace {
+
+TEST(SpscRingTest, FifoUntilFull) {
+  SpscRing<int> ring(3);  // Rounded up to 4
+  EXPECT_EQ(ring.capacity(), 4u);
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.TryPush(int{i}));
+  }
+  EXPECT_FALSE(ring.TryPush(99));
+
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(ring.TryPop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(ring.TryPop(value));
+}
+
+TEST(SpscRingTest, FailedPushKeepsValue) {
+  SpscRing<std::unique_ptr<int>> ring(2);
+  ASSERT_TRUE(ring.TryPush(std::make_unique<int>(1)));
+  ASSERT_TRUE(ring.TryPush(std::make_unique<int>(2)));
+
+  auto extra = std::make_unique<int>(3);
+  EXPECT_FALSE(ring.TryPush(std::move(extra)));
+  ASSERT_NE(extra, nullptr);
+  EXPECT_EQ(*extra, 3);
+}
+
+TEST(SpscRingTest, TransfersAcrossThreadsInOrder) {
+  constexpr int kCount = 20000;
+  SpscRing<int> ring(64);
+
+  std::thread producer([&ring] {
+    for (int i = 0; i < kCount; ++i) {
+      while (!ring.TryPush(int{i})) std::this_thread::yield();
+    }
+  });
+
+  int expected = 0;
+  int value = 0;
+  while (expected < kCount) {
+    if (ring.TryPop(value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+
+}  // namespace
+}  // namespace f2chat
@@ -0,0 +1,108 @@
+// test/runtime/task_test.cc
+#include "lib/runtime/task.h"
+#include "lib/runtime/cancellation.h"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+
+namespace f2chat {
+namespace {
+
+ExecutorOptions Workers(int num_workers) {
+  ExecutorOptions options;
+  options.num_workers = num_workers;
+  return options;
+}
+
+Task<int> Square(int x) { co_return x * x; }
+
+Task<int> SumOfSquares(int n) {
+  int sum = 0;
+  for (int i = 1; i <= n; ++i) {
+    sum += co_await Square(i);
+  }
+  co_return sum;
+}
+
+Task<int> One() { co_return 1; }
+
+Task<int> Count(int n) {
+  int count = 0;
+  for (int i = 0; i < n; ++i) {
+    count += co_await One();
+  }
+  co_return count;
+}
+
+Task<std::thread::id> HopTo(Executor& executor) {
+  co_await ResumeOn(executor);
+  co_return std::this_thread::get_id();
+}
+
+Task<absl::StatusOr<int>> Checked(CancellationToken token, int value) {
+  if (auto status = token.Check(); !status.ok()) {
+    co_return status;
+  }
+  co_return value;
+}
+
+TEST(TaskTest, AwaitsNestedTasks) {
+  EXPECT_EQ(SyncWait(SumOfSquares(10)), 385);
+}
+
+TEST(TaskTest, ResumeOnMovesToExecutor) {
+  Executor executor(Workers(1));
+  EXPECT_NE(SyncWait(HopTo(executor)), std::this_thread::get_id());
+}
+
+TEST(TaskTest, SpawnRunsManyTasksConcurrently) {
+  Executor executor(Workers(2));
+  constexpr int kTasks = 2000;
+  std::atomic<int> done{0};
+  std::atomic<int64_t> total{0};
+  absl::Notification all_done;
+  for (int i = 0; i < kTasks; ++i) {
+    Spawn<int>(executor, Square(i), [&](int value) {
+      total += value;
+      if (++done == kTasks) all_done.Notify();
+    });
+  }
+  all_done.WaitForNotification();
+  EXPECT_EQ(total.load(), int64_t{kTasks - 1} * kTasks * (2 * kTasks - 1) / 6);
+}
+
+TEST(TaskTest, AwaitsManySequentialTasks) {
+  EXPECT_EQ(SyncWait(Count(10000)), 10000);
+}
+
+TEST(CancellationTokenTest, DefaultNeverCancels) {
+  CancellationToken token;
+  token.Cancel();
+  EXPECT_TRUE(token.Check().ok());
+  EXPECT_EQ(token.deadline(), absl::InfiniteFuture());
+}
+
+TEST(CancellationTokenTest, CancelReachesCopies) {
+  CancellationToken token = CancellationToken::Create();
+  CancellationToken copy = token;
+  EXPECT_TRUE(copy.Check().ok());
+  token.Cancel();
+  EXPECT_TRUE(copy.cancelled());
+  EXPECT_EQ(copy.Check().code(), absl::StatusCode::kCancelled);
+  EXPECT_EQ(SyncWait(Checked(copy, 1)).status().code(),
+            absl::StatusCode::kCancelled);
+}
+
+TEST(CancellationTokenTest, DeadlineExpires) {
+  EXPECT_TRUE(CancellationToken::WithTimeout(absl::Hours(1)).Check().ok());
+  CancellationToken expired =
+      CancellationToken::Create(absl::Now() - absl::Seconds(1));
+  EXPECT_EQ(expired.Check().code(), absl::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(SyncWait(Checked(CancellationToken(), 7)).value(), 7);
+}
+
+}  // namespace
+}  // namespace f2chat